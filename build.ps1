@@ -35,6 +35,14 @@ if ($LASTEXITCODE -ne 0) {
     exit 1
 }
 
+# Compile console events
+Write-Host "Compiling console_events..." -ForegroundColor Yellow
+& g++ @cppFlags -c src/structure/console_events.cpp -o build/structure/console_events.o
+if ($LASTEXITCODE -ne 0) {
+    Write-Host "Error compiling console_events.cpp" -ForegroundColor Red
+    exit 1
+}
+
 # Compile user
 Write-Host "Compiling user..." -ForegroundColor Yellow
 & g++ @cppFlags -c src/authentication/user.cpp -o build/authentication/user.o
@@ -59,6 +67,22 @@ if ($LASTEXITCODE -ne 0) {
     exit 1
 }
 
+# Compile WAL checkpointer
+Write-Host "Compiling wal_checkpointer..." -ForegroundColor Yellow
+& g++ @cppFlags -c src/database/wal_checkpointer.cpp -o build/database/wal_checkpointer.o
+if ($LASTEXITCODE -ne 0) {
+    Write-Host "Error compiling wal_checkpointer.cpp" -ForegroundColor Red
+    exit 1
+}
+
+# Compile answer journal
+Write-Host "Compiling answer_journal..." -ForegroundColor Yellow
+& g++ @cppFlags -c src/database/answer_journal.cpp -o build/database/answer_journal.o
+if ($LASTEXITCODE -ne 0) {
+    Write-Host "Error compiling answer_journal.cpp" -ForegroundColor Red
+    exit 1
+}
+
 # Compile main
 Write-Host "Compiling main..." -ForegroundColor Yellow
 & g++ @cppFlags -c src/main.cpp -o build/main.o
@@ -67,9 +91,10 @@ if ($LASTEXITCODE -ne 0) {
     exit 1
 }
 
-# Link everything
+# Link everything. Any SQLite 3 works; with FTS5 and its trigram tokenizer
+# (SQLite 3.34+) user search is indexed, otherwise it scans the users table.
 Write-Host "Linking..." -ForegroundColor Yellow
-& g++ build/main.o build/structure/utils.o build/authentication/user.o build/authentication/simple_auth.o build/database/database.o -o build/exam_system.exe -lsqlite3
+& g++ build/main.o build/structure/utils.o build/structure/console_events.o build/authentication/user.o build/authentication/simple_auth.o build/database/database.o build/database/wal_checkpointer.o build/database/answer_journal.o -o build/exam_system.exe -lsqlite3 -pthread
 if ($LASTEXITCODE -ne 0) {
     Write-Host "Error linking executable" -ForegroundColor Red
     Write-Host "Make sure SQLite3 development libraries are installed" -ForegroundColor Red
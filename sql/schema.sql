@@ -4,6 +4,13 @@
 -- Enable foreign key constraints
 PRAGMA foreign_keys = ON;
 
+-- Version 1: users/exam_results timestamps are INTEGER epoch milliseconds
+-- Version 2: subject/difficulty/exam_type are integer codes (src/structure/codes.h)
+-- Version 3: users_search trigram index over username, full_name and email
+-- Version 4: exam_templates.skip_penalty
+-- Version 5: exam_results.negative_marking is filled in for results saved before it was recorded
+PRAGMA user_version = 5;
+
 -- Users table for authentication and user management
 CREATE TABLE IF NOT EXISTS users (
     id INTEGER PRIMARY KEY AUTOINCREMENT,
@@ -13,25 +20,26 @@ CREATE TABLE IF NOT EXISTS users (
     full_name TEXT NOT NULL,
     role INTEGER NOT NULL DEFAULT 2, -- 1=Admin, 2=Student
     status INTEGER NOT NULL DEFAULT 1, -- 1=Active, 2=Inactive
-    created_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP,
-    last_login TEXT,
+    created_at INTEGER NOT NULL DEFAULT (CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER)), -- epoch ms
+    last_login INTEGER,
     login_attempts INTEGER DEFAULT 0,
     is_locked BOOLEAN DEFAULT 0,
-    updated_at TEXT DEFAULT CURRENT_TIMESTAMP
+    updated_at INTEGER DEFAULT (CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER))
 );
 
 -- Exam templates table - teachers create exams directly
 CREATE TABLE IF NOT EXISTS exam_templates (
     id INTEGER PRIMARY KEY AUTOINCREMENT,
     template_name TEXT UNIQUE NOT NULL,
-    exam_type TEXT NOT NULL CHECK(exam_type IN ('QUIZ', 'WORKSHEET', 'FINAL')),
-    subject TEXT NOT NULL CHECK(subject IN ('DSA', 'OOP', 'COA', 'SAM', 'Mathematics')),
+    exam_type INTEGER NOT NULL CHECK(exam_type BETWEEN 1 AND 3), -- 1 QUIZ, 2 WORKSHEET, 3 FINAL
+    subject INTEGER NOT NULL CHECK(subject BETWEEN 1 AND 5), -- 1 DSA, 2 OOP, 3 COA, 4 SAM, 5 Mathematics
     question_count INTEGER NOT NULL DEFAULT 10 CHECK(question_count > 0),
     time_limit INTEGER NOT NULL CHECK(time_limit > 0), -- in minutes
-    difficulty TEXT DEFAULT 'Medium' CHECK(difficulty IN ('Easy', 'Medium', 'Hard', 'Mixed')),
+    difficulty INTEGER DEFAULT 2 CHECK(difficulty BETWEEN 1 AND 4), -- 1 Easy, 2 Medium, 3 Hard, 4 Mixed
     passing_percentage REAL DEFAULT 60.0,
     negative_marking BOOLEAN DEFAULT 0,
     negative_mark_value REAL DEFAULT 0.25,
+    skip_penalty REAL DEFAULT 0,
     shuffle_questions BOOLEAN DEFAULT 1,
     shuffle_options BOOLEAN DEFAULT 0,
     allow_review BOOLEAN DEFAULT 1,
@@ -64,14 +72,14 @@ CREATE TABLE IF NOT EXISTS exam_questions (
 -- General questions table - question bank for reuse across exams
 CREATE TABLE IF NOT EXISTS questions (
     id INTEGER PRIMARY KEY AUTOINCREMENT,
-    subject TEXT NOT NULL CHECK(subject IN ('DSA', 'OOP', 'COA', 'SAM', 'Mathematics')),
+    subject INTEGER NOT NULL CHECK(subject BETWEEN 1 AND 5),
     question_text TEXT NOT NULL,
     option1 TEXT NOT NULL,
     option2 TEXT NOT NULL,
     option3 TEXT NOT NULL,
     option4 TEXT NOT NULL,
     correct_answer INTEGER NOT NULL CHECK(correct_answer >= 0 AND correct_answer <= 3),
-    difficulty TEXT NOT NULL CHECK(difficulty IN ('Easy', 'Medium', 'Hard')),
+    difficulty INTEGER NOT NULL CHECK(difficulty BETWEEN 1 AND 3),
     explanation TEXT,
     created_by INTEGER NOT NULL,
     created_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP,
@@ -89,13 +97,13 @@ CREATE TABLE IF NOT EXISTS exam_results (
     score INTEGER NOT NULL,
     total_questions INTEGER NOT NULL,
     percentage REAL NOT NULL,
-    exam_date TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP,
-    start_time TEXT,
-    end_time TEXT,
+    exam_date INTEGER NOT NULL DEFAULT (CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER)), -- epoch ms
+    start_time INTEGER,
+    end_time INTEGER,
     duration INTEGER, -- in minutes
     time_limit INTEGER, -- original time limit
-    subject TEXT,
-    exam_type TEXT, -- QUIZ, WORKSHEET, FINAL
+    subject INTEGER, -- 6 Mixed for custom exams
+    exam_type INTEGER, -- 0 for practice exams
     exam_name TEXT, -- Name of the exam taken
     is_passed BOOLEAN DEFAULT 0,
     grade TEXT,
@@ -147,9 +155,25 @@ CREATE TABLE IF NOT EXISTS subjects (
     created_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP
 );
 
+-- Bumped by triggers on every template or question change, so other
+-- processes can tell their cached catalog and papers are stale
+CREATE TABLE IF NOT EXISTS exam_catalog_version (
+    id INTEGER PRIMARY KEY CHECK(id = 1),
+    version INTEGER NOT NULL DEFAULT 0
+);
+INSERT OR IGNORE INTO exam_catalog_version (id, version) VALUES (1, 0);
+
+-- Trigram full-text index for user search (external content: index only)
+CREATE VIRTUAL TABLE IF NOT EXISTS users_search USING fts5(
+    username, full_name, email,
+    content='users', content_rowid='id', tokenize='trigram'
+);
+
 -- Create indexes for better performance
 CREATE INDEX IF NOT EXISTS idx_users_username ON users(username);
 CREATE INDEX IF NOT EXISTS idx_users_email ON users(email);
+CREATE INDEX IF NOT EXISTS idx_users_username_nocase ON users(username COLLATE NOCASE);
+CREATE INDEX IF NOT EXISTS idx_users_email_nocase ON users(email COLLATE NOCASE);
 CREATE INDEX IF NOT EXISTS idx_users_role ON users(role);
 
 CREATE INDEX IF NOT EXISTS idx_exam_templates_type ON exam_templates(exam_type);
@@ -160,9 +184,14 @@ CREATE INDEX IF NOT EXISTS idx_exam_templates_active ON exam_templates(is_active
 CREATE INDEX IF NOT EXISTS idx_exam_questions_template_id ON exam_questions(exam_template_id);
 CREATE INDEX IF NOT EXISTS idx_exam_questions_number ON exam_questions(question_number);
 
+CREATE INDEX IF NOT EXISTS idx_questions_subject ON questions(subject, difficulty);
+CREATE INDEX IF NOT EXISTS idx_questions_difficulty ON questions(difficulty);
+
 CREATE INDEX IF NOT EXISTS idx_exam_results_user_id ON exam_results(user_id);
 CREATE INDEX IF NOT EXISTS idx_exam_results_date ON exam_results(exam_date);
+CREATE INDEX IF NOT EXISTS idx_exam_results_user_date ON exam_results(user_id, exam_date);
 CREATE INDEX IF NOT EXISTS idx_exam_results_template_id ON exam_results(exam_template_id);
+CREATE INDEX IF NOT EXISTS idx_exam_results_subject ON exam_results(subject);
 
 CREATE INDEX IF NOT EXISTS idx_exam_answers_result_id ON exam_answers(result_id);
 CREATE INDEX IF NOT EXISTS idx_exam_answers_question_id ON exam_answers(question_id);
@@ -179,9 +208,52 @@ CREATE TRIGGER IF NOT EXISTS update_exam_template_timestamp
 CREATE TRIGGER IF NOT EXISTS update_user_timestamp 
     AFTER UPDATE ON users
     BEGIN
-        UPDATE users SET updated_at = CURRENT_TIMESTAMP WHERE id = NEW.id;
+        UPDATE users SET updated_at = (CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER)) WHERE id = NEW.id;
     END;
 
+-- Keep users_search in step with users (only the indexed columns)
+CREATE TRIGGER IF NOT EXISTS users_search_insert AFTER INSERT ON users BEGIN
+    INSERT INTO users_search(rowid, username, full_name, email)
+    VALUES (new.id, new.username, new.full_name, new.email);
+END;
+
+CREATE TRIGGER IF NOT EXISTS users_search_delete AFTER DELETE ON users BEGIN
+    INSERT INTO users_search(users_search, rowid, username, full_name, email)
+    VALUES ('delete', old.id, old.username, old.full_name, old.email);
+END;
+
+CREATE TRIGGER IF NOT EXISTS users_search_update AFTER UPDATE OF username, full_name, email ON users BEGIN
+    INSERT INTO users_search(users_search, rowid, username, full_name, email)
+    VALUES ('delete', old.id, old.username, old.full_name, old.email);
+    INSERT INTO users_search(rowid, username, full_name, email)
+    VALUES (new.id, new.username, new.full_name, new.email);
+END;
+
+-- Any template or question change, cascades included, moves the version on
+CREATE TRIGGER IF NOT EXISTS exam_templates_version_insert AFTER INSERT ON exam_templates BEGIN
+    UPDATE exam_catalog_version SET version = version + 1;
+END;
+
+CREATE TRIGGER IF NOT EXISTS exam_templates_version_update AFTER UPDATE ON exam_templates BEGIN
+    UPDATE exam_catalog_version SET version = version + 1;
+END;
+
+CREATE TRIGGER IF NOT EXISTS exam_templates_version_delete AFTER DELETE ON exam_templates BEGIN
+    UPDATE exam_catalog_version SET version = version + 1;
+END;
+
+CREATE TRIGGER IF NOT EXISTS exam_questions_version_insert AFTER INSERT ON exam_questions BEGIN
+    UPDATE exam_catalog_version SET version = version + 1;
+END;
+
+CREATE TRIGGER IF NOT EXISTS exam_questions_version_update AFTER UPDATE ON exam_questions BEGIN
+    UPDATE exam_catalog_version SET version = version + 1;
+END;
+
+CREATE TRIGGER IF NOT EXISTS exam_questions_version_delete AFTER DELETE ON exam_questions BEGIN
+    UPDATE exam_catalog_version SET version = version + 1;
+END;
+
 -- Insert default system settings
 INSERT OR IGNORE INTO system_settings (setting_key, setting_value, description) VALUES
 ('system_name', 'Online Examination System', 'Name of the examination system'),
@@ -22,8 +22,8 @@ AuthResult SimpleAuthManager::login(const string &username, const string &passwo
         return AuthResult::INVALID_INPUT;
     }
 
-    // Find user
-    User *user = userManager->findUserByUsername(username);
+    // Find user (always re-read, so admin changes since caching apply)
+    User *user = userManager->reloadUser(username);
     if (!user)
     {
         return AuthResult::USER_NOT_FOUND;
@@ -48,7 +48,8 @@ AuthResult SimpleAuthManager::login(const string &username, const string &passwo
     user->updateLastLogin();
     userManager->updateUser(*user);
 
-    currentUser = user;
+    sessionUser = *user;
+    currentUser = &sessionUser;
     isLoggedIn = true;
 
     return AuthResult::SUCCESS;
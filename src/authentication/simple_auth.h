@@ -19,7 +19,8 @@ enum class AuthResult {
 class SimpleAuthManager {
 private:
     UserManager* userManager;
-    User* currentUser;
+    User sessionUser;       // Own copy: cache slots move on eviction
+    User* currentUser;      // &sessionUser while logged in
     bool isLoggedIn;
     
 public:
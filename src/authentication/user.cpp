@@ -1,5 +1,7 @@
 
 #include "user.h"
+#include "../database/row_mapper.h"
+#include "../database/database.h"
 #include <algorithm>
 #include <fstream>
 #include <sstream>
@@ -10,16 +12,18 @@ using namespace std;
 
 // User class implementation
 User::User() : id(0), role(UserRole::STUDENT), status(UserStatus::ACTIVE), 
-               loginAttempts(0), isLocked(false) {
-    createdAt = Utils::getCurrentDateTime();
+               createdAtMs(Utils::nowEpochMs()), lastLoginMs(0), loginAttempts(0), isLocked(false) {
+}
+
+User::User(RowDecode) : id(0), role(UserRole::STUDENT), status(UserStatus::ACTIVE),
+                        createdAtMs(0), lastLoginMs(0), loginAttempts(0), isLocked(false) {
 }
 
 User::User(int id, const string& username, const string& password,
            const string& email, const string& fullName, UserRole role)
     : id(id), username(username), password(password), email(email), 
       fullName(fullName), role(role), status(UserStatus::ACTIVE),
-      loginAttempts(0), isLocked(false) {
-    createdAt = Utils::getCurrentDateTime();
+      createdAtMs(Utils::nowEpochMs()), lastLoginMs(0), loginAttempts(0), isLocked(false) {
 }
 
 bool User::verifyPassword(const string& inputPassword) const {
@@ -28,7 +32,7 @@ bool User::verifyPassword(const string& inputPassword) const {
 }
 
 void User::updateLastLogin() {
-    lastLogin = Utils::getCurrentDateTime();
+    lastLoginMs = Utils::nowEpochMs();
 }
 
 void User::incrementLoginAttempts() {
@@ -71,8 +75,8 @@ bool User::isValidUsername() const {
 }
 
 bool User::isValidEmail() const {
-    // Simple email validation
-    regex emailRegex(R"([a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,})");
+    // Simple email validation (compiled once; construction dominated addUser)
+    static const regex emailRegex(R"([a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,})");
     return regex_match(email, emailRegex);
 }
 
@@ -91,22 +95,11 @@ bool User::isActive() const {
 }
 
 string User::roleToString() const {
-    switch (role) {
-        case UserRole::ADMIN: return "Admin";
-        case UserRole::STUDENT: return "Student";
-        case UserRole::INSTRUCTOR: return "Instructor";
-        default: return "Unknown";
-    }
+    return USER_ROLE_NAMES.name(role);
 }
 
 string User::statusToString() const {
-    switch (status) {
-        case UserStatus::ACTIVE: return "Active";
-        case UserStatus::INACTIVE: return "Inactive";
-        case UserStatus::SUSPENDED: return "Suspended";
-        case UserStatus::PENDING: return "Pending";
-        default: return "Unknown";
-    }
+    return USER_STATUS_NAMES.name(status);
 }
 
 UserRole User::stringToRole(const string& roleStr) {
@@ -136,8 +129,8 @@ void User::displayProfile() const {
     cout << "Email: " << email << endl;
     cout << "Role: " << roleToString() << endl;
     cout << "Status: " << statusToString() << endl;
-    cout << "Created: " << createdAt << endl;
-    cout << "Last Login: " << (lastLogin.empty() ? "Never" : lastLogin) << endl;
+    cout << "Created: " << getCreatedAt() << endl;
+    cout << "Last Login: " << (lastLoginMs == 0 ? "Never" : getLastLogin()) << endl;
     cout << "Login Attempts: " << loginAttempts << endl;
     cout << "Account Locked: " << (isLocked ? "Yes" : "No") << endl;
 }
@@ -164,8 +157,11 @@ ostream& operator<<(ostream& os, const User& user) {
 }
 
 // UserManager class implementation
-UserManager::UserManager() {
-    users.reserve(1000);
+UserManager::UserManager(DatabaseManager* database, size_t capacity)
+    : lruHead(-1), lruTail(-1), capacity(capacity > 0 ? capacity : 1), database(database),
+      indexById(2048), indexByUsername(2048), indexByEmail(2048),
+      hits(0), misses(0), evictions(0) {
+    users.reserve(database ? this->capacity : 1000);
 }
 
 UserManager::~UserManager() {
@@ -178,27 +174,47 @@ bool UserManager::addUser(const User& user) {
         return false;
     }
     
-    // Check for unique username and email
+    // Check for unique username and email (the database enforces the same
+    // constraints for users that are not resident)
     if (!isUsernameUnique(user.getUsername()) || !isEmailUnique(user.getEmail())) {
         return false;
     }
     
-    users.push_back(user);
+    if (database) {
+        // The database assigns the id; read the row back to learn it
+        if (!database->insertUser(user)) {
+            return false;
+        }
+        User stored = database->getUserByUsername(user.getUsername());
+        if (stored.getId() == 0) {
+            return false;
+        }
+        admitUser(stored);
+        return true;
+    }
+    
+    // Ids double as the primary key, so a duplicate would shadow the original
+    if (indexById.contains(user.getId())) {
+        return false;
+    }
+    
+    admitUser(user);
     return true;
 }
 
 bool UserManager::removeUser(int userId) {
+    if (database && !database->deleteUser(userId)) {
+        return false;
+    }
+    
     int index = findUserIndex(userId);
-    if (index == -1) return false;
+    if (index == -1) return database != nullptr;
     
-    users.erase(users.begin() + index);
+    dropSlot(index);
     return true;
 }
 
 bool UserManager::updateUser(const User& user) {
-    int index = findUserIndex(user.getId());
-    if (index == -1) return false;
-    
     // Validate updated data
     if (!user.isValidUsername() || !user.isValidEmail()) {
         return false;
@@ -210,18 +226,53 @@ bool UserManager::updateUser(const User& user) {
         return false;
     }
     
+    int index = findUserIndex(user.getId());
+    if (database) {
+        if (!database->updateUser(user)) {
+            return false;
+        }
+        if (index == -1) {
+            admitUser(user);
+            return true;
+        }
+    } else if (index == -1) {
+        return false;
+    }
+    
+    // `user` may alias users[index] (callers pass back a findUser pointer)
+    unindexUser(users[index]);
     users[index] = user;
+    indexUser(index);
+    touch(index);
     return true;
 }
 
 User* UserManager::findUser(int userId) {
     int index = findUserIndex(userId);
-    return (index != -1) ? &users[index] : nullptr;
+    if (index != -1) {
+        hits++;
+        touch(index);
+        return &users[index];
+    }
+    if (!database) return nullptr;
+    
+    misses++;
+    User loaded = database->getUserById(userId);
+    if (loaded.getId() == 0) return nullptr;
+    return &users[admitUser(loaded)];
 }
 
 User* UserManager::findUserByUsername(const string& username) {
     int index = findUserIndexByUsername(username);
-    return (index != -1) ? &users[index] : nullptr;
+    if (index != -1) {
+        hits++;
+        touch(index);
+        return &users[index];
+    }
+    if (!database) return nullptr;
+    
+    misses++;
+    return reloadUser(username);
 }
 
 const User* UserManager::findUser(int userId) const {
@@ -234,23 +285,31 @@ const User* UserManager::findUserByUsername(const string& username) const {
     return (index != -1) ? &users[index] : nullptr;
 }
 
+// Login goes through here so it sees lock and password changes made by
+// the admin panel or another process since the user was cached
+User* UserManager::reloadUser(const string& username) {
+    int index = findUserIndexByUsername(username);
+    if (!database) {
+        return (index != -1) ? &users[index] : nullptr;
+    }
+    
+    User loaded = database->getUserByUsername(username);
+    if (loaded.getId() == 0) {
+        if (index != -1) dropSlot(index);  // Deleted or renamed elsewhere
+        return nullptr;
+    }
+    return &users[admitUser(loaded)];
+}
+
 vector<User> UserManager::searchUsers(const string& keyword) const {
+    // Resident users only; DatabaseManager::searchUsers covers everyone
     vector<User> results;
-    string lowerKeyword = keyword;
-    transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), ::tolower);
+    string lowerKeyword = Utils::toLower(keyword);
     
     for (const auto& user : users) {
-        string lowerUsername = user.getUsername();
-        string lowerFullName = user.getFullName();
-        string lowerEmail = user.getEmail();
-        
-        transform(lowerUsername.begin(), lowerUsername.end(), lowerUsername.begin(), ::tolower);
-        transform(lowerFullName.begin(), lowerFullName.end(), lowerFullName.begin(), ::tolower);
-        transform(lowerEmail.begin(), lowerEmail.end(), lowerEmail.begin(), ::tolower);
-        
-        if (lowerUsername.find(lowerKeyword) != string::npos ||
-            lowerFullName.find(lowerKeyword) != string::npos ||
-            lowerEmail.find(lowerKeyword) != string::npos) {
+        if (Utils::containsLower(user.getUsername(), lowerKeyword) ||
+            Utils::containsLower(user.getFullName(), lowerKeyword) ||
+            Utils::containsLower(user.getEmail(), lowerKeyword)) {
             results.push_back(user);
         }
     }
@@ -300,22 +359,14 @@ int UserManager::getUserCountByStatus(UserStatus status) const {
     });
 }
 
-void UserManager::sortByUsername() {
-    sort(users.begin(), users.end(), [](const User& a, const User& b) {
-        return a.getUsername() < b.getUsername();
-    });
-}
-
-void UserManager::sortByRole() {
-    sort(users.begin(), users.end(), [](const User& a, const User& b) {
-        return static_cast<int>(a.getRole()) < static_cast<int>(b.getRole());
-    });
-}
-
-void UserManager::sortById() {
-    sort(users.begin(), users.end(), [](const User& a, const User& b) {
-        return a.getId() < b.getId();
-    });
+UserCacheStats UserManager::getCacheStats() const {
+    UserCacheStats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.evictions = evictions;
+    stats.resident = users.size();
+    stats.capacity = database ? capacity : 0;
+    return stats;
 }
 
 void UserManager::displayAllUsers() const {
@@ -365,37 +416,109 @@ void UserManager::displayUserStatistics() const {
 }
 
 int UserManager::findUserIndex(int userId) const {
-    for (size_t i = 0; i < users.size(); ++i) {
-        if (users[i].getId() == userId) {
-            return static_cast<int>(i);
-        }
-    }
-    return -1;
+    const size_t* index = indexById.find(userId);
+    return index ? static_cast<int>(*index) : -1;
 }
 
 int UserManager::findUserIndexByUsername(const string& username) const {
-    for (size_t i = 0; i < users.size(); ++i) {
-        if (users[i].getUsername() == username) {
-            return static_cast<int>(i);
-        }
-    }
-    return -1;
+    const size_t* index = indexByUsername.find(username);
+    return index ? static_cast<int>(*index) : -1;
 }
 
 bool UserManager::isUsernameUnique(const string& username, int excludeUserId) const {
-    for (const auto& user : users) {
-        if (user.getUsername() == username && user.getId() != excludeUserId) {
-            return false;
-        }
-    }
-    return true;
+    const size_t* index = indexByUsername.find(username);
+    return !index || users[*index].getId() == excludeUserId;
 }
 
 bool UserManager::isEmailUnique(const string& email, int excludeUserId) const {
-    for (const auto& user : users) {
-        if (user.getEmail() == email && user.getId() != excludeUserId) {
-            return false;
-        }
+    const size_t* index = indexByEmail.find(email);
+    return !index || users[*index].getId() == excludeUserId;
+}
+
+// Place a user in a slot, evicting the least recently used one when a
+// database-backed cache is full. Returns the slot.
+size_t UserManager::admitUser(const User& user) {
+    // Resident copies sharing the id, username or email are stale
+    int stale;
+    while ((stale = findUserIndex(user.getId())) != -1 ||
+           (stale = findUserIndexByUsername(user.getUsername())) != -1) {
+        dropSlot(stale);
     }
-    return true;
-}
\ No newline at end of file
+    const size_t* sameEmail = indexByEmail.find(user.getEmail());
+    if (sameEmail) {
+        dropSlot(*sameEmail);
+    }
+    
+    size_t index;
+    if (database && users.size() >= capacity) {
+        index = lruTail;
+        unindexUser(users[index]);
+        users[index] = user;
+        evictions++;
+    } else {
+        index = users.size();
+        users.push_back(user);
+        lruPrev.push_back(-1);
+        lruNext.push_back(-1);
+        linkFront(index);
+    }
+    indexUser(index);
+    touch(index);
+    return index;
+}
+
+// Free a slot by moving the last slot into it, links and all
+void UserManager::dropSlot(size_t index) {
+    unlinkSlot(index);
+    unindexUser(users[index]);
+    
+    size_t last = users.size() - 1;
+    if (index != last) {
+        unindexUser(users[last]);
+        users[index] = move(users[last]);
+        lruPrev[index] = lruPrev[last];
+        lruNext[index] = lruNext[last];
+        if (lruPrev[index] != -1) lruNext[lruPrev[index]] = index; else lruHead = index;
+        if (lruNext[index] != -1) lruPrev[lruNext[index]] = index; else lruTail = index;
+        indexUser(index);
+    }
+    users.pop_back();
+    lruPrev.pop_back();
+    lruNext.pop_back();
+}
+
+void UserManager::touch(size_t index) {
+    if (lruHead == static_cast<int>(index)) return;
+    unlinkSlot(index);
+    linkFront(index);
+}
+
+void UserManager::unlinkSlot(size_t index) {
+    int prev = lruPrev[index];
+    int next = lruNext[index];
+    if (prev != -1) lruNext[prev] = next; else lruHead = next;
+    if (next != -1) lruPrev[next] = prev; else lruTail = prev;
+    lruPrev[index] = -1;
+    lruNext[index] = -1;
+}
+
+void UserManager::linkFront(size_t index) {
+    lruPrev[index] = -1;
+    lruNext[index] = lruHead;
+    if (lruHead != -1) lruPrev[lruHead] = index;
+    lruHead = index;
+    if (lruTail == -1) lruTail = index;
+}
+
+void UserManager::indexUser(size_t index) {
+    const User& user = users[index];
+    indexById.insert(user.getId(), index);
+    indexByUsername.insert(user.getUsername(), index);
+    indexByEmail.insert(user.getEmail(), index);
+}
+
+void UserManager::unindexUser(const User& user) {
+    indexById.remove(user.getId());
+    indexByUsername.remove(user.getUsername());
+    indexByEmail.remove(user.getEmail());
+}
@@ -5,6 +5,11 @@
 #include <vector>
 #include <chrono>
 #include "../structure/utils.h"
+#include "../structure/codes.h"
+#include "../components/hash_table.h"
+
+struct RowDecode;
+class DatabaseManager;
 
 enum class UserRole {
     ADMIN = 1,
@@ -19,6 +24,24 @@ enum class UserStatus {
     PENDING = 4
 };
 
+// Display names, indexed by the stored code (0 is never stored)
+inline constexpr CodeTable<UserRole, 4> USER_ROLE_NAMES = {{
+    {static_cast<UserRole>(0), "Unknown"},
+    {UserRole::ADMIN, "Admin"},
+    {UserRole::STUDENT, "Student"},
+    {UserRole::INSTRUCTOR, "Instructor"},
+}};
+
+inline constexpr CodeTable<UserStatus, 5> USER_STATUS_NAMES = {{
+    {static_cast<UserStatus>(0), "Unknown"},
+    {UserStatus::ACTIVE, "Active"},
+    {UserStatus::INACTIVE, "Inactive"},
+    {UserStatus::SUSPENDED, "Suspended"},
+    {UserStatus::PENDING, "Pending"},
+}};
+
+static_assert(USER_ROLE_NAMES.isDense() && USER_STATUS_NAMES.isDense(), "name tables must follow the codes");
+
 class User {
 private:
     int id;
@@ -28,15 +51,19 @@ private:
     string fullName;
     UserRole role;
     UserStatus status;
-    string createdAt;
-    string lastLogin;
+    long long createdAtMs;   // Epoch milliseconds
+    long long lastLoginMs;   // 0 until the first login
     int loginAttempts;
     bool isLocked;
     string lockTime;
     
+    // Column descriptors bind straight to the fields (database/database.cpp)
+    friend struct EntityColumns;
+    
 public:
     // Constructors
     User();
+    explicit User(RowDecode); // Fields are decoded from a users row
     User(int id, const string& username, const string& password, 
          const string& email, const string& fullName, UserRole role);
     
@@ -48,8 +75,10 @@ public:
     string getFullName() const { return fullName; }
     UserRole getRole() const { return role; }
     UserStatus getStatus() const { return status; }
-    string getCreatedAt() const { return createdAt; }
-    string getLastLogin() const { return lastLogin; }
+    string getCreatedAt() const { return Utils::formatEpochMs(createdAtMs); }
+    string getLastLogin() const { return Utils::formatEpochMs(lastLoginMs); }   // "" if never
+    long long getCreatedAtMs() const { return createdAtMs; }
+    long long getLastLoginMs() const { return lastLoginMs; }
     int getLoginAttempts() const { return loginAttempts; }
     bool getIsLocked() const { return isLocked; }
     
@@ -61,7 +90,7 @@ public:
     void setFullName(const string& fullName) { this->fullName = fullName; }
     void setRole(UserRole role) { this->role = role; }
     void setStatus(UserStatus status) { this->status = status; }
-    void setLastLogin(const string& lastLogin) { this->lastLogin = lastLogin; }
+    void setLastLoginMs(long long lastLoginMs) { this->lastLoginMs = lastLoginMs; }
     
     // Authentication methods
     bool verifyPassword(const string& inputPassword) const;
@@ -94,23 +123,65 @@ public:
     friend ostream& operator<<(ostream& os, const User& user);
 };
 
+// Users resident in UserManager before the least recently used is evicted
+const size_t DEFAULT_USER_CACHE_CAPACITY = 256;
+
+// UserManager counters
+struct UserCacheStats {
+    long long hits;
+    long long misses;       // Lookups that went to the database
+    long long evictions;
+    size_t resident;
+    size_t capacity;
+
+    UserCacheStats() : hits(0), misses(0), evictions(0), resident(0), capacity(0) {}
+};
+
 // User management with advanced DSA
+//
+// With a DatabaseManager this is a bounded LRU, write-through cache: users
+// are loaded on first lookup, writes go to the database before the cache,
+// and the least recently used user is evicted once `capacity` are
+// resident. Without one it is a plain in-memory store that never evicts.
+// Listing, search and count methods cover resident users only; the
+// database is authoritative for the full population.
 class UserManager {
 private:
+    // Resident users in fixed slots. lruPrev/lruNext link the slots from
+    // most (lruHead) to least (lruTail) recently used.
     vector<User> users;
+    vector<int> lruPrev;
+    vector<int> lruNext;
+    int lruHead;
+    int lruTail;
+    size_t capacity;
+    DatabaseManager* database;
+    
+    // Slot by id, username and email. Kept in step with every change to
+    // the slots, so lookups and uniqueness checks are O(1).
+    HashTable<int, size_t> indexById;
+    HashTable<string, size_t> indexByUsername;
+    HashTable<string, size_t> indexByEmail;
+    
+    long long hits;
+    long long misses;
+    long long evictions;
     
 public:
-    UserManager();
+    explicit UserManager(DatabaseManager* database = nullptr,
+                         size_t capacity = DEFAULT_USER_CACHE_CAPACITY);
     ~UserManager();
     
-    // User CRUD operations
+    // User CRUD operations (write-through when backed by a database).
+    // Pointers stay valid until the next call that can load or evict.
     bool addUser(const User& user);
     bool removeUser(int userId);
     bool updateUser(const User& user);
     User* findUser(int userId);
     User* findUserByUsername(const string& username);
-    const User* findUser(int userId) const;
+    const User* findUser(int userId) const;                  // Resident only
     const User* findUserByUsername(const string& username) const;
+    User* reloadUser(const string& username);  // Always reads the database
     
     // User management
     bool changePassword(int userId, const string& oldPassword, const string& newPassword);
@@ -120,7 +191,7 @@ public:
     bool activateUser(int userId);
     bool deactivateUser(int userId);
     
-    // Search and filter
+    // Search and filter (resident users)
     vector<User> searchUsers(const string& keyword) const;
     vector<User> getUsersByRole(UserRole role) const;
     vector<User> getUsersByStatus(UserStatus status) const;
@@ -129,15 +200,10 @@ public:
     vector<User> getAllUsers() const { return users; }
     
     // Statistics
-    int getTotalUsers() const { return users.size(); }
+    int getTotalUsers() const { return users.size(); }  // Resident users
     int getUserCountByRole(UserRole role) const;
     int getUserCountByStatus(UserStatus status) const;
-    
-    // Sorting
-    void sortByUsername();
-    void sortByRole();
-    void sortByLastLogin();
-    void sortById();
+    UserCacheStats getCacheStats() const;
     
     // Display methods
     void displayAllUsers() const;
@@ -153,6 +219,13 @@ private:
     int findUserIndexByUsername(const string& username) const;
     bool isUsernameUnique(const string& username, int excludeUserId = -1) const;
     bool isEmailUnique(const string& email, int excludeUserId = -1) const;
+    size_t admitUser(const User& user);
+    void dropSlot(size_t index);
+    void touch(size_t index);
+    void unlinkSlot(size_t index);
+    void linkFront(size_t index);
+    void indexUser(size_t index);
+    void unindexUser(const User& user);
 };
 
 #endif // USER_H
\ No newline at end of file
@@ -0,0 +1,148 @@
+#ifndef CONCURRENT_HASH_TABLE_H
+#define CONCURRENT_HASH_TABLE_H
+
+#include <shared_mutex>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+#include <vector>
+#include "hash_table.h"
+
+using namespace std;
+
+// Thread-safe map for registries shared between sessions. Keys are spread
+// over SHARDS independent HashTables, each behind its own reader/writer lock,
+// so threads touching different shards never wait on each other and a shard
+// grows without stopping the rest. Readers of one shard share its lock.
+//
+// Values are handed out by copy (or visited under the lock), never by
+// pointer: another thread may move them when its insert grows the shard.
+template<typename K, typename V, size_t SHARDS = 16>
+class ConcurrentHashTable {
+private:
+    static_assert(SHARDS > 0 && (SHARDS & (SHARDS - 1)) == 0, "SHARDS must be a power of two");
+
+    // One cache line per shard so the locks do not share lines
+    struct alignas(64) Shard {
+        mutable shared_mutex lock;
+        HashTable<K, V> table;
+    };
+
+    Shard shards[SHARDS];
+
+    // A different multiplier from HashTable's own mix, so the bits picking
+    // the shard are not the ones picking the group within it
+    static size_t shardIndex(const K& key) {
+        uint64_t h = static_cast<uint64_t>(std::hash<K>{}(key)) * 0xC2B2AE3D27D4EB4Full;
+        return static_cast<size_t>(h >> 40) & (SHARDS - 1);
+    }
+
+    Shard& shardFor(const K& key) {
+        return shards[shardIndex(key)];
+    }
+
+    const Shard& shardFor(const K& key) const {
+        return shards[shardIndex(key)];
+    }
+
+public:
+    ConcurrentHashTable() = default;
+
+    ConcurrentHashTable(const ConcurrentHashTable&) = delete;
+    ConcurrentHashTable& operator=(const ConcurrentHashTable&) = delete;
+
+    // Insert or replace
+    void insert(const K& key, const V& value) {
+        Shard& shard = shardFor(key);
+        unique_lock<shared_mutex> guard(shard.lock);
+        shard.table.insert(key, value);
+    }
+
+    void insert(K&& key, V&& value) {
+        Shard& shard = shardFor(key);
+        unique_lock<shared_mutex> guard(shard.lock);
+        shard.table.insert(move(key), move(value));
+    }
+
+    // Insert if absent; returns false (and leaves the value) if present
+    template<typename... Args>
+    bool try_emplace(const K& key, Args&&... args) {
+        Shard& shard = shardFor(key);
+        unique_lock<shared_mutex> guard(shard.lock);
+        return shard.table.try_emplace(key, forward<Args>(args)...).second;
+    }
+
+    // Copies the value into `value`; false if absent
+    bool find(const K& key, V& value) const {
+        const Shard& shard = shardFor(key);
+        shared_lock<shared_mutex> guard(shard.lock);
+        const V* found = shard.table.find(key);
+        if (!found) {
+            return false;
+        }
+        value = *found;
+        return true;
+    }
+
+    bool contains(const K& key) const {
+        const Shard& shard = shardFor(key);
+        shared_lock<shared_mutex> guard(shard.lock);
+        return shard.table.contains(key);
+    }
+
+    // Run `update` on the value (default-constructed if absent) while the
+    // shard is locked, for read-modify-write without a lost update
+    template<typename F>
+    void upsert(const K& key, F update) {
+        Shard& shard = shardFor(key);
+        unique_lock<shared_mutex> guard(shard.lock);
+        update(*shard.table.try_emplace(key).first);
+    }
+
+    bool remove(const K& key) {
+        Shard& shard = shardFor(key);
+        unique_lock<shared_mutex> guard(shard.lock);
+        return shard.table.remove(key);
+    }
+
+    // Shards are counted one at a time, so under concurrent writes this is
+    // a snapshot of each shard, not of the whole map
+    size_t getSize() const {
+        size_t total = 0;
+        for (const Shard& shard : shards) {
+            shared_lock<shared_mutex> guard(shard.lock);
+            total += shard.table.getSize();
+        }
+        return total;
+    }
+
+    bool empty() const {
+        return getSize() == 0;
+    }
+
+    void reserve(size_t entries) {
+        for (Shard& shard : shards) {
+            unique_lock<shared_mutex> guard(shard.lock);
+            shard.table.reserve(entries / SHARDS + 1);
+        }
+    }
+
+    void clear() {
+        for (Shard& shard : shards) {
+            unique_lock<shared_mutex> guard(shard.lock);
+            shard.table.clear();
+        }
+    }
+
+    vector<V> getAllValues() const {
+        vector<V> values;
+        for (const Shard& shard : shards) {
+            shared_lock<shared_mutex> guard(shard.lock);
+            vector<V> part = shard.table.getAllValues();
+            values.insert(values.end(), part.begin(), part.end());
+        }
+        return values;
+    }
+};
+
+#endif // CONCURRENT_HASH_TABLE_H
@@ -0,0 +1,148 @@
+#ifndef GRADING_KERNEL_H
+#define GRADING_KERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// Answers and answer keys as one byte per question: the original option
+// (0-3), or UNANSWERED. An unanswered byte never equals a key byte, so it
+// is never counted correct.
+const uint8_t UNANSWERED = 0xFF;
+
+struct GradeCounts {
+    uint32_t correct;
+    uint32_t answered;
+
+    GradeCounts() : correct(0), answered(0) {}
+
+    uint32_t wrong() const { return answered - correct; }
+};
+
+// How an exam turns counts into marks: one mark per correct answer, less
+// negativeMarkValue per wrong answer when negative marking is on and
+// skipPenalty per unanswered question (0 = none)
+struct MarkingScheme {
+    bool negativeMarking;
+    double negativeMarkValue;
+    double skipPenalty;
+
+    MarkingScheme() : negativeMarking(false), negativeMarkValue(0.0), skipPenalty(0.0) {}
+    MarkingScheme(bool negativeMarking, double negativeMarkValue, double skipPenalty)
+        : negativeMarking(negativeMarking), negativeMarkValue(negativeMarkValue), skipPenalty(skipPenalty) {}
+
+    bool hasSkipPenalty() const { return skipPenalty > 0; }
+};
+
+struct GradeMarks {
+    GradeCounts counts;     // answered is only counted when a penalty needs it
+    double score;           // Never below 0
+    double negativeMarks;   // Taken off for wrong answers
+    double skipPenalties;   // Taken off for unanswered questions
+
+    GradeMarks() : score(0.0), negativeMarks(0.0), skipPenalties(0.0) {}
+};
+
+// Grades byte-packed answer sheets against a key in one pass, counting
+// correct and (optionally) answered answers together. With SSE2 (every x86-64 target) it
+// compares 16 answers per instruction and counts the matches in byte lanes,
+// folded into totals every 255 blocks before a lane can overflow; elsewhere,
+// and for the tail, it falls back to a scalar loop.
+class GradingKernel {
+private:
+    template <bool CountAnswered>
+    static void gradeScalar(const uint8_t* answers, const uint8_t* key, size_t n, GradeCounts& counts) {
+        for (size_t i = 0; i < n; ++i) {
+            counts.correct += answers[i] == key[i];
+            if (CountAnswered) counts.answered += answers[i] != UNANSWERED;
+        }
+    }
+
+public:
+    // Without CountAnswered only correct answers are counted (answered
+    // stays 0), which halves the compares when no penalty needs it
+    template <bool CountAnswered = true>
+    static GradeCounts grade(const uint8_t* answers, const uint8_t* key, size_t n) {
+        GradeCounts counts;
+        size_t i = 0;
+#ifdef __SSE2__
+        const __m128i unanswered = _mm_set1_epi8(static_cast<char>(UNANSWERED));
+        const __m128i zero = _mm_setzero_si128();
+        uint64_t skipped = 0;
+        while (n - i >= 16) {
+            // Each matching lane is -1, so subtracting the mask counts it
+            __m128i correctLanes = zero;
+            __m128i skippedLanes = zero;
+            size_t blocks = (n - i) / 16;
+            if (blocks > 255) blocks = 255;
+            for (size_t b = 0; b < blocks; ++b, i += 16) {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(answers + i));
+                __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + i));
+                correctLanes = _mm_sub_epi8(correctLanes, _mm_cmpeq_epi8(a, k));
+                if (CountAnswered) skippedLanes = _mm_sub_epi8(skippedLanes, _mm_cmpeq_epi8(a, unanswered));
+            }
+            // Sum the byte lanes into two 64-bit halves
+            __m128i correctSums = _mm_sad_epu8(correctLanes, zero);
+            counts.correct += static_cast<uint32_t>(_mm_cvtsi128_si32(correctSums) +
+                                                    _mm_cvtsi128_si32(_mm_srli_si128(correctSums, 8)));
+            if (CountAnswered) {
+                __m128i skippedSums = _mm_sad_epu8(skippedLanes, zero);
+                skipped += static_cast<uint32_t>(_mm_cvtsi128_si32(skippedSums) +
+                                                 _mm_cvtsi128_si32(_mm_srli_si128(skippedSums, 8)));
+            }
+        }
+        if (CountAnswered) counts.answered = static_cast<uint32_t>(i - skipped);
+#endif
+        gradeScalar<CountAnswered>(answers + i, key + i, n - i, counts);
+        return counts;
+    }
+};
+
+// One grading kernel per combination of marking rules, chosen at compile
+// time: the count pass and the arithmetic for rules that are off are not
+// generated at all, so a sheet is graded with no per-question or per-rule
+// branches. GradingPolicies::forScheme() picks the instantiation from an
+// exam's settings at run time, once per exam rather than per question.
+template <bool NegativeMarking, bool SkipPenalty>
+struct GradingPolicy {
+    static constexpr bool COUNTS_ANSWERED = NegativeMarking || SkipPenalty;
+
+    static GradeMarks grade(const uint8_t* answers, const uint8_t* key, size_t n, const MarkingScheme& scheme) {
+        GradeMarks marks;
+        marks.counts = GradingKernel::grade<COUNTS_ANSWERED>(answers, key, n);
+        double score = marks.counts.correct;
+        if (NegativeMarking) {
+            marks.negativeMarks = marks.counts.wrong() * scheme.negativeMarkValue;
+            score -= marks.negativeMarks;
+        }
+        if (SkipPenalty) {
+            marks.skipPenalties = (n - marks.counts.answered) * scheme.skipPenalty;
+            score -= marks.skipPenalties;
+        }
+        marks.score = score < 0 ? 0 : score;
+        return marks;
+    }
+};
+
+class GradingPolicies {
+public:
+    typedef GradeMarks (*GradeFunction)(const uint8_t* answers, const uint8_t* key, size_t n,
+                                        const MarkingScheme& scheme);
+
+    static GradeFunction forScheme(const MarkingScheme& scheme) {
+        static const GradeFunction table[2][2] = {
+            {&GradingPolicy<false, false>::grade, &GradingPolicy<false, true>::grade},
+            {&GradingPolicy<true, false>::grade, &GradingPolicy<true, true>::grade}};
+        return table[scheme.negativeMarking][scheme.hasSkipPenalty()];
+    }
+
+    static GradeMarks grade(const uint8_t* answers, const uint8_t* key, size_t n, const MarkingScheme& scheme) {
+        return forScheme(scheme)(answers, key, n, scheme);
+    }
+};
+
+#endif // GRADING_KERNEL_H
@@ -6,197 +6,510 @@
 #include <iostream>
 #include <algorithm>
 #include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HASH_TABLE_SSE2 1
+#endif
 
 using namespace std;
 
+// Open-addressing hash table in the Swiss-table layout. Each slot has one
+// control byte: empty, deleted, or the low 7 bits of its key's hash. Lookups
+// compare a whole group of 16 control bytes at once (SSE2 where available)
+// and only touch the keys whose byte matches. Capacity is a power of two,
+// so the home group is a mask, not a division. Keys and values live in a
+// separate slot array and are moved, not copied, when the table grows.
+//
+// Tables keyed by string also take string_view and C strings for lookups
+// (find, contains, remove, try_emplace), so a probe never has to build a
+// string; one is only constructed when try_emplace inserts.
 template<typename K, typename V>
 class HashTable {
 private:
-    struct Entry {
+    struct Slot {
         K key;
         V value;
-        bool occupied;
-        bool deleted;
-        
-        Entry() : occupied(false), deleted(false) {}
     };
-    
-    vector<Entry> table;
-    size_t capacity;
+
+    static constexpr size_t GROUP_WIDTH = 16;
+    static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+    static constexpr int8_t CTRL_EMPTY = -128;
+    static constexpr int8_t CTRL_DELETED = -2;
+    static constexpr double MAX_LOAD_LIMIT = 0.875;
+
+    // Bit i is set when control byte i of the group matches
+    class Group {
+    private:
+#ifdef HASH_TABLE_SSE2
+        __m128i bytes;
+
+    public:
+        explicit Group(const int8_t* ctrl) : bytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+        uint32_t match(int8_t h2) const {
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(h2))));
+        }
+
+        uint32_t matchEmpty() const {
+            return match(CTRL_EMPTY);
+        }
+
+        // Empty and deleted are the only control bytes with the sign bit set
+        uint32_t matchEmptyOrDeleted() const {
+            return static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+        }
+#else
+        const int8_t* bytes;
+
+    public:
+        explicit Group(const int8_t* ctrl) : bytes(ctrl) {}
+
+        uint32_t match(int8_t h2) const {
+            uint32_t bits = 0;
+            for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+                if (bytes[i] == h2) bits |= 1u << i;
+            }
+            return bits;
+        }
+
+        uint32_t matchEmpty() const {
+            return match(CTRL_EMPTY);
+        }
+
+        uint32_t matchEmptyOrDeleted() const {
+            uint32_t bits = 0;
+            for (size_t i = 0; i < GROUP_WIDTH; ++i) {
+                if (bytes[i] < 0) bits |= 1u << i;
+            }
+            return bits;
+        }
+#endif
+    };
+
+    int8_t* ctrl;           // One control byte per slot
+    Slot* slots;            // Constructed only where the control byte is full
+    size_t capacity;        // 0, or a power of two >= GROUP_WIDTH
     size_t size;
-    double maxLoadFactor;
-    
-    size_t hash(const K& key) const {
-        return std::hash<K>{}(key) % capacity;
+    size_t deleted;         // Tombstones left by remove()
+    double maxLoadFactor;   // Live entries plus tombstones, as a share of capacity
+
+    static size_t lowestBit(uint32_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<size_t>(__builtin_ctz(bits));
+#else
+        size_t index = 0;
+        while (!(bits & 1u)) {
+            bits >>= 1;
+            index++;
+        }
+        return index;
+#endif
+    }
+
+    // Lookup key types accepted besides K itself
+    template<typename Q>
+    static constexpr bool transparent = is_same<K, string>::value && !is_same<decay_t<Q>, string>::value &&
+                                        is_convertible<const Q&, string_view>::value;
+
+    // std::hash is the identity for integers; spread every input bit over
+    // the high bits (group) and the low 7 bits (control byte)
+    static uint64_t mix(size_t raw) {
+        uint64_t h = static_cast<uint64_t>(raw) * 0x9E3779B97F4A7C15ull;
+        return h ^ (h >> 32);
+    }
+
+    static uint64_t hash(const K& key) {
+        return mix(std::hash<K>{}(key));
+    }
+
+    // std::hash gives a string and a string_view of the same characters the
+    // same value, so both land in the same group
+    template<typename Q, enable_if_t<transparent<Q>, int> = 0>
+    static uint64_t hash(const Q& key) {
+        return mix(std::hash<string_view>{}(string_view(key)));
+    }
+
+    static int8_t h2(uint64_t h) {
+        return static_cast<int8_t>(h & 0x7F);
+    }
+
+    size_t groupMask() const {
+        return capacity / GROUP_WIDTH - 1;
+    }
+
+    size_t growthLimit(size_t forCapacity) const {
+        return static_cast<size_t>(forCapacity * maxLoadFactor);
+    }
+
+    static size_t capacityFor(size_t entries, double loadFactor) {
+        size_t result = GROUP_WIDTH;
+        while (static_cast<size_t>(result * loadFactor) < entries) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    // Triangular probing over whole groups visits every group once
+    template<typename Q>
+    size_t findSlot(const Q& key, uint64_t h) const {
+        if (capacity == 0) return NOT_FOUND;
+
+        size_t mask = groupMask();
+        size_t group = static_cast<size_t>(h >> 7) & mask;
+        for (size_t step = 1; step <= mask + 1; ++step) {
+            size_t base = group * GROUP_WIDTH;
+            Group g(ctrl + base);
+            for (uint32_t bits = g.match(h2(h)); bits; bits &= bits - 1) {
+                size_t index = base + lowestBit(bits);
+                if (slots[index].key == key) {
+                    return index;
+                }
+            }
+            if (g.matchEmpty()) {
+                return NOT_FOUND;
+            }
+            group = (group + step) & mask;
+        }
+        return NOT_FOUND;
+    }
+
+    // First empty or deleted slot on the key's probe sequence
+    size_t findFree(uint64_t h) const {
+        size_t mask = groupMask();
+        size_t group = static_cast<size_t>(h >> 7) & mask;
+        for (size_t step = 1; ; ++step) {
+            size_t base = group * GROUP_WIDTH;
+            uint32_t bits = Group(ctrl + base).matchEmptyOrDeleted();
+            if (bits) {
+                return base + lowestBit(bits);
+            }
+            group = (group + step) & mask;
+        }
+    }
+
+    static int8_t* allocateCtrl(size_t count) {
+        int8_t* bytes = new int8_t[count];
+        memset(bytes, CTRL_EMPTY, count);
+        return bytes;
+    }
+
+    static Slot* allocateSlots(size_t count) {
+        return static_cast<Slot*>(::operator new(sizeof(Slot) * count, align_val_t(alignof(Slot))));
+    }
+
+    static void freeSlots(Slot* memory) {
+        ::operator delete(memory, align_val_t(alignof(Slot)));
+    }
+
+    void destroyAll() {
+        for (size_t i = 0; i < capacity; ++i) {
+            if (ctrl[i] >= 0) {
+                slots[i].~Slot();
+            }
+        }
     }
-    
-    size_t probe(size_t index) const {
-        return (index + 1) % capacity;
+
+    void release() {
+        if (capacity == 0) return;
+        destroyAll();
+        delete[] ctrl;
+        freeSlots(slots);
+        ctrl = nullptr;
+        slots = nullptr;
+        capacity = 0;
     }
-    
 
-    
-    void resize() {
-        vector<Entry> oldTable = table;
+    // Move every live entry into fresh arrays; tombstones are dropped
+    void rehash(size_t newCapacity) {
+        int8_t* newCtrl = allocateCtrl(newCapacity);
+        Slot* newSlots = allocateSlots(newCapacity);
+
+        int8_t* oldCtrl = ctrl;
+        Slot* oldSlots = slots;
         size_t oldCapacity = capacity;
-        
-        capacity *= 2;
-        table = vector<Entry>(capacity);
-        size = 0;
-        
+
+        ctrl = newCtrl;
+        slots = newSlots;
+        capacity = newCapacity;
+        deleted = 0;
+
         for (size_t i = 0; i < oldCapacity; ++i) {
-            if (oldTable[i].occupied && !oldTable[i].deleted) {
-                insert(oldTable[i].key, oldTable[i].value);
+            if (oldCtrl[i] >= 0) {
+                uint64_t h = hash(oldSlots[i].key);
+                size_t index = findFree(h);
+                ctrl[index] = h2(h);
+                new (&slots[index]) Slot{move(oldSlots[i].key), move(oldSlots[i].value)};
+                oldSlots[i].~Slot();
             }
         }
+
+        if (oldCapacity > 0) {
+            delete[] oldCtrl;
+            freeSlots(oldSlots);
+        }
+    }
+
+    // Slot of `key`, claiming a free one if absent (second = true; the slot
+    // is then unconstructed and the caller must construct it)
+    template<typename Q>
+    pair<size_t, bool> findOrPrepareInsert(const Q& key) {
+        uint64_t h = hash(key);
+        size_t existing = findSlot(key, h);
+        if (existing != NOT_FOUND) {
+            return {existing, false};
+        }
+
+        if (capacity == 0 || size + deleted + 1 > growthLimit(capacity)) {
+            // Grow when live entries fill half the limit; otherwise the
+            // tombstones are the problem and a same-size rehash clears them
+            bool grow = capacity == 0 || (size + 1) * 2 > growthLimit(capacity);
+            rehash(grow ? max(capacity * 2, capacityFor(size + 1, maxLoadFactor)) : capacity);
+        }
+
+        size_t index = findFree(h);
+        if (ctrl[index] == CTRL_DELETED) {
+            deleted--;
+        }
+        ctrl[index] = h2(h);
+        size++;
+        return {index, true};
+    }
+
+    template<typename KK, typename... Args>
+    void construct(size_t index, KK&& key, Args&&... args) {
+        try {
+            new (&slots[index]) Slot{K(forward<KK>(key)), V(forward<Args>(args)...)};
+        } catch (...) {
+            ctrl[index] = CTRL_DELETED;
+            deleted++;
+            size--;
+            throw;
+        }
+    }
+
+    template<typename KK, typename VV>
+    void insertOrAssign(KK&& key, VV&& value) {
+        pair<size_t, bool> slot = findOrPrepareInsert(key);
+        if (slot.second) {
+            construct(slot.first, forward<KK>(key), forward<VV>(value));
+        } else {
+            slots[slot.first].value = forward<VV>(value);
+        }
+    }
+
+    template<typename KK, typename... Args>
+    pair<V*, bool> tryEmplace(KK&& key, Args&&... args) {
+        pair<size_t, bool> slot = findOrPrepareInsert(key);
+        if (slot.second) {
+            construct(slot.first, forward<KK>(key), forward<Args>(args)...);
+        }
+        return {&slots[slot.first].value, slot.second};
     }
-    
+
 public:
-    HashTable(size_t initialCapacity = 16, double maxLoad = 0.75) 
-        : capacity(initialCapacity), size(0), maxLoadFactor(maxLoad) {
-        table.resize(capacity);
+    HashTable(size_t initialCapacity = 16, double maxLoad = 0.75)
+        : ctrl(nullptr), slots(nullptr), capacity(0), size(0), deleted(0),
+          maxLoadFactor(maxLoad > 0 && maxLoad < MAX_LOAD_LIMIT ? maxLoad : MAX_LOAD_LIMIT) {
+        size_t initial = GROUP_WIDTH;
+        while (initial < initialCapacity) {
+            initial *= 2;
+        }
+        rehash(initial);
     }
-    
-    void insert(const K& key, const V& value) {
-        if (static_cast<double>(size) / capacity >= maxLoadFactor) {
-            resize();
-        }
-        
-        size_t index = hash(key);
-        size_t originalIndex = index;
-        size_t attempt = 0;
-        
-        do {
-            if (!table[index].occupied || table[index].deleted) {
-                if (!table[index].occupied || table[index].deleted) {
-                    size++;
-                }
-                table[index].key = key;
-                table[index].value = value;
-                table[index].occupied = true;
-                table[index].deleted = false;
-                return;
-            }
-            
-            if (table[index].key == key) {
-                // Update existing key
-                table[index].value = value;
-                return;
+
+    HashTable(const HashTable& other)
+        : ctrl(nullptr), slots(nullptr), capacity(0), size(0), deleted(0),
+          maxLoadFactor(other.maxLoadFactor) {
+        if (other.capacity == 0) return;
+
+        ctrl = allocateCtrl(other.capacity);
+        slots = allocateSlots(other.capacity);
+        capacity = other.capacity;
+        for (size_t i = 0; i < capacity; ++i) {
+            if (other.ctrl[i] >= 0) {
+                new (&slots[i]) Slot(other.slots[i]);
+                ctrl[i] = other.ctrl[i];
+                size++;
+            } else if (other.ctrl[i] == CTRL_DELETED) {
+                ctrl[i] = CTRL_DELETED;
+                deleted++;
             }
-            
-            // Linear probing
-            index = probe(index);
-            attempt++;
-            
-        } while (index != originalIndex && attempt < capacity);
-        
-        // If we reach here, table is full (shouldn't happen with proper resizing)
-        throw runtime_error("Hash table is full");
-    }
-    
+        }
+    }
+
+    HashTable(HashTable&& other) noexcept
+        : ctrl(other.ctrl), slots(other.slots), capacity(other.capacity), size(other.size),
+          deleted(other.deleted), maxLoadFactor(other.maxLoadFactor) {
+        other.ctrl = nullptr;
+        other.slots = nullptr;
+        other.capacity = 0;
+        other.size = 0;
+        other.deleted = 0;
+    }
+
+    HashTable& operator=(HashTable other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~HashTable() {
+        release();
+    }
+
+    void swap(HashTable& other) noexcept {
+        std::swap(ctrl, other.ctrl);
+        std::swap(slots, other.slots);
+        std::swap(capacity, other.capacity);
+        std::swap(size, other.size);
+        std::swap(deleted, other.deleted);
+        std::swap(maxLoadFactor, other.maxLoadFactor);
+    }
+
+    // Insert, or replace the value of an existing key
+    void insert(const K& key, const V& value) {
+        insertOrAssign(key, value);
+    }
+
+    void insert(K&& key, V&& value) {
+        insertOrAssign(move(key), move(value));
+    }
+
+    // Construct the value from `args` only if the key is absent. Returns the
+    // value now stored under the key and whether it was inserted.
+    template<typename... Args>
+    pair<V*, bool> try_emplace(const K& key, Args&&... args) {
+        return tryEmplace(key, forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    pair<V*, bool> try_emplace(K&& key, Args&&... args) {
+        return tryEmplace(move(key), forward<Args>(args)...);
+    }
+
+    template<typename Q, typename... Args>
+    auto try_emplace(const Q& key, Args&&... args) -> enable_if_t<transparent<Q>, pair<V*, bool>> {
+        return tryEmplace(key, forward<Args>(args)...);
+    }
+
+    // Insert if absent; an existing value is left unchanged
+    pair<V*, bool> emplace(K key, V value) {
+        return tryEmplace(move(key), move(value));
+    }
+
+    // Room for `entries` without rehashing
+    void reserve(size_t entries) {
+        size_t needed = capacityFor(entries, maxLoadFactor);
+        if (needed > capacity) {
+            rehash(needed);
+        }
+    }
+
     V* find(const K& key) {
-        size_t index = hash(key);
-        size_t originalIndex = index;
-        size_t attempt = 0;
-        
-        do {
-            if (!table[index].occupied) {
-                return nullptr;
-            }
-            
-            if (!table[index].deleted && table[index].key == key) {
-                return &table[index].value;
-            }
-            
-            index = probe(index);
-            attempt++;
-            
-        } while (index != originalIndex && attempt < capacity);
-        
-        return nullptr;
-    }
-    
+        size_t index = findSlot(key, hash(key));
+        return index != NOT_FOUND ? &slots[index].value : nullptr;
+    }
+
     const V* find(const K& key) const {
-        size_t index = hash(key);
-        size_t originalIndex = index;
-        size_t attempt = 0;
-        
-        do {
-            if (!table[index].occupied) {
-                return nullptr;
-            }
-            
-            if (!table[index].deleted && table[index].key == key) {
-                return &table[index].value;
-            }
-            
-            index = probe(index);
-            attempt++;
-            
-        } while (index != originalIndex && attempt < capacity);
-        
-        return nullptr;
-    }
-    
+        size_t index = findSlot(key, hash(key));
+        return index != NOT_FOUND ? &slots[index].value : nullptr;
+    }
+
+    template<typename Q, enable_if_t<transparent<Q>, int> = 0>
+    V* find(const Q& key) {
+        size_t index = findSlot(key, hash(key));
+        return index != NOT_FOUND ? &slots[index].value : nullptr;
+    }
+
+    template<typename Q, enable_if_t<transparent<Q>, int> = 0>
+    const V* find(const Q& key) const {
+        size_t index = findSlot(key, hash(key));
+        return index != NOT_FOUND ? &slots[index].value : nullptr;
+    }
+
     bool remove(const K& key) {
-        size_t index = hash(key);
-        size_t originalIndex = index;
-        size_t attempt = 0;
-        
-        do {
-            if (!table[index].occupied) {
-                return false;
-            }
-            
-            if (!table[index].deleted && table[index].key == key) {
-                table[index].deleted = true;
-                size--;
-                return true;
-            }
-            
-            index = probe(index);
-            attempt++;
-            
-        } while (index != originalIndex && attempt < capacity);
-        
-        return false;
-    }
-    
+        return eraseFound(findSlot(key, hash(key)));
+    }
+
+    template<typename Q, enable_if_t<transparent<Q>, int> = 0>
+    bool remove(const Q& key) {
+        return eraseFound(findSlot(key, hash(key)));
+    }
+
     bool contains(const K& key) const {
         return find(key) != nullptr;
     }
-    
-    size_t getSize() const { 
-        return size; 
+
+    template<typename Q, enable_if_t<transparent<Q>, int> = 0>
+    bool contains(const Q& key) const {
+        return find(key) != nullptr;
     }
-    
-    bool empty() const { 
-        return size == 0; 
+
+private:
+    bool eraseFound(size_t index) {
+        if (index == NOT_FOUND) {
+            return false;
+        }
+
+        slots[index].~Slot();
+        size--;
+
+        // A group that still has an empty slot never sent a probe on to the
+        // next group, so the slot can go straight back to empty; only slots
+        // in full groups need a tombstone (cleared by the next rehash)
+        size_t base = index & ~(GROUP_WIDTH - 1);
+        if (Group(ctrl + base).matchEmpty()) {
+            ctrl[index] = CTRL_EMPTY;
+        } else {
+            ctrl[index] = CTRL_DELETED;
+            deleted++;
+        }
+        return true;
     }
-    
+
+public:
+    size_t getSize() const {
+        return size;
+    }
+
+    bool empty() const {
+        return size == 0;
+    }
+
     double getLoadFactor() const {
-        return static_cast<double>(size) / capacity;
+        return capacity ? static_cast<double>(size) / capacity : 0.0;
     }
-    
+
     size_t getCapacity() const {
         return capacity;
     }
-    
+
     void clear() {
-        table = vector<Entry>(capacity);
+        if (capacity == 0) return;
+        destroyAll();
+        memset(ctrl, CTRL_EMPTY, capacity);
         size = 0;
+        deleted = 0;
     }
-    
+
     // Get all values for cleanup purposes
     vector<V> getAllValues() const {
         vector<V> values;
-        for (const auto& entry : table) {
-            if (entry.occupied && !entry.deleted) {
-                values.push_back(entry.value);
+        values.reserve(size);
+        for (size_t i = 0; i < capacity; ++i) {
+            if (ctrl[i] >= 0) {
+                values.push_back(slots[i].value);
             }
         }
         return values;
     }
 };
 
-#endif // HASH_TABLE_H
\ No newline at end of file
+#endif // HASH_TABLE_H
@@ -0,0 +1,161 @@
+#ifndef PERMUTATION_H
+#define PERMUTATION_H
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+using namespace std;
+
+// Counter-based random stream: value i is a pure function of (key, i), so a
+// stream is replayed from its key alone and nothing but the counter is kept
+// between draws. Each value is the SplitMix64 finaliser of key + i * golden.
+class CounterRng {
+private:
+    uint64_t key;
+    uint64_t counter;
+
+public:
+    explicit CounterRng(uint64_t key) : key(key), counter(0) {}
+
+    static uint64_t mix(uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    uint64_t next() {
+        return mix(key + 0x9E3779B97F4A7C15ull * ++counter);
+    }
+
+    // Uniform in [0, bound); draws below 2^64 mod bound are rejected so the
+    // remainder is not biased towards small values
+    uint64_t below(uint64_t bound) {
+        uint64_t threshold = (0 - bound) % bound;
+        for (;;) {
+            uint64_t value = next();
+            if (value >= threshold) {
+                return value % bound;
+            }
+        }
+    }
+};
+
+// Key for one student's attempt at one exam template. attemptSeed is stored
+// with the result (its start time), so the same order can be rebuilt for
+// review or regrading.
+inline uint64_t permutationKey(int examTemplateId, int userId, long long attemptSeed) {
+    uint64_t h = CounterRng::mix(static_cast<uint32_t>(examTemplateId));
+    h = CounterRng::mix(h ^ static_cast<uint32_t>(userId));
+    return CounterRng::mix(h ^ static_cast<uint64_t>(attemptSeed));
+}
+
+// Fisher-Yates: each of the first `count` positions (all by default) takes a
+// uniformly chosen element from those not yet placed. The rest are left in
+// an unspecified order, so a partial shuffle is a uniform random sample.
+template<typename T>
+void seededShuffle(vector<T>& items, uint64_t key, size_t count = static_cast<size_t>(-1)) {
+    CounterRng rng(key);
+    size_t n = items.size();
+    if (count > n) count = n;
+    for (size_t i = 0; i < count && i + 1 < n; ++i) {
+        size_t j = i + static_cast<size_t>(rng.below(n - i));
+        if (j != i) {
+            swap(items[i], items[j]);
+        }
+    }
+}
+
+// Indexes 0..n-1 in the order seededShuffle would put n items
+inline vector<size_t> seededPermutation(size_t n, uint64_t key) {
+    vector<size_t> order(n);
+    for (size_t i = 0; i < n; ++i) {
+        order[i] = i;
+    }
+    seededShuffle(order, key);
+    return order;
+}
+
+// The 24 orders of a question's four options, named by a one-byte code.
+// OPTION_ORDERS[code][slot] is the original option shown in display slot
+// `slot`; OPTION_SLOTS is the inverse. Code 0 is the unshuffled order.
+const int OPTION_COUNT = 4;
+const int OPTION_ORDER_CODES = 24;
+
+constexpr uint8_t OPTION_ORDERS[OPTION_ORDER_CODES][OPTION_COUNT] = {
+    {0, 1, 2, 3},
+    {0, 1, 3, 2},
+    {0, 2, 1, 3},
+    {0, 2, 3, 1},
+    {0, 3, 1, 2},
+    {0, 3, 2, 1},
+    {1, 0, 2, 3},
+    {1, 0, 3, 2},
+    {1, 2, 0, 3},
+    {1, 2, 3, 0},
+    {1, 3, 0, 2},
+    {1, 3, 2, 0},
+    {2, 0, 1, 3},
+    {2, 0, 3, 1},
+    {2, 1, 0, 3},
+    {2, 1, 3, 0},
+    {2, 3, 0, 1},
+    {2, 3, 1, 0},
+    {3, 0, 1, 2},
+    {3, 0, 2, 1},
+    {3, 1, 0, 2},
+    {3, 1, 2, 0},
+    {3, 2, 0, 1},
+    {3, 2, 1, 0}
+};
+
+constexpr uint8_t OPTION_SLOTS[OPTION_ORDER_CODES][OPTION_COUNT] = {
+    {0, 1, 2, 3},
+    {0, 1, 3, 2},
+    {0, 2, 1, 3},
+    {0, 3, 1, 2},
+    {0, 2, 3, 1},
+    {0, 3, 2, 1},
+    {1, 0, 2, 3},
+    {1, 0, 3, 2},
+    {2, 0, 1, 3},
+    {3, 0, 1, 2},
+    {2, 0, 3, 1},
+    {3, 0, 2, 1},
+    {1, 2, 0, 3},
+    {1, 3, 0, 2},
+    {2, 1, 0, 3},
+    {3, 1, 0, 2},
+    {2, 3, 0, 1},
+    {3, 2, 0, 1},
+    {1, 2, 3, 0},
+    {1, 3, 2, 0},
+    {2, 1, 3, 0},
+    {3, 1, 2, 0},
+    {2, 3, 1, 0},
+    {3, 2, 1, 0}
+};
+
+// Original option behind the display slot a student picked
+inline int originalOption(uint8_t code, int slot) {
+    return OPTION_ORDERS[code][slot];
+}
+
+// Display slot an original option was shown in
+inline int optionSlot(uint8_t code, int option) {
+    return OPTION_SLOTS[code][option];
+}
+
+// One option-order code per question. Drawn from a stream independent of
+// the question order's (the complemented key), so both can come from the
+// same attempt key.
+inline vector<uint8_t> seededOptionCodes(size_t n, uint64_t key) {
+    CounterRng rng(~key);
+    vector<uint8_t> codes(n);
+    for (size_t i = 0; i < n; ++i) {
+        codes[i] = static_cast<uint8_t>(rng.below(OPTION_ORDER_CODES));
+    }
+    return codes;
+}
+
+#endif // PERMUTATION_H
@@ -1,44 +1,206 @@
 #ifndef QUEUE_H
 #define QUEUE_H
 
-#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
 #include <stdexcept>
+#include <utility>
 
 using namespace std;
 
+namespace QueueDetail
+{
+    // Smallest power of two >= n (and >= 2)
+    inline size_t roundUpPowerOfTwo(size_t n)
+    {
+        size_t result = 2;
+        while (result < n)
+        {
+            result *= 2;
+        }
+        return result;
+    }
+
+    template <typename T>
+    T *allocate(size_t count)
+    {
+        return static_cast<T *>(::operator new(sizeof(T) * count, align_val_t(alignof(T))));
+    }
+
+    template <typename T>
+    void deallocate(T *memory)
+    {
+        ::operator delete(memory, align_val_t(alignof(T)));
+    }
+}
+
+// FIFO queue on a power-of-two ring buffer. Push and pop are O(1) and never
+// shift elements; an unbounded queue doubles its buffer when full. A queue
+// built with a maximum size allocates it up front and refuses pushes past
+// it (push throws, tryPush returns false).
 template <typename T>
 class Queue
 {
 private:
-    vector<T> data;
-    size_t frontIndex;
+    T *slots;        // Raw storage; only the `count` slots from head on are constructed
+    size_t capacity; // 0 or a power of two
+    size_t head;
+    size_t count;
+    size_t maxSize;  // 0 = unbounded
+
+    static const size_t MIN_CAPACITY = 8;
+
+    size_t slotAt(size_t offset) const
+    {
+        return (head + offset) & (capacity - 1);
+    }
+
+    // Move the elements, oldest first, into a buffer of newCapacity
+    void reallocate(size_t newCapacity)
+    {
+        T *newSlots = QueueDetail::allocate<T>(newCapacity);
+        for (size_t i = 0; i < count; ++i)
+        {
+            T &element = slots[slotAt(i)];
+            new (&newSlots[i]) T(move(element));
+            element.~T();
+        }
+        if (slots)
+        {
+            QueueDetail::deallocate(slots);
+        }
+        slots = newSlots;
+        capacity = newCapacity;
+        head = 0;
+    }
+
+    bool full() const
+    {
+        return maxSize != 0 && count >= maxSize;
+    }
+
+    // Free slot for the next element, growing an unbounded queue if needed
+    T *prepareBack()
+    {
+        if (count == capacity)
+        {
+            reallocate(capacity ? capacity * 2 : MIN_CAPACITY);
+        }
+        return &slots[slotAt(count)];
+    }
 
 public:
-    Queue()
+    explicit Queue(size_t maxSize = 0)
+        : slots(nullptr), capacity(0), head(0), count(0), maxSize(maxSize)
+    {
+        if (maxSize != 0)
+        {
+            reallocate(QueueDetail::roundUpPowerOfTwo(maxSize));
+        }
+    }
+
+    Queue(const Queue &other)
+        : slots(nullptr), capacity(0), head(0), count(0), maxSize(other.maxSize)
+    {
+        if (other.capacity != 0)
+        {
+            reallocate(other.capacity);
+            for (size_t i = 0; i < other.count; ++i)
+            {
+                new (&slots[i]) T(other.slots[other.slotAt(i)]);
+                count++;
+            }
+        }
+    }
+
+    Queue(Queue &&other) noexcept
+        : slots(other.slots), capacity(other.capacity), head(other.head), count(other.count), maxSize(other.maxSize)
+    {
+        other.slots = nullptr;
+        other.capacity = 0;
+        other.head = 0;
+        other.count = 0;
+    }
+
+    Queue &operator=(Queue other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    ~Queue()
+    {
+        clear();
+        if (slots)
+        {
+            QueueDetail::deallocate(slots);
+        }
+    }
+
+    void swap(Queue &other) noexcept
+    {
+        std::swap(slots, other.slots);
+        std::swap(capacity, other.capacity);
+        std::swap(head, other.head);
+        std::swap(count, other.count);
+        std::swap(maxSize, other.maxSize);
+    }
+
+    template <typename... Args>
+    T &emplace(Args &&...args)
     {
-        frontIndex = 0;
+        if (full())
+        {
+            throw runtime_error("Queue is full");
+        }
+        T *slot = new (prepareBack()) T(forward<Args>(args)...);
+        count++;
+        return *slot;
     }
 
     void push(const T &value)
     {
-        data.push_back(value);
+        emplace(value);
     }
 
-    void pop()
+    void push(T &&value)
     {
-        if (empty())
+        emplace(move(value));
+    }
+
+    // Bounded queues: false instead of throwing when full
+    bool tryPush(const T &value)
+    {
+        if (full())
         {
-            throw runtime_error("Queue is empty");
+            return false;
         }
+        emplace(value);
+        return true;
+    }
 
-        frontIndex++;
+    bool tryPush(T &&value)
+    {
+        if (full())
+        {
+            return false;
+        }
+        emplace(move(value));
+        return true;
+    }
 
-        // Optimize memory usage by removing processed elements
-        if (frontIndex > data.size() / 2 && frontIndex > 100)
+    void pop()
+    {
+        if (empty())
         {
-            data.erase(data.begin(), data.begin() + frontIndex);
-            frontIndex = 0;
+            throw runtime_error("Queue is empty");
         }
+
+        slots[head].~T();
+        head = slotAt(1);
+        count--;
     }
 
     T &front()
@@ -47,7 +209,7 @@ public:
         {
             throw runtime_error("Queue is empty");
         }
-        return data[frontIndex];
+        return slots[head];
     }
 
     const T &front() const
@@ -56,24 +218,318 @@ public:
         {
             throw runtime_error("Queue is empty");
         }
-        return data[frontIndex];
+        return slots[head];
     }
 
     bool empty() const
     {
-        return frontIndex >= data.size();
+        return count == 0;
     }
 
     size_t size() const
     {
-        return data.size() - frontIndex;
+        return count;
+    }
+
+    size_t getCapacity() const
+    {
+        return capacity;
     }
 
+    // Keeps the buffer for reuse
     void clear()
     {
-        data.clear();
-        frontIndex = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            slots[slotAt(i)].~T();
+        }
+        head = 0;
+        count = 0;
+    }
+};
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. push/emplace may only be called by the producer; front/pop/tryPop
+// only by the consumer. Positions only ever increase, and each side keeps a
+// cached copy of the other's position so it touches the shared cache line
+// only when the queue looks full (producer) or empty (consumer).
+template <typename T>
+class SpscQueue
+{
+private:
+    static const size_t CACHE_LINE = 64;
+
+    T *slots;
+    size_t mask;
+
+    alignas(CACHE_LINE) atomic<size_t> head; // Next slot to pop (written by the consumer)
+    size_t cachedTail;                       // Consumer's last view of tail
+
+    alignas(CACHE_LINE) atomic<size_t> tail; // Next slot to fill (written by the producer)
+    size_t cachedHead;                       // Producer's last view of head
+
+public:
+    explicit SpscQueue(size_t capacity)
+        : slots(QueueDetail::allocate<T>(QueueDetail::roundUpPowerOfTwo(capacity))),
+          mask(QueueDetail::roundUpPowerOfTwo(capacity) - 1),
+          head(0), cachedTail(0), tail(0), cachedHead(0)
+    {
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    ~SpscQueue()
+    {
+        for (size_t i = head.load(memory_order_relaxed); i != tail.load(memory_order_relaxed); ++i)
+        {
+            slots[i & mask].~T();
+        }
+        QueueDetail::deallocate(slots);
+    }
+
+    // Producer only; false if full
+    template <typename... Args>
+    bool emplace(Args &&...args)
+    {
+        size_t position = tail.load(memory_order_relaxed);
+        if (position - cachedHead > mask)
+        {
+            cachedHead = head.load(memory_order_acquire);
+            if (position - cachedHead > mask)
+            {
+                return false;
+            }
+        }
+        new (&slots[position & mask]) T(forward<Args>(args)...);
+        tail.store(position + 1, memory_order_release);
+        return true;
+    }
+
+    bool push(const T &value)
+    {
+        return emplace(value);
+    }
+
+    bool push(T &&value)
+    {
+        return emplace(move(value));
+    }
+
+    // Consumer only; nullptr if empty. Valid until the consumer pops it.
+    T *front()
+    {
+        size_t position = head.load(memory_order_relaxed);
+        if (position == cachedTail)
+        {
+            cachedTail = tail.load(memory_order_acquire);
+            if (position == cachedTail)
+            {
+                return nullptr;
+            }
+        }
+        return &slots[position & mask];
+    }
+
+    // Consumer only; false if empty
+    bool pop()
+    {
+        T *element = front();
+        if (!element)
+        {
+            return false;
+        }
+        element->~T();
+        head.store(head.load(memory_order_relaxed) + 1, memory_order_release);
+        return true;
+    }
+
+    // Consumer only; moves the oldest element into `value`
+    bool tryPop(T &value)
+    {
+        T *element = front();
+        if (!element)
+        {
+            return false;
+        }
+        value = move(*element);
+        return pop();
+    }
+
+    // Exact only when neither side is running
+    size_t size() const
+    {
+        return tail.load(memory_order_acquire) - head.load(memory_order_acquire);
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    size_t getCapacity() const
+    {
+        return mask + 1;
+    }
+};
+
+// Bounded lock-free queue for any number of producers and consumers. Each
+// slot carries a sequence number saying whose turn it is: a producer may
+// fill slot i of lap n when it reads i + n * capacity, a consumer may empty
+// it when it reads one more. Threads claim positions with a CAS and never
+// wait on each other's locks. There is no front(): with several consumers
+// the element could be taken between looking and popping, so tryPop moves
+// it out in one step.
+template <typename T>
+class MpmcQueue
+{
+private:
+    static const size_t CACHE_LINE = 64;
+
+    struct Cell
+    {
+        atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T *element()
+        {
+            return reinterpret_cast<T *>(storage);
+        }
+    };
+
+    Cell *cells;
+    size_t mask;
+
+    alignas(CACHE_LINE) atomic<size_t> enqueuePosition;
+    alignas(CACHE_LINE) atomic<size_t> dequeuePosition;
+
+    static ptrdiff_t distance(size_t sequence, size_t position)
+    {
+        return static_cast<ptrdiff_t>(sequence - position);
+    }
+
+public:
+    explicit MpmcQueue(size_t capacity)
+        : cells(QueueDetail::allocate<Cell>(QueueDetail::roundUpPowerOfTwo(capacity))),
+          mask(QueueDetail::roundUpPowerOfTwo(capacity) - 1),
+          enqueuePosition(0), dequeuePosition(0)
+    {
+        for (size_t i = 0; i <= mask; ++i)
+        {
+            new (&cells[i]) Cell();
+            cells[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue &) = delete;
+    MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+    ~MpmcQueue()
+    {
+        size_t end = enqueuePosition.load(memory_order_relaxed);
+        for (size_t i = dequeuePosition.load(memory_order_relaxed); i != end; ++i)
+        {
+            cells[i & mask].element()->~T();
+        }
+        for (size_t i = 0; i <= mask; ++i)
+        {
+            cells[i].~Cell();
+        }
+        QueueDetail::deallocate(cells);
+    }
+
+    // False if full
+    template <typename... Args>
+    bool emplace(Args &&...args)
+    {
+        size_t position = enqueuePosition.load(memory_order_relaxed);
+        Cell *cell;
+        for (;;)
+        {
+            cell = &cells[position & mask];
+            ptrdiff_t lag = distance(cell->sequence.load(memory_order_acquire), position);
+            if (lag == 0)
+            {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (lag < 0)
+            {
+                return false; // The slot still holds last lap's element
+            }
+            else
+            {
+                position = enqueuePosition.load(memory_order_relaxed);
+            }
+        }
+
+        new (cell->element()) T(forward<Args>(args)...);
+        cell->sequence.store(position + 1, memory_order_release);
+        return true;
+    }
+
+    bool push(const T &value)
+    {
+        return emplace(value);
+    }
+
+    bool push(T &&value)
+    {
+        return emplace(move(value));
+    }
+
+    // False if empty
+    bool tryPop(T &value)
+    {
+        size_t position = dequeuePosition.load(memory_order_relaxed);
+        Cell *cell;
+        for (;;)
+        {
+            cell = &cells[position & mask];
+            ptrdiff_t lag = distance(cell->sequence.load(memory_order_acquire), position + 1);
+            if (lag == 0)
+            {
+                if (dequeuePosition.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (lag < 0)
+            {
+                return false; // Not yet filled this lap
+            }
+            else
+            {
+                position = dequeuePosition.load(memory_order_relaxed);
+            }
+        }
+
+        T *element = cell->element();
+        value = move(*element);
+        element->~T();
+        cell->sequence.store(position + mask + 1, memory_order_release);
+        return true;
+    }
+
+    // Approximate while other threads are pushing or popping
+    size_t size() const
+    {
+        size_t enqueued = enqueuePosition.load(memory_order_acquire);
+        size_t dequeued = dequeuePosition.load(memory_order_acquire);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    size_t getCapacity() const
+    {
+        return mask + 1;
     }
 };
 
-#endif // QUEUE_H
\ No newline at end of file
+#endif // QUEUE_H
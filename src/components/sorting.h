@@ -4,60 +4,152 @@
 #include <vector>
 #include <algorithm>
 #include <functional>
+#include <iterator>
+#include <thread>
 
 template<typename T>
 class SortingAlgorithms {
 public:
-    // Merge Sort with custom comparator (ONLY USED ALGORITHM)
+    // Runs this short are sorted by insertion before merging starts
+    static const size_t INSERTION_CUTOFF = 32;
+    // Below this many elements parallelMergeSort sorts on the calling thread
+    static const size_t PARALLEL_THRESHOLD = 1 << 15;
+
+    // Stable merge sort of arr[left..right] (inclusive) with a custom
+    // comparator (ONLY USED ALGORITHM). Bottom-up: insertion-sorted runs are
+    // merged pairwise with doubling width through one scratch buffer, and
+    // elements are moved, never copied.
     template<typename Compare>
     static void mergeSortCustom(vector<T>& arr, int left, int right, Compare comp) {
-        if (left < right) {
-            int mid = left + (right - left) / 2;
-            mergeSortCustom(arr, left, mid, comp);
-            mergeSortCustom(arr, mid + 1, right, comp);
-            mergeCustom(arr, left, mid, right, comp);
+        if (left >= right) return;
+        vector<T> buffer;
+        sortRange(arr, static_cast<size_t>(left), static_cast<size_t>(right) + 1, comp, buffer);
+    }
+
+    template<typename Compare>
+    static void mergeSortCustom(vector<T>& arr, Compare comp) {
+        if (arr.size() < 2) return;
+        vector<T> buffer;
+        sortRange(arr, 0, arr.size(), comp, buffer);
+    }
+
+    // Same result as mergeSortCustom. Large inputs are cut into one chunk per
+    // thread (a power of two, at most `threads`, 0 = hardware concurrency),
+    // the chunks are sorted concurrently, then neighbouring chunks are merged
+    // level by level, the merges of each level also running concurrently.
+    // `comp` is called from several threads at once.
+    template<typename Compare>
+    static void parallelMergeSort(vector<T>& arr, Compare comp, unsigned threads = 0) {
+        size_t n = arr.size();
+        size_t workers = threads ? threads : thread::hardware_concurrency();
+
+        size_t chunks = 1;
+        while (chunks * 2 <= workers && n / (chunks * 2) >= PARALLEL_THRESHOLD / 2) {
+            chunks *= 2;
+        }
+        if (chunks == 1) {
+            mergeSortCustom(arr, comp);
+            return;
+        }
+
+        vector<size_t> bounds(chunks + 1);
+        for (size_t c = 0; c <= chunks; ++c) {
+            bounds[c] = n * c / chunks;
+        }
+        vector<vector<T>> buffers(chunks);
+
+        // Buffer c also serves merge slot c at every level it is used on, so it
+        // is reserved up front for the largest left run it will hold there
+        runConcurrently(chunks, [&](size_t c) {
+            size_t largest = bounds[c + 1] - bounds[c];
+            for (size_t width = 1; width < chunks && c * 2 * width < chunks; width *= 2) {
+                size_t first = c * 2 * width;
+                largest = max(largest, bounds[first + width] - bounds[first]);
+            }
+            buffers[c].reserve(largest);
+            sortRange(arr, bounds[c], bounds[c + 1], comp, buffers[c]);
+        });
+
+        for (size_t width = 1; width < chunks; width *= 2) {
+            runConcurrently(chunks / (2 * width), [&, width](size_t m) {
+                size_t first = m * 2 * width;
+                mergeRuns(arr, bounds[first], bounds[first + width], bounds[first + 2 * width], comp, buffers[m]);
+            });
         }
     }
 
 private:
-    // Merge function for custom comparator
     template<typename Compare>
-    static void mergeCustom(vector<T>& arr, int left, int mid, int right, Compare comp) {
-        int n1 = mid - left + 1;
-        int n2 = right - mid;
-        
-        vector<T> leftArr(n1), rightArr(n2);
-        
-        for (int i = 0; i < n1; i++)
-            leftArr[i] = arr[left + i];
-        for (int j = 0; j < n2; j++)
-            rightArr[j] = arr[mid + 1 + j];
-        
-        int i = 0, j = 0, k = left;
-        
-        while (i < n1 && j < n2) {
-            if (!comp(rightArr[j], leftArr[i])) {
-                arr[k] = leftArr[i];
-                i++;
+    static void insertionSort(vector<T>& arr, size_t begin, size_t end, Compare& comp) {
+        for (size_t i = begin + 1; i < end; ++i) {
+            if (!comp(arr[i], arr[i - 1])) continue;
+
+            T value = move(arr[i]);
+            size_t j = i;
+            do {
+                arr[j] = move(arr[j - 1]);
+                --j;
+            } while (j > begin && comp(value, arr[j - 1]));
+            arr[j] = move(value);
+        }
+    }
+
+    // Merge the sorted runs arr[begin, mid) and arr[mid, end). Only the left
+    // run is moved out to the buffer; the output never overtakes the unread
+    // part of the right run, so that stays in place.
+    template<typename Compare>
+    static void mergeRuns(vector<T>& arr, size_t begin, size_t mid, size_t end, Compare& comp, vector<T>& buffer) {
+        if (!comp(arr[mid], arr[mid - 1])) return; // Already in order
+
+        buffer.clear();
+        buffer.insert(buffer.end(), make_move_iterator(arr.begin() + begin), make_move_iterator(arr.begin() + mid));
+
+        size_t i = 0, j = mid, k = begin;
+        size_t leftSize = buffer.size();
+
+        while (i < leftSize && j < end) {
+            // Ties take the left element, which keeps the sort stable
+            if (comp(arr[j], buffer[i])) {
+                arr[k++] = move(arr[j++]);
             } else {
-                arr[k] = rightArr[j];
-                j++;
+                arr[k++] = move(buffer[i++]);
             }
-            k++;
         }
-        
-        while (i < n1) {
-            arr[k] = leftArr[i];
-            i++;
-            k++;
+
+        while (i < leftSize) {
+            arr[k++] = move(buffer[i++]);
+        }
+    }
+
+    template<typename Compare>
+    static void sortRange(vector<T>& arr, size_t begin, size_t end, Compare& comp, vector<T>& buffer) {
+        size_t n = end - begin;
+        for (size_t run = begin; run < end; run += INSERTION_CUTOFF) {
+            insertionSort(arr, run, min(run + INSERTION_CUTOFF, end), comp);
+        }
+
+        // Reserved once, so no merge allocates
+        buffer.reserve(n);
+        for (size_t width = INSERTION_CUTOFF; width < n; width *= 2) {
+            for (size_t lo = begin; lo + width < end; lo += 2 * width) {
+                mergeRuns(arr, lo, lo + width, min(lo + 2 * width, end), comp, buffer);
+            }
+        }
+    }
+
+    // task(0 .. count-1), the last one on the calling thread
+    template<typename Task>
+    static void runConcurrently(size_t count, const Task& task) {
+        vector<thread> workers;
+        workers.reserve(count);
+        for (size_t i = 0; i + 1 < count; ++i) {
+            workers.emplace_back(task, i);
         }
-        
-        while (j < n2) {
-            arr[k] = rightArr[j];
-            j++;
-            k++;
+        task(count - 1);
+        for (thread& worker : workers) {
+            worker.join();
         }
     }
 };
 
-#endif // SORTING_H
\ No newline at end of file
+#endif // SORTING_H
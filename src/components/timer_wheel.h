@@ -0,0 +1,272 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Hierarchical timing wheel (Varghese & Lauck). Time is a tick count; the
+// caller decides what a tick is and calls advance() as the clock moves on.
+// LEVELS wheels of SLOTS buckets each: a timer due within SLOTS ticks sits
+// in level 0, one due within SLOTS^2 in level 1, and so on. When level 0
+// wraps, the next level-1 bucket is cascaded down (each timer re-filed by
+// its remaining time), so a timer is touched at most LEVELS times however
+// far off it is. Schedule, cancel and reschedule are O(1); advancing costs
+// O(1) per tick plus the timers that fire or cascade.
+//
+// Timers due further out than the wheel spans (SLOTS^LEVELS ticks) are
+// parked in the top level and re-filed when it comes round. Timers are
+// nodes in one pool, linked through indexes, so a wheel with tens of
+// thousands of timers allocates only when the pool grows.
+template <typename Payload>
+class TimerWheel
+{
+public:
+    typedef uint64_t TimerId; // Generation in the high 32 bits, pool index in the low
+    static constexpr TimerId NO_TIMER = 0;
+
+    static constexpr int LEVEL_BITS = 6;
+    static constexpr size_t SLOTS = size_t(1) << LEVEL_BITS;
+    static constexpr int LEVELS = 4;
+    static constexpr uint64_t SPAN = uint64_t(1) << (LEVEL_BITS * LEVELS);
+
+private:
+    static constexpr uint32_t NIL = 0xFFFFFFFFu;
+
+    struct Node
+    {
+        uint64_t expiry;
+        uint32_t prev;
+        uint32_t next;
+        uint32_t generation; // Bumped on release, so a stale TimerId misses
+        uint32_t bucket;     // level * SLOTS + slot, NIL when free
+        Payload payload;
+    };
+
+    vector<Node> nodes;
+    uint32_t freeList;
+    uint32_t buckets[LEVELS * SLOTS];
+    uint64_t occupied[LEVELS]; // Bit s set when bucket s of the level is non-empty
+    uint64_t current;          // Next tick to process
+    size_t count;
+
+    static TimerId makeId(uint32_t index, uint32_t generation)
+    {
+        return (static_cast<uint64_t>(generation) << 32) | index;
+    }
+
+    // Pool index of a live timer, NIL for a stale or unknown id
+    uint32_t lookup(TimerId id) const
+    {
+        uint32_t index = static_cast<uint32_t>(id);
+        if (index >= nodes.size())
+            return NIL;
+        const Node &node = nodes[index];
+        return node.bucket != NIL && node.generation == static_cast<uint32_t>(id >> 32) ? index : NIL;
+    }
+
+    void link(uint32_t index)
+    {
+        Node &node = nodes[index];
+        uint64_t due = node.expiry < current ? current : node.expiry;
+        uint64_t delta = due - current;
+        if (delta >= SPAN)
+        {
+            delta = SPAN - 1;
+            due = current + delta;
+        }
+
+        int level = 0;
+        while (delta >= (uint64_t(1) << (LEVEL_BITS * (level + 1))))
+            level++;
+        uint32_t slot = static_cast<uint32_t>((due >> (LEVEL_BITS * level)) & (SLOTS - 1));
+        uint32_t bucket = static_cast<uint32_t>(level * SLOTS + slot);
+
+        node.bucket = bucket;
+        node.prev = NIL;
+        node.next = buckets[bucket];
+        if (node.next != NIL)
+            nodes[node.next].prev = index;
+        buckets[bucket] = index;
+        occupied[level] |= uint64_t(1) << slot;
+    }
+
+    void unlink(uint32_t index)
+    {
+        Node &node = nodes[index];
+        if (node.prev != NIL)
+            nodes[node.prev].next = node.next;
+        else
+            buckets[node.bucket] = node.next;
+        if (node.next != NIL)
+            nodes[node.next].prev = node.prev;
+
+        if (buckets[node.bucket] == NIL)
+            occupied[node.bucket / SLOTS] &= ~(uint64_t(1) << (node.bucket % SLOTS));
+        node.bucket = NIL;
+    }
+
+    void release(uint32_t index)
+    {
+        Node &node = nodes[index];
+        node.generation++;
+        node.payload = Payload();
+        node.next = freeList;
+        freeList = index;
+        count--;
+    }
+
+    // Re-file every timer of a higher-level bucket by its remaining time
+    void cascade(int level, uint32_t slot)
+    {
+        uint32_t bucket = static_cast<uint32_t>(level * SLOTS + slot);
+        uint32_t index = buckets[bucket];
+        buckets[bucket] = NIL;
+        occupied[level] &= ~(uint64_t(1) << slot);
+        while (index != NIL)
+        {
+            uint32_t next = nodes[index].next;
+            link(index);
+            index = next;
+        }
+    }
+
+    // Process tick `current`: cascade whatever comes due at it, then fire
+    // its level-0 bucket. `current` moves on first, so a timer scheduled
+    // from fire() for this tick or earlier goes off on the next one.
+    template <typename Fire>
+    size_t processTick(Fire &fire)
+    {
+        uint64_t tick = current;
+        for (int level = 1; level < LEVELS; ++level)
+        {
+            if ((tick & ((uint64_t(1) << (LEVEL_BITS * level)) - 1)) != 0)
+                break;
+            cascade(level, static_cast<uint32_t>((tick >> (LEVEL_BITS * level)) & (SLOTS - 1)));
+        }
+        current = tick + 1;
+
+        uint32_t bucket = static_cast<uint32_t>(tick & (SLOTS - 1));
+        size_t fired = 0;
+        while (buckets[bucket] != NIL)
+        {
+            uint32_t index = buckets[bucket];
+            unlink(index);
+            TimerId id = makeId(index, nodes[index].generation);
+            Payload payload = move(nodes[index].payload);
+            release(index);
+            fire(id, payload);
+            fired++;
+        }
+        return fired;
+    }
+
+public:
+    explicit TimerWheel(uint64_t startTick = 0) : freeList(NIL), current(startTick), count(0)
+    {
+        for (uint32_t &bucket : buckets)
+            bucket = NIL;
+        for (uint64_t &bits : occupied)
+            bits = 0;
+    }
+
+    // Fire `payload` once `expiryTick` has been processed. A tick already
+    // past fires on the next advance.
+    TimerId schedule(uint64_t expiryTick, Payload payload)
+    {
+        uint32_t index;
+        if (freeList != NIL)
+        {
+            index = freeList;
+            freeList = nodes[index].next;
+        }
+        else
+        {
+            index = static_cast<uint32_t>(nodes.size());
+            nodes.push_back(Node());
+            nodes[index].generation = 1;
+        }
+
+        Node &node = nodes[index];
+        node.expiry = expiryTick;
+        node.payload = move(payload);
+        link(index);
+        count++;
+        return makeId(index, node.generation);
+    }
+
+    // False if the timer already fired or was cancelled
+    bool cancel(TimerId id)
+    {
+        uint32_t index = lookup(id);
+        if (index == NIL)
+            return false;
+        unlink(index);
+        release(index);
+        return true;
+    }
+
+    // Move a pending timer, keeping its id and payload
+    bool reschedule(TimerId id, uint64_t expiryTick)
+    {
+        uint32_t index = lookup(id);
+        if (index == NIL)
+            return false;
+        unlink(index);
+        nodes[index].expiry = expiryTick;
+        link(index);
+        return true;
+    }
+
+    bool isPending(TimerId id) const { return lookup(id) != NIL; }
+
+    Payload *payloadOf(TimerId id)
+    {
+        uint32_t index = lookup(id);
+        return index == NIL ? nullptr : &nodes[index].payload;
+    }
+
+    // Process every tick up to and including nowTick, calling
+    // fire(TimerId, Payload&) for each timer that comes due. fire may
+    // schedule and cancel timers. Returns the number fired.
+    template <typename Fire>
+    size_t advance(uint64_t nowTick, Fire fire)
+    {
+        size_t fired = 0;
+        while (current <= nowTick)
+        {
+            if (count == 0)
+            {
+                current = nowTick + 1;
+                break;
+            }
+            fired += processTick(fire);
+        }
+        return fired;
+    }
+
+    // Ticks from the next one to process until advance() may have something
+    // to do: exact when a timer sits in level 0, otherwise the next level-0
+    // wrap, where a cascade may bring timers down. SPAN when empty.
+    uint64_t ticksUntilNext() const
+    {
+        if (count == 0)
+            return SPAN;
+        uint32_t offset = static_cast<uint32_t>(current & (SLOTS - 1));
+        uint64_t ahead = occupied[0] >> offset;
+        if (ahead)
+            return static_cast<uint64_t>(__builtin_ctzll(ahead));
+        if (occupied[0]) // Only buckets behind the cursor, i.e. next time round
+            return SLOTS - offset + static_cast<uint64_t>(__builtin_ctzll(occupied[0]));
+        return (SLOTS - offset) & (SLOTS - 1);
+    }
+
+    uint64_t getCurrentTick() const { return current; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+};
+
+#endif // TIMER_WHEEL_H
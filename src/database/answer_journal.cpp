@@ -0,0 +1,442 @@
+#include "answer_journal.h"
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <tuple>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+using namespace std;
+
+static_assert(sizeof(JournalRecord) == 32, "journal records are fixed at 32 bytes");
+
+// First 64 bytes of the file; records follow
+struct AnswerJournal::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t capacity;
+    unsigned char unused[40];
+};
+
+static const char JOURNAL_MAGIC[8] = {'O', 'E', 'S', 'J', 'R', 'N', 'L', '1'};
+static const uint32_t JOURNAL_VERSION = 1;
+
+AnswerJournal::AnswerJournal(const string &journalPath, size_t capacity)
+    : path(journalPath), capacity(capacity), tail(0), nextSequence(1), mapping(nullptr), mappedBytes(0),
+#ifdef _WIN32
+      fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr),
+#else
+      fd(-1),
+#endif
+      syncedUpTo(0)
+{
+    lastSync = chrono::steady_clock::now();
+}
+
+AnswerJournal::~AnswerJournal()
+{
+    close();
+}
+
+uint32_t AnswerJournal::checksumOf(const JournalRecord &record)
+{
+    // FNV-1a over every byte before the checksum field
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&record);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(JournalRecord, checksum); ++i)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool AnswerJournal::isValid(const JournalRecord &record)
+{
+    return record.event != static_cast<uint8_t>(JournalEvent::NONE) && record.checksum == checksumOf(record);
+}
+
+JournalRecord *AnswerJournal::records() const
+{
+    return reinterpret_cast<JournalRecord *>(mapping + sizeof(Header));
+}
+
+bool AnswerJournal::open()
+{
+    lock_guard<mutex> lock(journalMutex);
+    return openFile();
+}
+
+void AnswerJournal::close()
+{
+    lock_guard<mutex> lock(journalMutex);
+    closeFile();
+}
+
+bool AnswerJournal::openFile()
+{
+    if (mapping)
+        return true;
+
+    // The journal is written by one process only: the tail lives in this
+    // object, so a second writer would overwrite its records
+    long long fileBytes = 0;
+#ifdef _WIN32
+    // No read or write sharing is the lock; delete sharing lets compaction
+    // rename the replacement into place while it is open
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_DELETE, nullptr,
+                             OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        DWORD error = GetLastError();
+        if (error == ERROR_SHARING_VIOLATION)
+            cerr << "Answer journal: " << path << " is in use by another session" << endl;
+        else
+            cerr << "Answer journal: cannot open " << path << " (error " << error << ")" << endl;
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(fileHandle, &size))
+        fileBytes = size.QuadPart;
+#else
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        cerr << "Answer journal: cannot open " << path << endl;
+        return false;
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0)
+    {
+        cerr << "Answer journal: " << path << " is in use by another session" << endl;
+        closeFile();
+        return false;
+    }
+    // A compaction in another process may have renamed a new journal over
+    // the one opened here between the open and the lock
+    struct stat info;
+    struct stat current;
+    if (fstat(fd, &info) != 0 || stat(path.c_str(), &current) != 0 || current.st_ino != info.st_ino ||
+        current.st_dev != info.st_dev)
+    {
+        cerr << "Answer journal: " << path << " is in use by another session" << endl;
+        closeFile();
+        return false;
+    }
+    fileBytes = info.st_size;
+#endif
+
+    // An existing journal keeps its own size
+    size_t recordCapacity = capacity;
+    if (fileBytes > static_cast<long long>(sizeof(Header)))
+    {
+        recordCapacity = max(recordCapacity, static_cast<size_t>(fileBytes - sizeof(Header)) / sizeof(JournalRecord));
+    }
+
+    if (!mapFile(recordCapacity))
+    {
+        closeFile();
+        return false;
+    }
+
+    static_assert(sizeof(Header) == 64, "journal header is 64 bytes");
+    Header *header = reinterpret_cast<Header *>(mapping);
+    if (memcmp(header->magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0 || header->version != JOURNAL_VERSION ||
+        header->recordSize != sizeof(JournalRecord))
+    {
+        // New file, or not a journal we can read: start empty
+        memset(mapping, 0, mappedBytes);
+        memcpy(header->magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+        header->version = JOURNAL_VERSION;
+        header->recordSize = sizeof(JournalRecord);
+    }
+    header->capacity = capacity;
+
+    // Records are only ever written in order, so the first invalid one (never
+    // written, or torn by a crash) ends the journal
+    JournalRecord *entries = records();
+    tail = 0;
+    nextSequence = 1;
+    while (tail < capacity && isValid(entries[tail]))
+    {
+        nextSequence = entries[tail].sequence + 1;
+        tail++;
+    }
+
+    syncedUpTo = 0;
+    flush(0, tail, true);
+    return true;
+}
+
+void AnswerJournal::closeFile()
+{
+    if (mapping)
+    {
+        flush(syncedUpTo, tail, true);
+    }
+    unmapFile();
+#ifdef _WIN32
+    if (fileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+bool AnswerJournal::mapFile(size_t recordCapacity)
+{
+    size_t bytes = sizeof(Header) + recordCapacity * sizeof(JournalRecord);
+#ifdef _WIN32
+    // A mapping larger than the file extends it with zeros
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READWRITE,
+                                       static_cast<DWORD>(static_cast<unsigned long long>(bytes) >> 32),
+                                       static_cast<DWORD>(bytes & 0xFFFFFFFFu), nullptr);
+    if (!mappingHandle)
+    {
+        cerr << "Answer journal: cannot map " << path << " (error " << GetLastError() << ")" << endl;
+        return false;
+    }
+    void *view = MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+    if (!view)
+    {
+        cerr << "Answer journal: cannot map " << path << " (error " << GetLastError() << ")" << endl;
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+        return false;
+    }
+#else
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (static_cast<size_t>(info.st_size) < bytes && ftruncate(fd, bytes) != 0))
+    {
+        cerr << "Answer journal: cannot size " << path << endl;
+        return false;
+    }
+    void *view = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED)
+    {
+        cerr << "Answer journal: cannot map " << path << endl;
+        return false;
+    }
+#endif
+    mapping = static_cast<unsigned char *>(view);
+    mappedBytes = bytes;
+    capacity = recordCapacity;
+    return true;
+}
+
+void AnswerJournal::unmapFile()
+{
+    if (!mapping)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(mapping);
+    CloseHandle(mappingHandle);
+    mappingHandle = nullptr;
+#else
+    munmap(mapping, mappedBytes);
+#endif
+    mapping = nullptr;
+    mappedBytes = 0;
+}
+
+void AnswerJournal::flush(size_t fromRecord, size_t toRecord, bool wait)
+{
+    size_t begin = fromRecord == 0 ? 0 : sizeof(Header) + fromRecord * sizeof(JournalRecord);
+    size_t end = sizeof(Header) + toRecord * sizeof(JournalRecord);
+    if (end > begin)
+    {
+#ifdef _WIN32
+        FlushViewOfFile(mapping + begin, end - begin);
+        if (wait)
+            FlushFileBuffers(fileHandle);
+#else
+        // msync wants a page-aligned start
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        begin -= begin % page;
+        msync(mapping + begin, end - begin, wait ? MS_SYNC : MS_ASYNC);
+#endif
+        stats.syncs++;
+    }
+    syncedUpTo = toRecord;
+    lastSync = chrono::steady_clock::now();
+}
+
+bool AnswerJournal::append(JournalRecord record)
+{
+    lock_guard<mutex> lock(journalMutex);
+    if (!mapping)
+        return false;
+    if (tail == capacity && !makeRoom())
+        return false;
+
+    record.sequence = nextSequence++;
+    record.reserved = 0;
+    record.checksum = checksumOf(record);
+    memcpy(&records()[tail], &record, sizeof(record));
+    tail++;
+    stats.appends++;
+
+    if (record.getEvent() == JournalEvent::SUBMIT)
+    {
+        flush(syncedUpTo, tail, true);
+    }
+    else if (tail - syncedUpTo >= SYNC_EVERY_RECORDS ||
+             chrono::steady_clock::now() - lastSync >= chrono::milliseconds(SYNC_INTERVAL_MS))
+    {
+        flush(syncedUpTo, tail, false);
+    }
+    return true;
+}
+
+// Rewrite the journal without finished attempts. The survivors go to a new
+// file that then replaces this one, so a crash part way through leaves
+// either the old journal or the new one, never a mix. The new file is
+// locked from creation and this object takes over its handles. On POSIX
+// the old file is only closed once the rename is done, so there is no moment
+// another process could lock the journal; Windows has to close it first.
+bool AnswerJournal::makeRoom()
+{
+    typedef tuple<int32_t, int32_t, int64_t> AttemptKey;
+    JournalRecord *entries = records();
+
+    vector<AttemptKey> finished;
+    for (size_t i = 0; i < tail; ++i)
+    {
+        if (entries[i].getEvent() == JournalEvent::SUBMIT)
+            finished.emplace_back(entries[i].userId, entries[i].examTemplateId, entries[i].startedAtMs);
+    }
+    sort(finished.begin(), finished.end());
+
+    vector<JournalRecord> live;
+    for (size_t i = 0; i < tail; ++i)
+    {
+        AttemptKey key(entries[i].userId, entries[i].examTemplateId, entries[i].startedAtMs);
+        if (!binary_search(finished.begin(), finished.end(), key))
+            live.push_back(entries[i]);
+    }
+
+    size_t newCapacity = capacity;
+    while (live.size() > newCapacity / 2)
+        newCapacity *= 2;
+
+    string tempPath = path + ".tmp";
+    remove(tempPath.c_str());
+    AnswerJournal compacted(tempPath, newCapacity);
+    if (!compacted.openFile())
+        return false;
+    memcpy(compacted.records(), live.data(), live.size() * sizeof(JournalRecord));
+    compacted.tail = live.size();
+    compacted.nextSequence = nextSequence;
+    compacted.flush(0, compacted.tail, true);
+
+#ifdef _WIN32
+    // Windows will not replace a file that is still open, so only here is
+    // the old journal briefly closed (and unlocked) before the rename
+    closeFile();
+    bool replaced = MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    // The old file stays open and locked until the new one is in its place
+    bool replaced = rename(tempPath.c_str(), path.c_str()) == 0;
+#endif
+    if (!replaced)
+    {
+        cerr << "Answer journal: cannot replace " << path << " after compaction" << endl;
+        compacted.closeFile();
+        remove(tempPath.c_str());
+#ifdef _WIN32
+        return openFile() && tail < capacity;
+#else
+        return tail < capacity;
+#endif
+    }
+#ifndef _WIN32
+    closeFile();
+#endif
+
+    // Take over the compacted file, still mapped and locked
+    mapping = compacted.mapping;
+    mappedBytes = compacted.mappedBytes;
+#ifdef _WIN32
+    fileHandle = compacted.fileHandle;
+    mappingHandle = compacted.mappingHandle;
+    compacted.fileHandle = INVALID_HANDLE_VALUE;
+    compacted.mappingHandle = nullptr;
+#else
+    fd = compacted.fd;
+    compacted.fd = -1;
+#endif
+    compacted.mapping = nullptr;
+    compacted.mappedBytes = 0;
+    capacity = compacted.capacity;
+    tail = compacted.tail;
+    syncedUpTo = compacted.syncedUpTo;
+    lastSync = compacted.lastSync;
+
+    stats.compactions++;
+    return tail < capacity;
+}
+
+vector<JournalRecord> AnswerJournal::unfinishedAttempt(int userId, int examTemplateId) const
+{
+    lock_guard<mutex> lock(journalMutex);
+    vector<JournalRecord> events;
+    if (!mapping)
+        return events;
+
+    const JournalRecord *entries = records();
+    size_t start = tail;
+    for (size_t i = tail; i-- > 0;)
+    {
+        if (entries[i].getEvent() == JournalEvent::START && entries[i].userId == userId &&
+            entries[i].examTemplateId == examTemplateId)
+        {
+            start = i;
+            break;
+        }
+    }
+    if (start == tail)
+        return events;
+
+    int64_t startedAtMs = entries[start].startedAtMs;
+    for (size_t i = start; i < tail; ++i)
+    {
+        const JournalRecord &entry = entries[i];
+        if (entry.userId != userId || entry.examTemplateId != examTemplateId || entry.startedAtMs != startedAtMs)
+            continue;
+        if (entry.getEvent() == JournalEvent::SUBMIT)
+            return vector<JournalRecord>();
+        events.push_back(entry);
+    }
+    return events;
+}
+
+void AnswerJournal::sync()
+{
+    lock_guard<mutex> lock(journalMutex);
+    if (mapping)
+        flush(syncedUpTo, tail, true);
+}
+
+JournalStats AnswerJournal::getStats() const
+{
+    lock_guard<mutex> lock(journalMutex);
+    JournalStats current = stats;
+    current.records = tail;
+    current.capacity = capacity;
+    return current;
+}
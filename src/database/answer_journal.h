@@ -0,0 +1,135 @@
+#ifndef ANSWER_JOURNAL_H
+#define ANSWER_JOURNAL_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+// What a journal record says happened to an exam session
+enum class JournalEvent : uint8_t {
+    NONE = 0,
+    START = 1,      // Attempt began (startedAtMs seeds its question and option order)
+    ANSWER = 2,     // slot picked at position
+    MOVE = 3,       // Navigated to position
+    MARK = 4,       // Review mark at position set (slot 1) or cleared (slot 0)
+    SUBMIT = 5      // Attempt finished and saved; nothing left to resume
+};
+
+// One fixed-size journal entry. An attempt is identified by (userId,
+// examTemplateId, startedAtMs). The checksum covers every byte before it, so
+// a record torn by a crash mid-write is recognised and ignored.
+struct JournalRecord {
+    int64_t startedAtMs;
+    int32_t userId;
+    int32_t examTemplateId;
+    uint16_t position;
+    uint8_t event;          // JournalEvent
+    int8_t slot;            // Answer slot for ANSWER, mark state for MARK, else -1
+    uint32_t sequence;      // Appends since the journal was created
+    uint32_t reserved;
+    uint32_t checksum;
+
+    JournalRecord() : startedAtMs(0), userId(0), examTemplateId(0), position(0),
+                      event(static_cast<uint8_t>(JournalEvent::NONE)), slot(-1),
+                      sequence(0), reserved(0), checksum(0) {}
+
+    JournalRecord(JournalEvent event, int userId, int examTemplateId, long long startedAtMs,
+                  size_t position, int slot = -1)
+        : startedAtMs(startedAtMs), userId(userId), examTemplateId(examTemplateId),
+          position(static_cast<uint16_t>(position)), event(static_cast<uint8_t>(event)),
+          slot(static_cast<int8_t>(slot)), sequence(0), reserved(0), checksum(0) {}
+
+    JournalEvent getEvent() const { return static_cast<JournalEvent>(event); }
+};
+
+struct JournalStats {
+    long long appends;
+    long long syncs;            // msync / FlushViewOfFile calls
+    long long compactions;
+    size_t records;             // In the file now
+    size_t capacity;
+
+    JournalStats() : appends(0), syncs(0), compactions(0), records(0), capacity(0) {}
+};
+
+// Append-only journal of exam session events in a memory-mapped file, so a
+// crash or a closed terminal mid-exam loses nothing. An append is a copy
+// into the mapping (no system call); the OS writes the pages back, and
+// dirty pages are pushed out every SYNC_EVERY_RECORDS appends or
+// SYNC_INTERVAL_MS. A SUBMIT is synced before append returns.
+//
+// When the file fills up it is rewritten without the records of finished
+// attempts, at double the size if the rest would still fill half of it.
+//
+// A journal file has one writer: open() takes an exclusive lock on it
+// (flock, or no sharing on Windows) and fails while another process holds
+// it, so each student gets a file of their own (DatabaseManager).
+class AnswerJournal {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;       // Records (32 KB)
+    static constexpr size_t SYNC_EVERY_RECORDS = 64;
+    static constexpr int SYNC_INTERVAL_MS = 1000;
+
+private:
+    struct Header;
+
+    string path;
+    size_t capacity;            // Records the mapping has room for
+    size_t tail;                // Next record to write
+    uint32_t nextSequence;
+    unsigned char* mapping;
+    size_t mappedBytes;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+
+    size_t syncedUpTo;          // Records before this index are already flushed
+    chrono::steady_clock::time_point lastSync;
+    JournalStats stats;
+    mutable mutex journalMutex;
+
+public:
+    explicit AnswerJournal(const string& journalPath, size_t capacity = DEFAULT_CAPACITY);
+    ~AnswerJournal();
+
+    AnswerJournal(const AnswerJournal&) = delete;
+    AnswerJournal& operator=(const AnswerJournal&) = delete;
+
+    // Map the file (created if missing) and find the end of the records
+    bool open();
+    void close();
+    bool isOpen() const { return mapping != nullptr; }
+
+    bool append(JournalRecord record);
+
+    // Every event of the newest unfinished attempt by userId at
+    // examTemplateId, START first; empty if there is none
+    vector<JournalRecord> unfinishedAttempt(int userId, int examTemplateId) const;
+
+    // Flush every record written so far to disk
+    void sync();
+
+    JournalStats getStats() const;
+
+private:
+    static uint32_t checksumOf(const JournalRecord& record);
+    static bool isValid(const JournalRecord& record);
+
+    JournalRecord* records() const;
+    bool openFile();
+    void closeFile();
+    bool mapFile(size_t recordCapacity);
+    void unmapFile();
+    void flush(size_t fromRecord, size_t toRecord, bool wait);
+    bool makeRoom();
+};
+
+#endif // ANSWER_JOURNAL_H
@@ -2,17 +2,204 @@
 #include "../features/exam_template.h"
 #include "../features/exam_creator.h"
 #include "../structure/utils.h"
+#include "../components/grading_kernel.h"
+#include "../components/queue.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <iomanip>
 #include <tuple>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
 using namespace std;
 
+// Column descriptors for every entity. Statements build their column lists
+// from these, so SQL order, decode order and bind order cannot drift apart.
+struct EntityColumns
+{
+    // login_attempts/is_locked are written by updateUser but not read back:
+    // lockout has never been enforced from stored state and database accounts
+    // have no unlock path yet
+    static constexpr auto user = makeRowMapper<User>(
+        "User",
+        column("id", &User::id), column("username", &User::username),
+        column("password", &User::password), column("email", &User::email),
+        column("full_name", &User::fullName), column("role", &User::role),
+        column("status", &User::status), column("created_at", &User::createdAtMs),
+        column("last_login", &User::lastLoginMs));
+
+    static constexpr auto userInsert = makeRowMapper<User>(
+        "User",
+        column("username", &User::username), column("password", &User::password),
+        column("email", &User::email), column("full_name", &User::fullName),
+        column("role", &User::role), column("status", &User::status),
+        column("created_at", &User::createdAtMs));
+
+    static constexpr auto userUpdate = makeRowMapper<User>(
+        "User",
+        column("username", &User::username), column("password", &User::password),
+        column("email", &User::email), column("full_name", &User::fullName),
+        column("role", &User::role), column("status", &User::status),
+        column("last_login", &User::lastLoginMs), column("login_attempts", &User::loginAttempts),
+        column("is_locked", &User::isLocked));
+
+    static constexpr auto question = makeRowMapper<Question>(
+        "Question",
+        column("id", &Question::id), column("subject", &Question::subject),
+        column("question_text", &Question::questionText),
+        column("option1", &Question::options, 0), column("option2", &Question::options, 1),
+        column("option3", &Question::options, 2), column("option4", &Question::options, 3),
+        column("correct_answer", &Question::correctAnswer), column("difficulty", &Question::difficulty),
+        column("explanation", &Question::explanation), column("created_by", &Question::createdBy),
+        column("created_at", &Question::createdAt), column("updated_at", &Question::updatedAt),
+        column("is_active", &Question::isActive));
+
+    // created_by is bound separately (NULL when unset)
+    static constexpr auto questionInsert = makeRowMapper<Question>(
+        "Question",
+        column("subject", &Question::subject), column("question_text", &Question::questionText),
+        column("option1", &Question::options, 0), column("option2", &Question::options, 1),
+        column("option3", &Question::options, 2), column("option4", &Question::options, 3),
+        column("correct_answer", &Question::correctAnswer), column("difficulty", &Question::difficulty),
+        column("explanation", &Question::explanation));
+
+    static constexpr auto questionUpdate = makeRowMapper<Question>(
+        "Question",
+        column("subject", &Question::subject), column("question_text", &Question::questionText),
+        column("option1", &Question::options, 0), column("option2", &Question::options, 1),
+        column("option3", &Question::options, 2), column("option4", &Question::options, 3),
+        column("correct_answer", &Question::correctAnswer), column("difficulty", &Question::difficulty),
+        column("explanation", &Question::explanation), column("is_active", &Question::isActive));
+
+    static constexpr auto examResult = makeRowMapper<ExamResult>(
+        "ExamResult",
+        column("id", &ExamResult::id), column("user_id", &ExamResult::userId),
+        column("username", &ExamResult::username), column("exam_template_id", &ExamResult::examTemplateId),
+        column("score", &ExamResult::score), column("total_questions", &ExamResult::totalQuestions),
+        column("percentage", &ExamResult::percentage), column("exam_date", &ExamResult::examDateMs),
+        column("start_time", &ExamResult::startTimeMs), column("end_time", &ExamResult::endTimeMs),
+        column("duration", &ExamResult::duration), column("subject", &ExamResult::subject),
+        column("exam_type", &ExamResult::examType), column("exam_name", &ExamResult::templateName),
+        column("negative_marking", &ExamResult::negativeMarking),
+        column("negative_marks", &ExamResult::negativeMarks));
+
+    static constexpr auto examResultInsert = makeRowMapper<ExamResult>(
+        "ExamResult",
+        column("user_id", &ExamResult::userId), column("username", &ExamResult::username),
+        column("exam_template_id", &ExamResult::examTemplateId), column("score", &ExamResult::score),
+        column("total_questions", &ExamResult::totalQuestions), column("percentage", &ExamResult::percentage),
+        column("exam_date", &ExamResult::examDateMs), column("start_time", &ExamResult::startTimeMs),
+        column("end_time", &ExamResult::endTimeMs), column("duration", &ExamResult::duration),
+        column("subject", &ExamResult::subject), column("exam_type", &ExamResult::examType),
+        column("exam_name", &ExamResult::templateName), column("negative_marking", &ExamResult::negativeMarking),
+        column("negative_marks", &ExamResult::negativeMarks));
+
+    static constexpr auto examTemplate = makeRowMapper<ExamTemplate>(
+        "ExamTemplate",
+        column("id", &ExamTemplate::id), column("template_name", &ExamTemplate::templateName),
+        column("exam_type", &ExamTemplate::examType), column("subject", &ExamTemplate::subject),
+        column("question_count", &ExamTemplate::questionCount), column("time_limit", &ExamTemplate::timeLimit),
+        column("difficulty", &ExamTemplate::difficulty),
+        column("passing_percentage", &ExamTemplate::passingPercentage),
+        column("negative_marking", &ExamTemplate::negativeMarking),
+        column("negative_mark_value", &ExamTemplate::negativeMarkValue),
+        column("skip_penalty", &ExamTemplate::skipPenalty),
+        column("shuffle_questions", &ExamTemplate::shuffleQuestions),
+        column("shuffle_options", &ExamTemplate::shuffleOptions),
+        column("allow_review", &ExamTemplate::allowReview), column("auto_submit", &ExamTemplate::autoSubmit),
+        column("instructions", &ExamTemplate::instructions), column("created_by", &ExamTemplate::createdBy),
+        column("created_at", &ExamTemplate::createdAt), column("updated_at", &ExamTemplate::updatedAt),
+        column("is_active", &ExamTemplate::isActive));
+
+    static constexpr auto examTemplateInsert = makeRowMapper<ExamTemplate>(
+        "ExamTemplate",
+        column("template_name", &ExamTemplate::templateName), column("exam_type", &ExamTemplate::examType),
+        column("subject", &ExamTemplate::subject), column("question_count", &ExamTemplate::questionCount),
+        column("time_limit", &ExamTemplate::timeLimit), column("difficulty", &ExamTemplate::difficulty),
+        column("passing_percentage", &ExamTemplate::passingPercentage),
+        column("negative_marking", &ExamTemplate::negativeMarking),
+        column("negative_mark_value", &ExamTemplate::negativeMarkValue),
+        column("skip_penalty", &ExamTemplate::skipPenalty),
+        column("shuffle_questions", &ExamTemplate::shuffleQuestions),
+        column("shuffle_options", &ExamTemplate::shuffleOptions),
+        column("allow_review", &ExamTemplate::allowReview), column("auto_submit", &ExamTemplate::autoSubmit),
+        column("instructions", &ExamTemplate::instructions), column("created_by", &ExamTemplate::createdBy),
+        column("is_active", &ExamTemplate::isActive));
+
+    static constexpr auto examTemplateUpdate = makeRowMapper<ExamTemplate>(
+        "ExamTemplate",
+        column("template_name", &ExamTemplate::templateName), column("exam_type", &ExamTemplate::examType),
+        column("subject", &ExamTemplate::subject), column("question_count", &ExamTemplate::questionCount),
+        column("time_limit", &ExamTemplate::timeLimit), column("difficulty", &ExamTemplate::difficulty),
+        column("passing_percentage", &ExamTemplate::passingPercentage),
+        column("negative_marking", &ExamTemplate::negativeMarking),
+        column("negative_mark_value", &ExamTemplate::negativeMarkValue),
+        column("skip_penalty", &ExamTemplate::skipPenalty),
+        column("shuffle_questions", &ExamTemplate::shuffleQuestions),
+        column("shuffle_options", &ExamTemplate::shuffleOptions),
+        column("allow_review", &ExamTemplate::allowReview), column("auto_submit", &ExamTemplate::autoSubmit),
+        column("instructions", &ExamTemplate::instructions));
+
+    static constexpr auto examQuestion = makeRowMapper<ExamQuestion>(
+        "ExamQuestion",
+        column("id", &ExamQuestion::id), column("exam_template_id", &ExamQuestion::examTemplateId),
+        column("question_number", &ExamQuestion::questionNumber),
+        column("question_text", &ExamQuestion::questionText),
+        column("option1", &ExamQuestion::options, 0), column("option2", &ExamQuestion::options, 1),
+        column("option3", &ExamQuestion::options, 2), column("option4", &ExamQuestion::options, 3),
+        column("correct_answer", &ExamQuestion::correctAnswer),
+        column("explanation", &ExamQuestion::explanation));
+
+    // What a student sitting the exam needs, decoded straight into the
+    // Question a session displays; explanations load after grading
+    static constexpr auto paperQuestion = makeRowMapper<Question>(
+        "PaperQuestion",
+        column("id", &Question::id), column("question_text", &Question::questionText),
+        column("option1", &Question::options, 0), column("option2", &Question::options, 1),
+        column("option3", &Question::options, 2), column("option4", &Question::options, 3),
+        column("correct_answer", &Question::correctAnswer));
+
+    static constexpr auto questionHeader = makeRowMapper<QuestionHeader>(
+        "QuestionHeader",
+        column("id", &QuestionHeader::id), column("question_number", &QuestionHeader::questionNumber),
+        column("question_text", &QuestionHeader::questionText));
+
+    static constexpr auto resultSummary = makeRowMapper<ResultSummary>(
+        "ResultSummary",
+        column("id", &ResultSummary::id), column("exam_date", &ResultSummary::examDateMs),
+        column("subject", &ResultSummary::subject), column("score", &ResultSummary::score),
+        column("total_questions", &ResultSummary::totalQuestions),
+        column("percentage", &ResultSummary::percentage));
+
+    static constexpr auto examQuestionInsert = makeRowMapper<ExamQuestion>(
+        "ExamQuestion",
+        column("exam_template_id", &ExamQuestion::examTemplateId),
+        column("question_number", &ExamQuestion::questionNumber),
+        column("question_text", &ExamQuestion::questionText),
+        column("option1", &ExamQuestion::options, 0), column("option2", &ExamQuestion::options, 1),
+        column("option3", &ExamQuestion::options, 2), column("option4", &ExamQuestion::options, 3),
+        column("correct_answer", &ExamQuestion::correctAnswer),
+        column("explanation", &ExamQuestion::explanation));
+
+    static constexpr auto examQuestionUpdate = makeRowMapper<ExamQuestion>(
+        "ExamQuestion",
+        column("question_number", &ExamQuestion::questionNumber),
+        column("question_text", &ExamQuestion::questionText),
+        column("option1", &ExamQuestion::options, 0), column("option2", &ExamQuestion::options, 1),
+        column("option3", &ExamQuestion::options, 2), column("option4", &ExamQuestion::options, 3),
+        column("correct_answer", &ExamQuestion::correctAnswer),
+        column("explanation", &ExamQuestion::explanation));
+};
+
 // DatabaseManager implementation
 DatabaseManager::DatabaseManager(const string &databasePath)
-    : db(nullptr), dbPath(databasePath), isConnected(false), lastInsertedExamTemplateId(0)
+    : db(nullptr), dbPath(databasePath), isConnected(false), lastInsertedExamTemplateId(0), userSearchIndexed(false),
+      answerJournalUserId(0),
+      backoffRng(random_device{}()), catalogLoads(0), catalogHits(0), catalogInvalidations(0),
+      paperLoads(0), paperHits(0), paperInvalidations(0), dataVersionStmt(nullptr), nextVersionCheckMs(0),
+      seenDataVersion(-1), seenCatalogVersion(-1)
 {
     connectionPool.resize(MAX_CONNECTIONS, nullptr);
     connectionInUse.resize(MAX_CONNECTIONS, false);
@@ -56,17 +243,41 @@ bool DatabaseManager::connect()
 
     isConnected = true;
 
+    // Let SQLite absorb short lock waits; longer contention goes through stepWithRetry
+    sqlite3_busy_timeout(db, BUSY_TIMEOUT_MS);
+
     // Enable foreign keys
     executeSQL("PRAGMA foreign_keys = ON;");
 
     // Set journal mode to WAL for better performance
     executeSQL("PRAGMA journal_mode = WAL;");
 
+    // Checkpoint in the background so no insert pays for a synchronous checkpoint
+    walCheckpointer = make_unique<WalCheckpointer>(dbPath);
+    if (!walCheckpointer->start(db))
+    {
+        walCheckpointer.reset();
+    }
+
     return true;
 }
 
 void DatabaseManager::disconnect()
 {
+    if (walCheckpointer)
+    {
+        walCheckpointer->stop();
+        walCheckpointer.reset();
+    }
+
+    answerJournal.reset();
+
+    {
+        lock_guard<mutex> lock(versionMutex);
+        sqlite3_finalize(dataVersionStmt);
+        dataVersionStmt = nullptr;
+    }
+
     if (db)
     {
         sqlite3_close(db);
@@ -75,6 +286,48 @@ void DatabaseManager::disconnect()
     }
 }
 
+CheckpointStats DatabaseManager::getCheckpointStats() const
+{
+    return walCheckpointer ? walCheckpointer->getStats() : CheckpointStats();
+}
+
+AnswerJournal *DatabaseManager::getAnswerJournal(int userId)
+{
+    if (answerJournal && answerJournalUserId == userId)
+        return answerJournal.get();
+
+    // One file per student, so terminals of different students never share
+    // one; the same student in a second terminal goes without
+    answerJournal = make_unique<AnswerJournal>(dbPath + "-answers-" + to_string(userId));
+    answerJournalUserId = userId;
+    if (!answerJournal->open())
+    {
+        answerJournal.reset();
+    }
+    return answerJournal.get();
+}
+
+JournalStats DatabaseManager::getJournalStats() const
+{
+    return answerJournal ? answerJournal->getStats() : JournalStats();
+}
+
+vector<StatementContention> DatabaseManager::getContentionStats() const
+{
+    vector<StatementContention> stats = contentionStats.getAllValues();
+    sort(stats.begin(), stats.end(), [](const StatementContention &a, const StatementContention &b)
+         { return a.busyHits > b.busyHits; });
+    return stats;
+}
+
+vector<DecodeStats> DatabaseManager::getDecodeStats() const
+{
+    vector<DecodeStats> stats = decodeStats.getAllValues();
+    sort(stats.begin(), stats.end(), [](const DecodeStats &a, const DecodeStats &b)
+         { return a.rows > b.rows; });
+    return stats;
+}
+
 bool DatabaseManager::initializeDatabase()
 {
     if (!connect())
@@ -82,15 +335,18 @@ bool DatabaseManager::initializeDatabase()
         return false;
     }
 
-    return createTables() && insertDefaultData();
+    return createTables() && updateSchema() && insertDefaultData();
 }
 
-bool DatabaseManager::createTables()
+// Timestamps on users and exam_results are INTEGER epoch milliseconds so date
+// ranges compare as integers and use idx_exam_results_date. Subject,
+// difficulty and exam type are integer codes (structure/codes.h). The DDL is
+// shared with updateSchema(), which rebuilds legacy tables under a new name.
+#define EPOCH_MS_NOW "(CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER))"
+
+static string usersTableSql(const string &name)
 {
-    vector<string> createTableQueries = {
-        // Users table
-        R"(
-        CREATE TABLE IF NOT EXISTS users (
+    return "CREATE TABLE IF NOT EXISTS " + name + R"( (
             id INTEGER PRIMARY KEY AUTOINCREMENT,
             username TEXT UNIQUE NOT NULL,
             password TEXT NOT NULL,
@@ -98,27 +354,55 @@ bool DatabaseManager::createTables()
             full_name TEXT NOT NULL,
             role INTEGER NOT NULL DEFAULT 2,
             status INTEGER NOT NULL DEFAULT 1,
-            created_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP,
-            last_login TEXT,
+            created_at INTEGER NOT NULL DEFAULT )" EPOCH_MS_NOW R"(,
+            last_login INTEGER,
             login_attempts INTEGER DEFAULT 0,
             is_locked BOOLEAN DEFAULT 0,
-            updated_at TEXT DEFAULT CURRENT_TIMESTAMP
-        );
-        )",
+            updated_at INTEGER DEFAULT )" EPOCH_MS_NOW R"(
+        );)";
+}
 
-        // Exam templates table - teachers create exams directly
-        R"(
-        CREATE TABLE IF NOT EXISTS exam_templates (
+static string examResultsTableSql(const string &name)
+{
+    return "CREATE TABLE IF NOT EXISTS " + name + R"( (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            user_id INTEGER NOT NULL,
+            username TEXT NOT NULL,
+            exam_template_id INTEGER NOT NULL,
+            score INTEGER NOT NULL,
+            total_questions INTEGER NOT NULL,
+            percentage REAL NOT NULL,
+            exam_date INTEGER NOT NULL DEFAULT )" EPOCH_MS_NOW R"(,
+            start_time INTEGER,
+            end_time INTEGER,
+            duration INTEGER,
+            time_limit INTEGER,
+            subject INTEGER,
+            exam_type INTEGER,
+            exam_name TEXT,
+            is_passed BOOLEAN DEFAULT 0,
+            grade TEXT,
+            negative_marking BOOLEAN DEFAULT 0,
+            negative_marks REAL DEFAULT 0,
+            FOREIGN KEY(user_id) REFERENCES users(id) ON DELETE CASCADE,
+            FOREIGN KEY(exam_template_id) REFERENCES exam_templates(id) ON DELETE CASCADE
+        );)";
+}
+
+static string examTemplatesTableSql(const string &name)
+{
+    return "CREATE TABLE IF NOT EXISTS " + name + R"( (
             id INTEGER PRIMARY KEY AUTOINCREMENT,
             template_name TEXT UNIQUE NOT NULL,
-            exam_type TEXT NOT NULL CHECK(exam_type IN ('QUIZ', 'WORKSHEET', 'FINAL')),
-            subject TEXT NOT NULL CHECK(subject IN ('DSA', 'OOP', 'COA', 'SAM', 'Mathematics')),
+            exam_type INTEGER NOT NULL CHECK(exam_type BETWEEN 1 AND 3),
+            subject INTEGER NOT NULL CHECK(subject BETWEEN 1 AND 5),
             question_count INTEGER NOT NULL DEFAULT 10 CHECK(question_count > 0),
             time_limit INTEGER NOT NULL CHECK(time_limit > 0),
-            difficulty TEXT DEFAULT 'Medium' CHECK(difficulty IN ('Easy', 'Medium', 'Hard', 'Mixed')),
+            difficulty INTEGER DEFAULT 2 CHECK(difficulty BETWEEN 1 AND 4),
             passing_percentage REAL DEFAULT 60.0,
             negative_marking BOOLEAN DEFAULT 0,
             negative_mark_value REAL DEFAULT 0.25,
+            skip_penalty REAL DEFAULT 0,
             shuffle_questions BOOLEAN DEFAULT 1,
             shuffle_options BOOLEAN DEFAULT 0,
             allow_review BOOLEAN DEFAULT 1,
@@ -129,75 +413,79 @@ bool DatabaseManager::createTables()
             updated_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP,
             is_active BOOLEAN DEFAULT 1,
             FOREIGN KEY(created_by) REFERENCES users(id) ON DELETE CASCADE
-        );
-        )",
+        );)";
+}
 
-        // Exam questions table - questions belong directly to specific exams
-        R"(
-        CREATE TABLE IF NOT EXISTS exam_questions (
+static string questionsTableSql(const string &name)
+{
+    return "CREATE TABLE IF NOT EXISTS " + name + R"( (
             id INTEGER PRIMARY KEY AUTOINCREMENT,
-            exam_template_id INTEGER NOT NULL,
-            question_number INTEGER NOT NULL,
+            subject INTEGER NOT NULL CHECK(subject BETWEEN 1 AND 5),
             question_text TEXT NOT NULL,
             option1 TEXT NOT NULL,
             option2 TEXT NOT NULL,
             option3 TEXT NOT NULL,
             option4 TEXT NOT NULL,
             correct_answer INTEGER NOT NULL CHECK(correct_answer >= 0 AND correct_answer <= 3),
+            difficulty INTEGER NOT NULL CHECK(difficulty BETWEEN 1 AND 3),
             explanation TEXT,
+            created_by INTEGER NOT NULL,
             created_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP,
-            FOREIGN KEY(exam_template_id) REFERENCES exam_templates(id) ON DELETE CASCADE,
-            UNIQUE(exam_template_id, question_number)
-        );
-        )",
+            updated_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP,
+            is_active BOOLEAN DEFAULT 1,
+            FOREIGN KEY(created_by) REFERENCES users(id) ON DELETE CASCADE
+        );)";
+}
 
-        // General questions table - question bank for reuse across exams
+// "CASE column WHEN 'name' THEN code ... END" for converting legacy text
+// columns; names outside the table become NULL
+template <typename Enum, size_t N>
+static string codeFromNameSql(const CodeTable<Enum, N> &table, const string &column)
+{
+    string sql = "CASE " + column;
+    for (const auto &entry : table)
+    {
+        if (entry.code != Enum::NONE)
+        {
+            sql += " WHEN '" + string(entry.name) + "' THEN " + to_string(static_cast<int>(entry.code));
+        }
+    }
+    return sql + " END";
+}
+
+bool DatabaseManager::createTables()
+{
+    vector<string> createTableQueries = {
+        // Users table
+        usersTableSql("users"),
+
+        // Exam templates table - teachers create exams directly
+        examTemplatesTableSql("exam_templates"),
+
+        // Exam questions table - questions belong directly to specific exams
         R"(
-        CREATE TABLE IF NOT EXISTS questions (
+        CREATE TABLE IF NOT EXISTS exam_questions (
             id INTEGER PRIMARY KEY AUTOINCREMENT,
-            subject TEXT NOT NULL CHECK(subject IN ('DSA', 'OOP', 'COA', 'SAM', 'Mathematics')),
+            exam_template_id INTEGER NOT NULL,
+            question_number INTEGER NOT NULL,
             question_text TEXT NOT NULL,
             option1 TEXT NOT NULL,
             option2 TEXT NOT NULL,
             option3 TEXT NOT NULL,
             option4 TEXT NOT NULL,
             correct_answer INTEGER NOT NULL CHECK(correct_answer >= 0 AND correct_answer <= 3),
-            difficulty TEXT NOT NULL CHECK(difficulty IN ('Easy', 'Medium', 'Hard')),
             explanation TEXT,
-            created_by INTEGER NOT NULL,
             created_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP,
-            updated_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP,
-            is_active BOOLEAN DEFAULT 1,
-            FOREIGN KEY(created_by) REFERENCES users(id) ON DELETE CASCADE
+            FOREIGN KEY(exam_template_id) REFERENCES exam_templates(id) ON DELETE CASCADE,
+            UNIQUE(exam_template_id, question_number)
         );
         )",
 
+        // General questions table - question bank for reuse across exams
+        questionsTableSql("questions"),
+
         // Exam results table
-        R"(
-        CREATE TABLE IF NOT EXISTS exam_results (
-            id INTEGER PRIMARY KEY AUTOINCREMENT,
-            user_id INTEGER NOT NULL,
-            username TEXT NOT NULL,
-            exam_template_id INTEGER NOT NULL,
-            score INTEGER NOT NULL,
-            total_questions INTEGER NOT NULL,
-            percentage REAL NOT NULL,
-            exam_date TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP,
-            start_time TEXT,
-            end_time TEXT,
-            duration INTEGER,
-            time_limit INTEGER,
-            subject TEXT,
-            exam_type TEXT,
-            exam_name TEXT,
-            is_passed BOOLEAN DEFAULT 0,
-            grade TEXT,
-            negative_marking BOOLEAN DEFAULT 0,
-            negative_marks REAL DEFAULT 0,
-            FOREIGN KEY(user_id) REFERENCES users(id) ON DELETE CASCADE,
-            FOREIGN KEY(exam_template_id) REFERENCES exam_templates(id) ON DELETE CASCADE
-        );
-        )",
+        examResultsTableSql("exam_results"),
 
         // Detailed exam answers for analysis
         R"(
@@ -247,7 +535,17 @@ bool DatabaseManager::createTables()
             created_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP,
             updated_at TEXT NOT NULL DEFAULT CURRENT_TIMESTAMP
         );
-        )"};
+        )",
+
+        // Bumped by triggers on every template or question change, so other
+        // processes can tell their cached catalog and papers are stale
+        R"(
+        CREATE TABLE IF NOT EXISTS exam_catalog_version (
+            id INTEGER PRIMARY KEY CHECK(id = 1),
+            version INTEGER NOT NULL DEFAULT 0
+        );
+        )",
+        "INSERT OR IGNORE INTO exam_catalog_version (id, version) VALUES (1, 0);"};
 
     for (const auto &query : createTableQueries)
     {
@@ -257,10 +555,30 @@ bool DatabaseManager::createTables()
         }
     }
 
+    // Trigram index over the searchable user fields (see searchUsers).
+    // External content: it stores only the index; the triggers below keep it
+    // in step with users. Optional: FTS5 and its trigram tokenizer (SQLite
+    // 3.34+) are not in every SQLite build, and the probe fails on an index
+    // made by one that had them, too.
+    userSearchIndexed =
+        sqlite3_exec(db, R"(
+        CREATE VIRTUAL TABLE IF NOT EXISTS users_search USING fts5(
+            username, full_name, email,
+            content='users', content_rowid='id', tokenize='trigram'
+        );
+        )", nullptr, nullptr, nullptr) == SQLITE_OK &&
+        sqlite3_exec(db, "SELECT rowid FROM users_search LIMIT 0;", nullptr, nullptr, nullptr) == SQLITE_OK;
+    if (!userSearchIndexed)
+    {
+        cerr << "Note: this SQLite has no FTS5 trigram tokenizer; user search scans the users table." << endl;
+    }
+
     // Create indexes for better performance
     vector<string> indexQueries = {
         "CREATE INDEX IF NOT EXISTS idx_users_username ON users(username);",
         "CREATE INDEX IF NOT EXISTS idx_users_email ON users(email);",
+        "CREATE INDEX IF NOT EXISTS idx_users_username_nocase ON users(username COLLATE NOCASE);",
+        "CREATE INDEX IF NOT EXISTS idx_users_email_nocase ON users(email COLLATE NOCASE);",
         "CREATE INDEX IF NOT EXISTS idx_users_role ON users(role);",
         "CREATE INDEX IF NOT EXISTS idx_exam_templates_type ON exam_templates(exam_type);",
         "CREATE INDEX IF NOT EXISTS idx_exam_templates_subject ON exam_templates(subject);",
@@ -268,9 +586,13 @@ bool DatabaseManager::createTables()
         "CREATE INDEX IF NOT EXISTS idx_exam_templates_active ON exam_templates(is_active);",
         "CREATE INDEX IF NOT EXISTS idx_exam_questions_template_id ON exam_questions(exam_template_id);",
         "CREATE INDEX IF NOT EXISTS idx_exam_questions_number ON exam_questions(question_number);",
+        "CREATE INDEX IF NOT EXISTS idx_questions_subject ON questions(subject, difficulty);",
+        "CREATE INDEX IF NOT EXISTS idx_questions_difficulty ON questions(difficulty);",
         "CREATE INDEX IF NOT EXISTS idx_exam_results_user_id ON exam_results(user_id);",
         "CREATE INDEX IF NOT EXISTS idx_exam_results_date ON exam_results(exam_date);",
+        "CREATE INDEX IF NOT EXISTS idx_exam_results_user_date ON exam_results(user_id, exam_date);",
         "CREATE INDEX IF NOT EXISTS idx_exam_results_template_id ON exam_results(exam_template_id);",
+        "CREATE INDEX IF NOT EXISTS idx_exam_results_subject ON exam_results(subject);",
         "CREATE INDEX IF NOT EXISTS idx_exam_answers_result_id ON exam_answers(result_id);",
         "CREATE INDEX IF NOT EXISTS idx_exam_answers_question_id ON exam_answers(question_id);",
         "CREATE INDEX IF NOT EXISTS idx_sessions_user_id ON user_sessions(user_id);"};
@@ -280,16 +602,265 @@ bool DatabaseManager::createTables()
         executeSQL(query);
     }
 
+    // Only changes to indexed columns touch users_search (logins do not).
+    // Without the index its triggers would make every users write fail.
+    vector<string> userSearchTriggers = {
+        R"(
+        CREATE TRIGGER IF NOT EXISTS users_search_insert AFTER INSERT ON users BEGIN
+            INSERT INTO users_search(rowid, username, full_name, email)
+            VALUES (new.id, new.username, new.full_name, new.email);
+        END;
+        )",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS users_search_delete AFTER DELETE ON users BEGIN
+            INSERT INTO users_search(users_search, rowid, username, full_name, email)
+            VALUES ('delete', old.id, old.username, old.full_name, old.email);
+        END;
+        )",
+        R"(
+        CREATE TRIGGER IF NOT EXISTS users_search_update AFTER UPDATE OF username, full_name, email ON users BEGIN
+            INSERT INTO users_search(users_search, rowid, username, full_name, email)
+            VALUES ('delete', old.id, old.username, old.full_name, old.email);
+            INSERT INTO users_search(rowid, username, full_name, email)
+            VALUES (new.id, new.username, new.full_name, new.email);
+        END;
+        )"};
+    bool userSearchTriggered = false;
+    sqlite3_stmt *triggerCheck =
+        prepareStatement("SELECT 1 FROM sqlite_master WHERE type = 'trigger' AND name = 'users_search_insert';");
+    if (triggerCheck)
+    {
+        userSearchTriggered = stepWithRetry(triggerCheck, "createTables") == SQLITE_ROW;
+        finalizeStatement(triggerCheck);
+    }
+
+    if (!userSearchIndexed)
+    {
+        for (const char *event : {"insert", "delete", "update"})
+        {
+            executeSQL(string("DROP TRIGGER IF EXISTS users_search_") + event + ";");
+        }
+    }
+    else
+    {
+        for (const auto &query : userSearchTriggers)
+        {
+            if (!executeSQL(query))
+            {
+                return false;
+            }
+        }
+        // Users written while the index was not kept up (or before it existed)
+        if (!userSearchTriggered && !executeSQL("INSERT INTO users_search(users_search) VALUES('rebuild');"))
+        {
+            return false;
+        }
+    }
+
+    // Any change to exam_templates or exam_questions, including foreign key
+    // cascades, moves exam_catalog_version on
+    vector<string> triggerQueries;
+    for (const char *table : {"exam_templates", "exam_questions"})
+    {
+        for (const char *event : {"insert", "update", "delete"})
+        {
+            string upper = event;
+            transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+            triggerQueries.push_back(string("CREATE TRIGGER IF NOT EXISTS ") + table + "_version_" + event +
+                                     " AFTER " + upper + " ON " + table +
+                                     " BEGIN UPDATE exam_catalog_version SET version = version + 1; END;");
+        }
+    }
+
+    for (const auto &query : triggerQueries)
+    {
+        if (!executeSQL(query))
+        {
+            return false;
+        }
+    }
+
     return true;
 }
 
+bool DatabaseManager::updateSchema()
+{
+    // PRAGMA user_version records the last migration applied:
+    //   1 - users/exam_results timestamps are epoch milliseconds
+    //   2 - subject, difficulty and exam_type are integer codes
+    //   3 - users_search trigram index is populated
+    //   4 - exam_templates.skip_penalty
+    //   5 - exam_results.negative_marking is filled in for older results
+    const int currentVersion = 5;
+
+    sqlite3_stmt *stmt = prepareStatement("PRAGMA user_version;");
+    int version = 0;
+    if (stmt && stepWithRetry(stmt, "updateSchema") == SQLITE_ROW)
+    {
+        version = sqlite3_column_int(stmt, 0);
+    }
+    finalizeStatement(stmt);
+
+    if (version >= currentVersion)
+    {
+        return true;
+    }
+
+    auto declaredType = [this](const char *table, const char *column)
+    {
+        string type;
+        sqlite3_stmt *info = prepareStatement("SELECT type FROM pragma_table_info(?) WHERE name = ?;");
+        if (info)
+        {
+            sqlite3_bind_text(info, 1, table, -1, SQLITE_STATIC);
+            sqlite3_bind_text(info, 2, column, -1, SQLITE_STATIC);
+            if (stepWithRetry(info, "updateSchema") == SQLITE_ROW)
+            {
+                type = reinterpret_cast<const char *>(sqlite3_column_text(info, 0));
+            }
+            finalizeStatement(info);
+        }
+        return type;
+    };
+
+    bool migrated = false;
+
+    // Legacy values were written from Utils::getCurrentDateTime() in local
+    // time, hence the 'utc' modifier; users.updated_at only ever held the
+    // CURRENT_TIMESTAMP default, which is already UTC.
+    if (version < 1 && (declaredType("users", "created_at") == "TEXT" ||
+                        declaredType("exam_results", "exam_date") == "TEXT"))
+    {
+        vector<string> steps = {
+            usersTableSql("users_migrated"),
+            R"(INSERT INTO users_migrated (id, username, password, email, full_name, role, status,
+                   created_at, last_login, login_attempts, is_locked, updated_at)
+               SELECT id, username, password, email, full_name, role, status,
+                   COALESCE(CAST(strftime('%s', created_at, 'utc') AS INTEGER) * 1000, 0),
+                   CAST(strftime('%s', last_login, 'utc') AS INTEGER) * 1000,
+                   login_attempts, is_locked,
+                   CAST(strftime('%s', updated_at) AS INTEGER) * 1000
+               FROM users;)",
+            examResultsTableSql("exam_results_migrated"),
+            R"(INSERT INTO exam_results_migrated (id, user_id, username, exam_template_id, score, total_questions,
+                   percentage, exam_date, start_time, end_time, duration, time_limit, subject, exam_type,
+                   exam_name, is_passed, grade, negative_marking, negative_marks)
+               SELECT id, user_id, username, exam_template_id, score, total_questions, percentage,
+                   COALESCE(CAST(strftime('%s', exam_date, 'utc') AS INTEGER) * 1000, 0),
+                   CAST(strftime('%s', start_time, 'utc') AS INTEGER) * 1000,
+                   CAST(strftime('%s', end_time, 'utc') AS INTEGER) * 1000,
+                   duration, time_limit, subject, exam_type, exam_name, is_passed, grade,
+                   negative_marking, negative_marks
+               FROM exam_results;)",
+            "DROP TABLE exam_results;",
+            "DROP TABLE users;",
+            "ALTER TABLE users_migrated RENAME TO users;",
+            "ALTER TABLE exam_results_migrated RENAME TO exam_results;",
+            "PRAGMA user_version = 1;"};
+
+        if (!runMigration("timestamps", steps))
+        {
+            return false;
+        }
+        migrated = true;
+    }
+
+    // Text names become codes through the same tables the entities use
+    if (version < 2 && declaredType("exam_templates", "subject") == "TEXT")
+    {
+        vector<string> steps = {
+            examTemplatesTableSql("exam_templates_migrated"),
+            "INSERT INTO exam_templates_migrated (id, template_name, exam_type, subject, question_count, time_limit,"
+            " difficulty, passing_percentage, negative_marking, negative_mark_value, shuffle_questions,"
+            " shuffle_options, allow_review, auto_submit, instructions, created_by, created_at, updated_at, is_active)"
+            " SELECT id, template_name, " + codeFromNameSql(EXAM_TYPE_CODES, "exam_type") + ", " +
+                codeFromNameSql(SUBJECT_CODES, "subject") + ", question_count, time_limit, " +
+                codeFromNameSql(DIFFICULTY_CODES, "difficulty") + ", passing_percentage, negative_marking,"
+            " negative_mark_value, shuffle_questions, shuffle_options, allow_review, auto_submit, instructions,"
+            " created_by, created_at, updated_at, is_active FROM exam_templates;",
+            questionsTableSql("questions_migrated"),
+            "INSERT INTO questions_migrated (id, subject, question_text, option1, option2, option3, option4,"
+            " correct_answer, difficulty, explanation, created_by, created_at, updated_at, is_active)"
+            " SELECT id, " + codeFromNameSql(SUBJECT_CODES, "subject") + ", question_text, option1, option2,"
+            " option3, option4, correct_answer, " + codeFromNameSql(DIFFICULTY_CODES, "difficulty") + ","
+            " explanation, created_by, created_at, updated_at, is_active FROM questions;",
+            examResultsTableSql("exam_results_migrated"),
+            "INSERT INTO exam_results_migrated (id, user_id, username, exam_template_id, score, total_questions,"
+            " percentage, exam_date, start_time, end_time, duration, time_limit, subject, exam_type, exam_name,"
+            " is_passed, grade, negative_marking, negative_marks)"
+            " SELECT id, user_id, username, exam_template_id, score, total_questions, percentage, exam_date,"
+            " start_time, end_time, duration, time_limit, " + codeFromNameSql(SUBJECT_CODES, "subject") + ", " +
+                codeFromNameSql(EXAM_TYPE_CODES, "exam_type") + ", exam_name, is_passed, grade,"
+            " negative_marking, negative_marks FROM exam_results;",
+            "DROP TABLE exam_results;",
+            "DROP TABLE questions;",
+            "DROP TABLE exam_templates;",
+            "ALTER TABLE exam_templates_migrated RENAME TO exam_templates;",
+            "ALTER TABLE questions_migrated RENAME TO questions;",
+            "ALTER TABLE exam_results_migrated RENAME TO exam_results;",
+            "PRAGMA user_version = 2;"};
+
+        if (!runMigration("enum codes", steps))
+        {
+            return false;
+        }
+        migrated = true;
+    }
+
+    // A new column with a default needs no rebuild
+    if (version < 4 && declaredType("exam_templates", "skip_penalty").empty() &&
+        !executeSQL("ALTER TABLE exam_templates ADD COLUMN skip_penalty REAL DEFAULT 0;"))
+    {
+        return false;
+    }
+
+    // Results were saved without their negative_marking flag; a template's
+    // marking cannot change once created, so its own flag is the one they used
+    if (version < 5 &&
+        !executeSQL("UPDATE exam_results SET negative_marking = 1 WHERE negative_marking = 0 AND exam_template_id IN"
+                    " (SELECT id FROM exam_templates WHERE negative_marking = 1);"))
+    {
+        return false;
+    }
+
+    // Dropping the old tables dropped their indexes and triggers too
+    if (migrated && !createTables())
+    {
+        return false;
+    }
+
+    // createTables made users_search; index the rows written before it existed
+    return (!userSearchIndexed || executeSQL("INSERT INTO users_search(users_search) VALUES('rebuild');")) &&
+           executeSQL("PRAGMA user_version = " + to_string(currentVersion) + ";");
+}
+
+bool DatabaseManager::runMigration(const string &name, const vector<string> &steps)
+{
+    // Rebuild tables in one transaction (SQLite cannot change a column type
+    // in place); foreign keys must be off while referenced tables are swapped
+    executeSQL("PRAGMA foreign_keys = OFF;");
+    bool ok = executeSQL("BEGIN IMMEDIATE;");
+    for (size_t i = 0; ok && i < steps.size(); ++i)
+    {
+        ok = executeSQL(steps[i]);
+    }
+    executeSQL(ok ? "COMMIT;" : "ROLLBACK;");
+    executeSQL("PRAGMA foreign_keys = ON;");
+
+    if (!ok)
+    {
+        logError("updateSchema", name + " migration failed, database left unchanged");
+    }
+    return ok;
+}
+
 bool DatabaseManager::insertDefaultData()
 {
     // Insert default admin user
     const char *checkAdmin = "SELECT COUNT(*) FROM users WHERE role = 1;";
     sqlite3_stmt *stmt = prepareStatement(checkAdmin);
 
-    if (stmt && sqlite3_step(stmt) == SQLITE_ROW)
+    if (stmt && stepWithRetry(stmt, "insertDefaultData") == SQLITE_ROW)
     {
         int count = sqlite3_column_int(stmt, 0);
         finalizeStatement(stmt);
@@ -308,7 +879,7 @@ bool DatabaseManager::insertDefaultData()
     const char *checkSubjects = "SELECT COUNT(*) FROM subjects;";
     stmt = prepareStatement(checkSubjects);
 
-    if (stmt && sqlite3_step(stmt) == SQLITE_ROW)
+    if (stmt && stepWithRetry(stmt, "insertDefaultData") == SQLITE_ROW)
     {
         int count = sqlite3_column_int(stmt, 0);
         finalizeStatement(stmt);
@@ -329,7 +900,7 @@ bool DatabaseManager::insertDefaultData()
                 if (subjectStmt) {
                     sqlite3_bind_text(subjectStmt, 1, subject.first.c_str(), -1, SQLITE_TRANSIENT);
                     sqlite3_bind_text(subjectStmt, 2, subject.second.c_str(), -1, SQLITE_TRANSIENT);
-                    sqlite3_step(subjectStmt);
+                    stepWithRetry(subjectStmt, "insertDefaultData");
                     finalizeStatement(subjectStmt);
                 }
             }
@@ -340,7 +911,7 @@ bool DatabaseManager::insertDefaultData()
     const char *checkSettings = "SELECT COUNT(*) FROM system_settings;";
     stmt = prepareStatement(checkSettings);
 
-    if (stmt && sqlite3_step(stmt) == SQLITE_ROW)
+    if (stmt && stepWithRetry(stmt, "insertDefaultData") == SQLITE_ROW)
     {
         int count = sqlite3_column_int(stmt, 0);
         finalizeStatement(stmt);
@@ -365,7 +936,7 @@ bool DatabaseManager::insertDefaultData()
                     sqlite3_bind_text(settingStmt, 1, get<0>(setting).c_str(), -1, SQLITE_TRANSIENT);
                     sqlite3_bind_text(settingStmt, 2, get<1>(setting).c_str(), -1, SQLITE_TRANSIENT);
                     sqlite3_bind_text(settingStmt, 3, get<2>(setting).c_str(), -1, SQLITE_TRANSIENT);
-                    sqlite3_step(settingStmt);
+                    stepWithRetry(settingStmt, "insertDefaultData");
                     finalizeStatement(settingStmt);
                 }
             }
@@ -376,7 +947,7 @@ bool DatabaseManager::insertDefaultData()
     const char *checkQuestions = "SELECT COUNT(*) FROM questions;";
     stmt = prepareStatement(checkQuestions);
 
-    if (stmt && sqlite3_step(stmt) == SQLITE_ROW)
+    if (stmt && stepWithRetry(stmt, "insertDefaultData") == SQLITE_ROW)
     {
         int count = sqlite3_column_int(stmt, 0);
         finalizeStatement(stmt);
@@ -389,65 +960,65 @@ bool DatabaseManager::insertDefaultData()
             // DSA Questions
             sqlite3_stmt* qStmt = prepareStatement(insertQ);
             if (qStmt) {
-                sqlite3_bind_text(qStmt, 1, "DSA", -1, SQLITE_TRANSIENT);
+                bindValue(qStmt, 1, Subject::DSA);
                 sqlite3_bind_text(qStmt, 2, "What is the time complexity of binary search?", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(qStmt, 3, "O(n)", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(qStmt, 4, "O(log n)", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(qStmt, 5, "O(n^2)", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(qStmt, 6, "O(1)", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_int(qStmt, 7, 1);
-                sqlite3_bind_text(qStmt, 8, "Medium", -1, SQLITE_TRANSIENT);
+                bindValue(qStmt, 8, Difficulty::MEDIUM);
                 sqlite3_bind_text(qStmt, 9, "Binary search divides the search space in half each time.", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_int(qStmt, 10, 1);
-                sqlite3_step(qStmt);
+                stepWithRetry(qStmt, "insertDefaultData");
                 finalizeStatement(qStmt);
             }
 
             qStmt = prepareStatement(insertQ);
             if (qStmt) {
-                sqlite3_bind_text(qStmt, 1, "DSA", -1, SQLITE_TRANSIENT);
+                bindValue(qStmt, 1, Subject::DSA);
                 sqlite3_bind_text(qStmt, 2, "Which data structure uses LIFO principle?", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(qStmt, 3, "Queue", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(qStmt, 4, "Stack", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(qStmt, 5, "Array", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(qStmt, 6, "Linked List", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_int(qStmt, 7, 1);
-                sqlite3_bind_text(qStmt, 8, "Easy", -1, SQLITE_TRANSIENT);
+                bindValue(qStmt, 8, Difficulty::EASY);
                 sqlite3_bind_text(qStmt, 9, "Stack follows Last In First Out (LIFO) principle.", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_int(qStmt, 10, 1);
-                sqlite3_step(qStmt);
+                stepWithRetry(qStmt, "insertDefaultData");
                 finalizeStatement(qStmt);
             }
 
             qStmt = prepareStatement(insertQ);
             if (qStmt) {
-                sqlite3_bind_text(qStmt, 1, "OOP", -1, SQLITE_TRANSIENT);
+                bindValue(qStmt, 1, Subject::OOP);
                 sqlite3_bind_text(qStmt, 2, "What is encapsulation in OOP?", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(qStmt, 3, "Inheritance", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(qStmt, 4, "Data hiding", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(qStmt, 5, "Polymorphism", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(qStmt, 6, "Abstraction", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_int(qStmt, 7, 1);
-                sqlite3_bind_text(qStmt, 8, "Easy", -1, SQLITE_TRANSIENT);
+                bindValue(qStmt, 8, Difficulty::EASY);
                 sqlite3_bind_text(qStmt, 9, "Encapsulation is the bundling of data and methods.", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_int(qStmt, 10, 1);
-                sqlite3_step(qStmt);
+                stepWithRetry(qStmt, "insertDefaultData");
                 finalizeStatement(qStmt);
             }
 
             qStmt = prepareStatement(insertQ);
             if (qStmt) {
-                sqlite3_bind_text(qStmt, 1, "Mathematics", -1, SQLITE_TRANSIENT);
+                bindValue(qStmt, 1, Subject::MATHEMATICS);
                 sqlite3_bind_text(qStmt, 2, "What is 2^10?", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(qStmt, 3, "512", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(qStmt, 4, "1024", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(qStmt, 5, "256", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_text(qStmt, 6, "2048", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_int(qStmt, 7, 1);
-                sqlite3_bind_text(qStmt, 8, "Easy", -1, SQLITE_TRANSIENT);
+                bindValue(qStmt, 8, Difficulty::EASY);
                 sqlite3_bind_text(qStmt, 9, "2^10 = 1024", -1, SQLITE_TRANSIENT);
                 sqlite3_bind_int(qStmt, 10, 1);
-                sqlite3_step(qStmt);
+                stepWithRetry(qStmt, "insertDefaultData");
                 finalizeStatement(qStmt);
             }
         }
@@ -458,10 +1029,8 @@ bool DatabaseManager::insertDefaultData()
 
 bool DatabaseManager::insertUser(const User &user)
 {
-    const char *sql = R"(
-        INSERT INTO users (username, password, email, full_name, role, status, created_at) 
-        VALUES (?, ?, ?, ?, ?, ?, ?);
-    )";
+    static const string sql = "INSERT INTO users (" + EntityColumns::userInsert.selectList() +
+                              ") VALUES (" + EntityColumns::userInsert.placeholderList() + ");";
 
     sqlite3_stmt *stmt = prepareStatement(sql);
     if (!stmt) {
@@ -469,21 +1038,14 @@ bool DatabaseManager::insertUser(const User &user)
         return false;
     }
 
-    sqlite3_bind_text(stmt, 1, user.getUsername().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, user.getPassword().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, user.getEmail().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 4, user.getFullName().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt, 5, static_cast<int>(user.getRole()));
-    sqlite3_bind_int(stmt, 6, static_cast<int>(user.getStatus()));
-    string currentTime = Utils::getCurrentDateTime();
-    sqlite3_bind_text(stmt, 7, currentTime.c_str(), -1, SQLITE_TRANSIENT);
+    EntityColumns::userInsert.bind(stmt, user);
+
+    int result = stepWithRetry(stmt, "insertUser");
 
-    int result = sqlite3_step(stmt);
-    
     if (result != SQLITE_DONE) {
         logError("insertUser", sqlite3_errmsg(db));
     }
-    
+
     finalizeStatement(stmt);
 
     return result == SQLITE_DONE;
@@ -491,28 +1053,16 @@ bool DatabaseManager::insertUser(const User &user)
 
 bool DatabaseManager::updateUser(const User &user)
 {
-    const char *sql = R"(
-        UPDATE users SET username=?, password=?, email=?, full_name=?, role=?, status=?, 
-               last_login=?, login_attempts=?, is_locked=? 
-        WHERE id=?;
-    )";
+    static const string sql = "UPDATE users SET " + EntityColumns::userUpdate.assignmentList() + " WHERE id=?;";
 
     sqlite3_stmt *stmt = prepareStatement(sql);
     if (!stmt)
         return false;
 
-    sqlite3_bind_text(stmt, 1, user.getUsername().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, user.getPassword().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, user.getEmail().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 4, user.getFullName().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt, 5, static_cast<int>(user.getRole()));
-    sqlite3_bind_int(stmt, 6, static_cast<int>(user.getStatus()));
-    sqlite3_bind_text(stmt, 7, user.getLastLogin().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt, 8, user.getLoginAttempts());
-    sqlite3_bind_int(stmt, 9, user.getIsLocked() ? 1 : 0);
-    sqlite3_bind_int(stmt, 10, user.getId());
-
-    int result = sqlite3_step(stmt);
+    EntityColumns::userUpdate.bind(stmt, user);
+    sqlite3_bind_int(stmt, EntityColumns::userUpdate.columnCount() + 1, user.getId());
+
+    int result = stepWithRetry(stmt, "updateUser");
     finalizeStatement(stmt);
 
     return result == SQLITE_DONE;
@@ -524,12 +1074,9 @@ User DatabaseManager::getUserByUsername(const string &username)
     if (username.empty()) {
         return User();
     }
-    
-    const char *sql = R"(
-        SELECT id, username, password, email, full_name, role, status, created_at, 
-               last_login, login_attempts, is_locked 
-        FROM users WHERE username = ? AND username != '';
-    )";
+
+    static const string sql = "SELECT " + EntityColumns::user.selectList() +
+                              " FROM users WHERE username = ? AND username != '';";
 
     sqlite3_stmt *stmt = prepareStatement(sql);
     User user;
@@ -537,74 +1084,84 @@ User DatabaseManager::getUserByUsername(const string &username)
     if (stmt)
     {
         sqlite3_bind_text(stmt, 1, username.c_str(), -1, SQLITE_TRANSIENT);
-
-        if (sqlite3_step(stmt) == SQLITE_ROW)
-        {
-            user.setId(sqlite3_column_int(stmt, 0));
-            
-            const char* usernamePtr = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
-            const char* passwordPtr = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2));
-            const char* emailPtr = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3));
-            const char* fullNamePtr = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4));
-            
-            if (usernamePtr) user.setUsername(usernamePtr);
-            if (passwordPtr) user.setPassword(passwordPtr);
-            if (emailPtr) user.setEmail(emailPtr);
-            if (fullNamePtr) user.setFullName(fullNamePtr);
-            
-            user.setRole(static_cast<UserRole>(sqlite3_column_int(stmt, 5)));
-            user.setStatus(static_cast<UserStatus>(sqlite3_column_int(stmt, 6)));
-
-            const char *lastLogin = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 8));
-            if (lastLogin)
-            {
-                user.setLastLogin(lastLogin);
-            }
-        }
-
+        readRow(stmt, EntityColumns::user, user, "getUserByUsername");
         finalizeStatement(stmt);
     }
 
     return user;
 }
 
-vector<User> DatabaseManager::getAllUsers()
+User DatabaseManager::getUserById(int userId)
 {
-    const char *sql = R"(
-        SELECT id, username, password, email, full_name, role, status, created_at, 
-               last_login, login_attempts, is_locked 
-        FROM users ORDER BY id;
-    )";
+    static const string sql = "SELECT " + EntityColumns::user.selectList() + " FROM users WHERE id = ?;";
 
     sqlite3_stmt *stmt = prepareStatement(sql);
-    vector<User> users;
+    User user;
 
     if (stmt)
     {
-        while (sqlite3_step(stmt) == SQLITE_ROW)
-        {
-            User user;
-            user.setId(sqlite3_column_int(stmt, 0));
-            user.setUsername(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1)));
-            user.setPassword(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2)));
-            user.setEmail(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3)));
-            user.setFullName(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4)));
-            user.setRole(static_cast<UserRole>(sqlite3_column_int(stmt, 5)));
-            user.setStatus(static_cast<UserStatus>(sqlite3_column_int(stmt, 6)));
-
-            const char *lastLogin = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 8));
-            if (lastLogin)
-            {
-                user.setLastLogin(lastLogin);
-            }
-
-            users.push_back(user);
-        }
-
+        sqlite3_bind_int(stmt, 1, userId);
+        readRow(stmt, EntityColumns::user, user, "getUserById");
         finalizeStatement(stmt);
     }
 
-    return users;
+    return user;
+}
+
+bool DatabaseManager::deleteUser(int userId)
+{
+    // The cascade takes the user's exam templates and their questions with
+    // it, so find them first; afterwards neither the database nor a freshly
+    // loaded catalog knows them
+    vector<int> ownTemplates;
+    sqlite3_stmt *stmt = prepareStatement("SELECT id FROM exam_templates WHERE created_by = ?;");
+    if (!stmt)
+        return false;
+    sqlite3_bind_int(stmt, 1, userId);
+    while (stepWithRetry(stmt, "deleteUser") == SQLITE_ROW)
+    {
+        ownTemplates.push_back(sqlite3_column_int(stmt, 0));
+    }
+    finalizeStatement(stmt);
+
+    stmt = prepareStatement("DELETE FROM users WHERE id = ?;");
+    if (!stmt)
+        return false;
+
+    sqlite3_bind_int(stmt, 1, userId);
+    int result = stepWithRetry(stmt, "deleteUser");
+    if (result != SQLITE_DONE)
+    {
+        logError("deleteUser", sqlite3_errmsg(db));
+    }
+    finalizeStatement(stmt);
+    bool deleted = result == SQLITE_DONE && sqlite3_changes(db) > 0;
+
+    if (deleted && !ownTemplates.empty())
+    {
+        invalidateTemplateCatalog();
+        for (int templateId : ownTemplates)
+        {
+            invalidateExamPaper(templateId);
+        }
+    }
+    return deleted;
+}
+
+vector<User> DatabaseManager::getAllUsers()
+{
+    static const string sql = "SELECT " + EntityColumns::user.selectList() + " FROM users ORDER BY id;";
+
+    sqlite3_stmt *stmt = prepareStatement(sql);
+    vector<User> users;
+
+    if (stmt)
+    {
+        users = readRows<User>(stmt, EntityColumns::user, "getAllUsers");
+        finalizeStatement(stmt);
+    }
+
+    return users;
 }
 
 bool DatabaseManager::authenticateUser(const string &username, const string &password, User &user)
@@ -638,11 +1195,8 @@ bool DatabaseManager::authenticateUser(const string &username, const string &pas
 
 bool DatabaseManager::insertQuestion(const Question &question)
 {
-    const char *sql = R"(
-        INSERT INTO questions (subject, question_text, option1, option2, option3, option4, 
-                             correct_answer, difficulty, explanation, created_by) 
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
-    )";
+    static const string sql = "INSERT INTO questions (" + EntityColumns::questionInsert.selectList() +
+                              ", created_by) VALUES (" + EntityColumns::questionInsert.placeholderList() + ", ?);";
 
     sqlite3_stmt *stmt = prepareStatement(sql);
     if (!stmt)
@@ -651,35 +1205,26 @@ bool DatabaseManager::insertQuestion(const Question &question)
         return false;
     }
 
-    auto options = question.getOptions();
+    EntityColumns::questionInsert.bind(stmt, question);
 
-    sqlite3_bind_text(stmt, 1, question.getSubject().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, question.getQuestionText().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, options[0].c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 4, options[1].c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 5, options[2].c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 6, options[3].c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt, 7, question.getCorrectAnswer());
-    sqlite3_bind_text(stmt, 8, question.getDifficulty().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 9, question.getExplanation().c_str(), -1, SQLITE_TRANSIENT);
-    
     // Handle created_by field - use NULL if 0
+    int createdByParam = EntityColumns::questionInsert.columnCount() + 1;
     if (question.getCreatedBy() > 0)
     {
-        sqlite3_bind_int(stmt, 10, question.getCreatedBy());
+        sqlite3_bind_int(stmt, createdByParam, question.getCreatedBy());
     }
     else
     {
-        sqlite3_bind_null(stmt, 10);
+        sqlite3_bind_null(stmt, createdByParam);
     }
 
-    int result = sqlite3_step(stmt);
-    
+    int result = stepWithRetry(stmt, "insertQuestion");
+
     if (result != SQLITE_DONE)
     {
         logError("insertQuestion", sqlite3_errmsg(db));
     }
-    
+
     finalizeStatement(stmt);
 
     return result == SQLITE_DONE;
@@ -688,47 +1233,14 @@ bool DatabaseManager::insertQuestion(const Question &question)
 vector<Question> DatabaseManager::getAllQuestions()
 {
     vector<Question> questions;
-    const char *sql = R"(
-        SELECT id, subject, question_text, option1, option2, option3, option4, 
-               correct_answer, difficulty, explanation, created_by, is_active
-        FROM questions WHERE is_active = 1 ORDER BY id;
-    )";
+    static const string sql = "SELECT " + EntityColumns::question.selectList() +
+                              " FROM questions WHERE is_active = 1 ORDER BY id;";
 
     sqlite3_stmt *stmt = prepareStatement(sql);
 
     if (stmt)
     {
-        while (sqlite3_step(stmt) == SQLITE_ROW)
-        {
-            Question question;
-            question.setId(sqlite3_column_int(stmt, 0));
-            question.setSubject(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1)));
-            question.setQuestionText(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2)));
-
-            vector<string> options = {
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 5)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 6))};
-            question.setOptions(options);
-            question.setCorrectAnswer(sqlite3_column_int(stmt, 7));
-            question.setDifficulty(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 8)));
-
-            const char *explanation = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 9));
-            if (explanation)
-            {
-                question.setExplanation(explanation);
-            }
-
-            const char *createdBy = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 10));
-            if (createdBy) {
-                question.setCreatedBy(sqlite3_column_int(stmt, 10));
-            }
-            question.setIsActive(sqlite3_column_int(stmt, 11) == 1);
-
-            questions.push_back(question);
-        }
-
+        questions = readRows<Question>(stmt, EntityColumns::question, "getAllQuestions");
         finalizeStatement(stmt);
     }
 
@@ -737,15 +1249,11 @@ vector<Question> DatabaseManager::getAllQuestions()
 
 vector<Question> DatabaseManager::getRandomQuestions(int count, const string &subject)
 {
-    string sql = R"(
-        SELECT id, subject, question_text, option1, option2, option3, option4, 
-               correct_answer, difficulty, explanation, is_active
-        FROM questions WHERE is_active = 1
-    )";
+    string sql = "SELECT " + EntityColumns::question.selectList() + " FROM questions WHERE is_active = 1";
 
     if (!subject.empty())
     {
-        sql += " AND subject = '" + escapeString(subject) + "'";
+        sql += " AND subject = " + to_string(static_cast<int>(SUBJECT_CODES.code(subject)));
     }
 
     sql += " ORDER BY RANDOM() LIMIT " + to_string(count) + ";";
@@ -755,32 +1263,7 @@ vector<Question> DatabaseManager::getRandomQuestions(int count, const string &su
 
     if (stmt)
     {
-        while (sqlite3_step(stmt) == SQLITE_ROW)
-        {
-            Question question;
-            question.setId(sqlite3_column_int(stmt, 0));
-            question.setSubject(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1)));
-            question.setQuestionText(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2)));
-
-            vector<string> options = {
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 5)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 6))};
-            question.setOptions(options);
-            question.setCorrectAnswer(sqlite3_column_int(stmt, 7));
-            question.setDifficulty(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 8)));
-            
-            const char* explanation = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 9));
-            if (explanation) {
-                question.setExplanation(explanation);
-            }
-            
-            question.setIsActive(sqlite3_column_int(stmt, 10) == 1);
-
-            questions.push_back(question);
-        }
-
+        questions = readRows<Question>(stmt, EntityColumns::question, "getRandomQuestions");
         finalizeStatement(stmt);
     }
 
@@ -789,89 +1272,446 @@ vector<Question> DatabaseManager::getRandomQuestions(int count, const string &su
 
 bool DatabaseManager::insertExamResult(const ExamResult &result)
 {
-    const char *sql = R"(
-        INSERT INTO exam_results (user_id, username, exam_template_id, score, total_questions, percentage, 
-                                exam_date, start_time, end_time, duration, subject, exam_type, exam_name) 
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
-    )";
+    static const string sql = "INSERT INTO exam_results (" + EntityColumns::examResultInsert.selectList() +
+                              ") VALUES (" + EntityColumns::examResultInsert.placeholderList() + ");";
+
+    // A template exam's answers go in with it, so it can be regraded later
+    bool withAnswers = result.getExamTemplateId() != 0 && !result.getQuestionIds().empty();
+    if (withAnswers && !beginTransaction())
+        return false;
+
+    sqlite3_stmt *stmt = prepareStatement(sql);
+    int res = SQLITE_ERROR;
+    if (stmt)
+    {
+        EntityColumns::examResultInsert.bind(stmt, result);
+        res = stepWithRetry(stmt, "insertExamResult");
+        if (res != SQLITE_DONE)
+        {
+            logError("insertExamResult", sqlite3_errmsg(db));
+        }
+        finalizeStatement(stmt);
+    }
+    bool ok = res == SQLITE_DONE;
+
+    if (withAnswers)
+    {
+        ok = ok && insertExamAnswers(static_cast<int>(sqlite3_last_insert_rowid(db)), result) && commitTransaction();
+        if (!ok)
+        {
+            rollbackTransaction();
+        }
+    }
+    return ok;
+}
+
+bool DatabaseManager::insertExamAnswers(int resultId, const ExamResult &result)
+{
+    static const string sql =
+        "INSERT INTO exam_answers (result_id, question_id, user_answer, is_correct) VALUES (?, ?, ?, ?);";
 
     sqlite3_stmt *stmt = prepareStatement(sql);
     if (!stmt)
         return false;
 
-    sqlite3_bind_int(stmt, 1, result.getUserId());
-    sqlite3_bind_text(stmt, 2, result.getUsername().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt, 3, result.getExamTemplateId());
-    sqlite3_bind_int(stmt, 4, result.getScore());
-    sqlite3_bind_int(stmt, 5, result.getTotalQuestions());
-    sqlite3_bind_double(stmt, 6, result.getPercentage());
-    sqlite3_bind_text(stmt, 7, result.getExamDate().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 8, result.getStartTime().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 9, result.getEndTime().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt, 10, result.getDuration());
-    sqlite3_bind_text(stmt, 11, result.getSubject().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 12, result.getExamType().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 13, result.getTemplateName().c_str(), -1, SQLITE_TRANSIENT);
-
-    int res = sqlite3_step(stmt);
-    finalizeStatement(stmt);
+    vector<int> questionIds = result.getQuestionIds();
+    vector<int> userAnswers = result.getUserAnswers();
+    vector<bool> correctAnswers = result.getCorrectAnswers();
+    bool ok = true;
+    for (size_t i = 0; ok && i < questionIds.size(); ++i)
+    {
+        int answer = i < userAnswers.size() ? userAnswers[i] : -1;
+        sqlite3_bind_int(stmt, 1, resultId);
+        sqlite3_bind_int(stmt, 2, questionIds[i]);
+        if (answer >= 0)
+            sqlite3_bind_int(stmt, 3, answer);
+        else
+            sqlite3_bind_null(stmt, 3); // Unanswered
+        sqlite3_bind_int(stmt, 4, i < correctAnswers.size() && correctAnswers[i] ? 1 : 0);
 
-    return res == SQLITE_DONE;
+        ok = stepWithRetry(stmt, "insertExamAnswers") == SQLITE_DONE;
+        sqlite3_reset(stmt);
+    }
+    if (!ok)
+    {
+        logError("insertExamAnswers", sqlite3_errmsg(db));
+    }
+    finalizeStatement(stmt);
+    return ok;
 }
 
 vector<ExamResult> DatabaseManager::getExamResultsByUser(int userId)
 {
     vector<ExamResult> results;
-    const char *sql = R"(
-        SELECT id, user_id, username, exam_template_id, score, total_questions, percentage, exam_date, 
-               start_time, end_time, duration, subject, exam_type, exam_name
-        FROM exam_results WHERE user_id = ? ORDER BY exam_date DESC;
-    )";
+    static const string sql = "SELECT " + EntityColumns::examResult.selectList() +
+                              " FROM exam_results WHERE user_id = ? ORDER BY exam_date DESC;";
+
+    sqlite3_stmt *stmt = prepareStatement(sql);
+
+    if (stmt)
+    {
+        sqlite3_bind_int(stmt, 1, userId);
+        results = readRows<ExamResult>(stmt, EntityColumns::examResult, "getExamResultsByUser");
+        finalizeStatement(stmt);
+    }
+
+    return results;
+}
+
+vector<ResultSummary> DatabaseManager::getResultSummariesByUser(int userId)
+{
+    vector<ResultSummary> summaries;
+    static const string sql = "SELECT " + EntityColumns::resultSummary.selectList() +
+                              " FROM exam_results WHERE user_id = ? ORDER BY exam_date DESC;";
 
     sqlite3_stmt *stmt = prepareStatement(sql);
 
     if (stmt)
     {
         sqlite3_bind_int(stmt, 1, userId);
+        summaries = readRows<ResultSummary>(stmt, EntityColumns::resultSummary, "getResultSummariesByUser");
+        finalizeStatement(stmt);
+    }
+
+    return summaries;
+}
+
+// One read chunk of a regrade, already graded
+struct RegradeChunk
+{
+    vector<RegradeChange> changes;
+    size_t results;
+    size_t regraded;
+    bool failed;
+
+    RegradeChunk() : results(0), regraded(0), failed(false) {}
+};
+
+// Hands graded chunks from the readers to the writing thread. Bounded, so
+// readers block rather than run far ahead of the writes.
+class RegradeChannel
+{
+private:
+    mutex channelMutex;
+    condition_variable changed;
+    Queue<RegradeChunk> chunks;
+    int openReaders;
+
+public:
+    RegradeChannel(size_t capacity, int readers) : chunks(capacity), openReaders(readers) {}
+
+    void push(RegradeChunk &&chunk)
+    {
+        unique_lock<mutex> lock(channelMutex);
+        changed.wait(lock, [this] { return chunks.size() < chunks.getCapacity(); });
+        chunks.push(move(chunk));
+        changed.notify_all();
+    }
+
+    void readerDone()
+    {
+        lock_guard<mutex> lock(channelMutex);
+        openReaders--;
+        changed.notify_all();
+    }
 
-        while (sqlite3_step(stmt) == SQLITE_ROW)
+    // False once every reader is done and everything has been taken
+    bool pop(RegradeChunk &chunk)
+    {
+        unique_lock<mutex> lock(channelMutex);
+        changed.wait(lock, [this] { return !chunks.empty() || openReaders == 0; });
+        if (chunks.empty())
+            return false;
+        chunk = move(chunks.front());
+        chunks.pop();
+        changed.notify_all();
+        return true;
+    }
+};
+
+// Reads the results of one template with ids in (fromId, toId] on a
+// connection of its own, REGRADE_BATCH at a time, and grades each against
+// the key. Only the questions a result has answer rows for are graded, so
+// questions added since it was taken cost it nothing, and answers to
+// questions no longer on the paper are ignored. Negative marking follows the
+// flag stored on the result; the mark values and skip penalty are fixed when
+// a template is created, so the template's are the ones it was graded with.
+static void readRegradeRange(const string &dbPath, const ExamTemplate &examTemplate, long long fromId, long long toId,
+                             const vector<uint8_t> &key, const HashTable<int, uint32_t> &keyIndex, int batchSize,
+                             RegradeChannel &channel)
+{
+    static const char *sql =
+        "SELECT r.id, r.user_id, r.username, r.score, r.percentage, r.total_questions, r.negative_marking, "
+        "       r.negative_marks, a.question_id, a.user_answer "
+        "FROM (SELECT id, user_id, username, score, percentage, total_questions, negative_marking, negative_marks "
+        "      FROM exam_results "
+        "      WHERE exam_template_id = ?1 AND id > ?2 AND id <= ?3 ORDER BY id LIMIT ?4) r "
+        "LEFT JOIN exam_answers a ON a.result_id = r.id ORDER BY r.id;";
+
+    sqlite3 *conn = nullptr;
+    sqlite3_stmt *stmt = nullptr;
+    bool ok = sqlite3_open_v2(dbPath.c_str(), &conn, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK &&
+              sqlite3_prepare_v2(conn, sql, -1, &stmt, nullptr) == SQLITE_OK;
+    if (conn)
+        sqlite3_busy_timeout(conn, 1000);
+
+    // Indexed by the result's negative_marking flag
+    const MarkingScheme marking[2] = {
+        MarkingScheme(false, 0.0, examTemplate.getSkipPenalty()),
+        MarkingScheme(true, examTemplate.getNegativeMarkValue(), examTemplate.getSkipPenalty())};
+    const GradingPolicies::GradeFunction grade[2] = {GradingPolicies::forScheme(marking[0]),
+                                                     GradingPolicies::forScheme(marking[1])};
+    vector<uint8_t> sheet;
+    vector<uint8_t> sheetKey;
+    sheet.reserve(key.size());
+    sheetKey.reserve(key.size());
+    long long lastId = fromId;
+    while (ok)
+    {
+        sqlite3_bind_int(stmt, 1, examTemplate.getId());
+        sqlite3_bind_int64(stmt, 2, lastId);
+        sqlite3_bind_int64(stmt, 3, toId);
+        sqlite3_bind_int(stmt, 4, batchSize);
+
+        RegradeChunk chunk;
+        RegradeChange current;
+        int totalQuestions = 0;
+        int negativeMarking = 0;
+        bool hasAnswers = false;
+
+        // Score the result whose rows were just read, if it has answers
+        auto finish = [&]()
+        {
+            chunk.results++;
+            if (!hasAnswers)
+                return;
+            chunk.regraded++;
+            GradeMarks marks =
+                grade[negativeMarking](sheet.data(), sheetKey.data(), sheet.size(), marking[negativeMarking]);
+            current.newScore = static_cast<int>(marks.score);
+            current.newPercentage = totalQuestions > 0 ? current.newScore * 100.0 / totalQuestions : 0.0;
+            current.newNegativeMarks = marks.negativeMarks;
+            // A score held at 0 can still change what was taken off for wrong answers
+            if (current.newScore != current.oldScore || current.newNegativeMarks != current.oldNegativeMarks)
+                chunk.changes.push_back(current);
+        };
+
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
         {
-            ExamResult result;
-            result.setId(sqlite3_column_int(stmt, 0));
-            result.setUserId(sqlite3_column_int(stmt, 1));
-            result.setUsername(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2)));
-            result.setExamTemplateId(sqlite3_column_int(stmt, 3));
-            result.setScore(sqlite3_column_int(stmt, 4));
-            result.setTotalQuestions(sqlite3_column_int(stmt, 5));
-            // percentage is calculated automatically in setScore/setTotalQuestions
-            result.setExamDate(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 7)));
-
-            const char *startTime = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 8));
-            const char *endTime = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 9));
-            const char *subject = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 11));
-            const char *examType = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 12));
-            const char *examName = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 13));
-
-            if (startTime)
-                result.setStartTime(startTime);
-            if (endTime)
-                result.setEndTime(endTime);
-            if (subject)
-                result.setSubject(subject);
-            if (examType)
-                result.setExamType(examType);
-            if (examName)
-                result.setTemplateName(examName);
-
-            result.setDuration(sqlite3_column_int(stmt, 10));
-
-            results.push_back(result);
+            int resultId = sqlite3_column_int(stmt, 0);
+            if (resultId != current.resultId)
+            {
+                if (current.resultId != 0)
+                    finish();
+                current = RegradeChange();
+                current.resultId = resultId;
+                current.userId = sqlite3_column_int(stmt, 1);
+                const unsigned char *username = sqlite3_column_text(stmt, 2);
+                current.username = username ? reinterpret_cast<const char *>(username) : "";
+                current.oldScore = sqlite3_column_int(stmt, 3);
+                current.oldPercentage = sqlite3_column_double(stmt, 4);
+                totalQuestions = sqlite3_column_int(stmt, 5);
+                negativeMarking = sqlite3_column_int(stmt, 6) != 0;
+                current.oldNegativeMarks = sqlite3_column_double(stmt, 7);
+                hasAnswers = false;
+                sheet.clear();
+                sheetKey.clear();
+            }
+
+            if (sqlite3_column_type(stmt, 8) == SQLITE_NULL)
+                continue; // No answers recorded for this result
+            hasAnswers = true;
+            const uint32_t *index = keyIndex.find(sqlite3_column_int(stmt, 8));
+            if (!index)
+                continue;
+            int answer = sqlite3_column_type(stmt, 9) == SQLITE_NULL ? -1 : sqlite3_column_int(stmt, 9);
+            sheet.push_back(answer >= 0 && answer < 4 ? static_cast<uint8_t>(answer) : UNANSWERED);
+            sheetKey.push_back(key[*index]);
         }
+        if (current.resultId != 0)
+            finish();
+        sqlite3_reset(stmt);
 
-        finalizeStatement(stmt);
+        if (rc != SQLITE_DONE)
+        {
+            chunk.failed = true;
+            ok = false;
+        }
+        bool last = chunk.results < static_cast<size_t>(batchSize);
+        lastId = current.resultId;
+        if (chunk.results > 0 || chunk.failed)
+            channel.push(move(chunk));
+        if (last)
+            break;
     }
 
-    return results;
+    if (!ok && !stmt)
+    {
+        RegradeChunk failed;
+        failed.failed = true;
+        channel.push(move(failed));
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(conn);
+    channel.readerDone();
+}
+
+RegradeReport DatabaseManager::regradeExamResults(int examTemplateId, bool dryRun, const RegradeProgress &progress)
+{
+    auto started = chrono::steady_clock::now();
+    RegradeReport report;
+    report.examTemplateId = examTemplateId;
+    report.dryRun = dryRun;
+    if (!isConnected)
+        return report;
+
+    ExamTemplate examTemplate = getExamTemplateById(examTemplateId);
+    if (examTemplate.getId() == 0)
+        return report;
+
+    // The current answer key, indexed by exam question id
+    shared_ptr<const ExamPaper> paper = getSharedExamPaper(examTemplateId);
+    vector<uint8_t> key(paper->questions.size());
+    HashTable<int, uint32_t> keyIndex;
+    for (size_t i = 0; i < paper->questions.size(); ++i)
+    {
+        key[i] = static_cast<uint8_t>(paper->questions[i].getCorrectAnswer());
+        keyIndex.insert(paper->questions[i].getId(), static_cast<uint32_t>(i));
+    }
+
+    static const string rangeSql =
+        "SELECT COUNT(*), COALESCE(MIN(id), 0), COALESCE(MAX(id), 0) FROM exam_results WHERE exam_template_id = ?;";
+    sqlite3_stmt *stmt = prepareStatement(rangeSql);
+    if (!stmt)
+        return report;
+    sqlite3_bind_int(stmt, 1, examTemplateId);
+    size_t total = 0;
+    long long minId = 0, maxId = 0;
+    if (stepWithRetry(stmt, "regradeExamResults") == SQLITE_ROW)
+    {
+        total = static_cast<size_t>(sqlite3_column_int64(stmt, 0));
+        minId = sqlite3_column_int64(stmt, 1);
+        maxId = sqlite3_column_int64(stmt, 2);
+    }
+    finalizeStatement(stmt);
+
+    // Split the id range between readers; small templates get one
+    int readers = static_cast<int>(min<size_t>(max(1u, thread::hardware_concurrency()), MAX_REGRADE_READERS));
+    readers = static_cast<int>(min<size_t>(readers, total / REGRADE_BATCH + 1));
+    RegradeChannel channel(2 * readers, readers);
+    vector<thread> workers;
+    long long span = maxId - minId + 1;
+    for (int r = 0; r < readers; ++r)
+    {
+        long long fromId = minId - 1 + span * r / readers;
+        long long toId = minId - 1 + span * (r + 1) / readers;
+        workers.emplace_back(readRegradeRange, cref(dbPath), cref(examTemplate), fromId, toId, cref(key),
+                             cref(keyIndex), REGRADE_BATCH, ref(channel));
+    }
+
+    // This thread writes, one transaction per chunk
+    bool ok = true;
+    RegradeChunk chunk;
+    while (channel.pop(chunk))
+    {
+        ok = ok && !chunk.failed;
+        report.results += chunk.results;
+        report.regraded += chunk.regraded;
+        if (ok && !dryRun && !chunk.changes.empty())
+        {
+            ok = writeRegradeBatch(chunk.changes);
+            if (ok)
+                report.batches++;
+        }
+        report.changes.insert(report.changes.end(), chunk.changes.begin(), chunk.changes.end());
+        if (progress)
+            progress(report.results, total);
+    }
+    for (thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    // Per-answer correctness follows the new key in one statement per question
+    if (ok && !dryRun)
+    {
+        static const string answersSql =
+            "UPDATE exam_answers SET is_correct = COALESCE(user_answer = ?, 0) WHERE question_id = ?;";
+        ok = beginTransaction();
+        sqlite3_stmt *update = ok ? prepareStatement(answersSql) : nullptr;
+        for (size_t i = 0; update && ok && i < paper->questions.size(); ++i)
+        {
+            sqlite3_bind_int(update, 1, key[i]);
+            sqlite3_bind_int(update, 2, paper->questions[i].getId());
+            ok = stepWithRetry(update, "regradeExamAnswers") == SQLITE_DONE;
+            sqlite3_reset(update);
+        }
+        finalizeStatement(update);
+        ok = ok && update && commitTransaction();
+        if (!ok)
+            rollbackTransaction();
+    }
+
+    report.skipped = report.results - report.regraded;
+    report.complete = ok;
+    report.elapsedMs = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+    return report;
+}
+
+bool DatabaseManager::writeRegradeBatch(const vector<RegradeChange> &changes)
+{
+    static const string sql = "UPDATE exam_results SET score = ?, percentage = ?, negative_marks = ? WHERE id = ?;";
+
+    if (!beginTransaction())
+        return false;
+
+    sqlite3_stmt *stmt = prepareStatement(sql);
+    bool ok = stmt != nullptr;
+    for (size_t i = 0; ok && i < changes.size(); ++i)
+    {
+        sqlite3_bind_int(stmt, 1, changes[i].newScore);
+        sqlite3_bind_double(stmt, 2, changes[i].newPercentage);
+        sqlite3_bind_double(stmt, 3, changes[i].newNegativeMarks);
+        sqlite3_bind_int(stmt, 4, changes[i].resultId);
+        ok = stepWithRetry(stmt, "writeRegradeBatch") == SQLITE_DONE;
+        sqlite3_reset(stmt);
+    }
+    finalizeStatement(stmt);
+
+    if (ok && commitTransaction())
+        return true;
+    logError("writeRegradeBatch", sqlite3_errmsg(db));
+    rollbackTransaction();
+    return false;
+}
+
+// Transaction management. IMMEDIATE takes the write lock up front, so the
+// statements inside cannot hit SQLITE_BUSY half way; waiting for the lock
+// goes through the busy retry layer like any other statement.
+bool DatabaseManager::beginTransaction()
+{
+    sqlite3_stmt *stmt = prepareStatement("BEGIN IMMEDIATE;");
+    if (!stmt)
+        return false;
+    int rc = stepWithRetry(stmt, "beginTransaction");
+    finalizeStatement(stmt);
+    if (rc != SQLITE_DONE)
+    {
+        logError("beginTransaction", sqlite3_errmsg(db));
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::commitTransaction()
+{
+    return executeSQL("COMMIT;");
+}
+
+bool DatabaseManager::rollbackTransaction()
+{
+    return executeSQL("ROLLBACK;");
 }
 
 // Helper methods
@@ -913,6 +1753,102 @@ sqlite3_stmt *DatabaseManager::prepareStatement(const string &sql)
     return stmt;
 }
 
+int DatabaseManager::stepWithRetry(sqlite3_stmt *stmt, string_view operation)
+{
+    pair<StatementContention *, bool> entry = contentionStats.try_emplace(operation);
+    StatementContention *stats = entry.first;
+    if (entry.second)
+    {
+        stats->operation = string(operation);
+    }
+    stats->executions++;
+
+    int rc = sqlite3_step(stmt);
+    int attempt = 0;
+
+    while ((rc & 0xff) == SQLITE_BUSY || (rc & 0xff) == SQLITE_LOCKED)
+    {
+        stats->busyHits++;
+
+        // Inside an explicit transaction only the caller can retry safely
+        if (attempt >= MAX_BUSY_RETRIES || !sqlite3_get_autocommit(db))
+        {
+            stats->failures++;
+            logError(string(operation), "database busy after " + to_string(attempt) + " retries: " + sqlite3_errmsg(db));
+            return rc;
+        }
+
+        // A statement that hit SQLITE_BUSY made no changes, and reset keeps
+        // its bindings, so re-executing it is idempotent
+        sqlite3_reset(stmt);
+
+        int ceiling = min(MAX_BACKOFF_MS, BASE_BACKOFF_MS << attempt);
+        uniform_int_distribution<int> jitter(ceiling / 2, ceiling);
+        int delay = jitter(backoffRng);
+        this_thread::sleep_for(chrono::milliseconds(delay));
+
+        stats->retries++;
+        stats->backoffMs += delay;
+        attempt++;
+
+        rc = sqlite3_step(stmt);
+    }
+
+    return rc;
+}
+
+template <typename Entity, typename Mapper>
+vector<Entity> DatabaseManager::readRows(sqlite3_stmt *stmt, const Mapper &mapper, string_view operation,
+                                         bool *complete)
+{
+    vector<Entity> rows;
+    int rc = stepWithRetry(stmt, operation);
+    auto begin = chrono::steady_clock::now();
+
+    while (rc == SQLITE_ROW)
+    {
+        // Decode straight into the vector's slot; no temporary entity is copied in
+        if constexpr (is_constructible<Entity, RowDecode>::value)
+            rows.emplace_back(RowDecode());
+        else
+            rows.emplace_back();
+        mapper.decode(stmt, rows.back());
+        rc = sqlite3_step(stmt);
+    }
+
+    if (complete)
+        *complete = (rc == SQLITE_DONE);
+    recordDecode(mapper.entityName(), rows.size(),
+                 chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count());
+    return rows;
+}
+
+template <typename Entity, typename Mapper>
+bool DatabaseManager::readRow(sqlite3_stmt *stmt, const Mapper &mapper, Entity &target, string_view operation)
+{
+    if (stepWithRetry(stmt, operation) != SQLITE_ROW)
+        return false;
+
+    auto begin = chrono::steady_clock::now();
+    mapper.decode(stmt, target);
+    recordDecode(mapper.entityName(), 1,
+                 chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count());
+    return true;
+}
+
+void DatabaseManager::recordDecode(const char *entity, size_t rows, double elapsedMs)
+{
+    pair<DecodeStats *, bool> entry = decodeStats.try_emplace(entity);
+    DecodeStats *stats = entry.first;
+    if (entry.second)
+    {
+        stats->entity = entity;
+    }
+    stats->queries++;
+    stats->rows += rows;
+    stats->totalMs += elapsedMs;
+}
+
 void DatabaseManager::finalizeStatement(sqlite3_stmt *stmt)
 {
     if (stmt)
@@ -944,18 +1880,25 @@ void DatabaseManager::logError(const string &operation, const string &error)
 }
 
 // Question class implementation
-Question::Question() : id(0), correctAnswer(0), createdBy(0), isActive(true)
+Question::Question() : id(0), subject(Subject::NONE), correctAnswer(0), difficulty(Difficulty::NONE),
+                       createdBy(0), isActive(true)
 {
     options.resize(4);
     createdAt = Utils::getCurrentDateTime();
     updatedAt = createdAt;
 }
 
+Question::Question(RowDecode) : id(0), subject(Subject::NONE), correctAnswer(0), difficulty(Difficulty::NONE),
+                                createdBy(0), isActive(true)
+{
+    options.resize(4);
+}
+
 Question::Question(int id, const string &subject, const string &questionText,
                    const vector<string> &options, int correctAnswer,
                    const string &difficulty, const string &explanation)
-    : id(id), subject(subject), questionText(questionText), options(options),
-      correctAnswer(correctAnswer), difficulty(difficulty), explanation(explanation),
+    : id(id), subject(SUBJECT_CODES.code(subject)), questionText(questionText), options(options),
+      correctAnswer(correctAnswer), difficulty(DIFFICULTY_CODES.code(difficulty)), explanation(explanation),
       createdBy(0), isActive(true)
 {
 
@@ -970,21 +1913,21 @@ Question::Question(int id, const string &subject, const string &questionText,
 
 bool Question::isValid() const
 {
-    return !subject.empty() && !questionText.empty() &&
+    return subject != Subject::NONE && !questionText.empty() &&
            options.size() == 4 && correctAnswer >= 0 && correctAnswer < 4 &&
            all_of(options.begin(), options.end(), [](const string &opt)
                   { return !opt.empty(); });
 }
 
-void Question::display() const
+void Question::display(const uint8_t *optionOrder) const
 {
     cout << "\nQ" << id << ". " << questionText << endl;
-    cout << "Subject: " << subject << " | Difficulty: " << difficulty << endl;
+    cout << "Subject: " << getSubject() << " | Difficulty: " << getDifficulty() << endl;
 
     char optionLabels[] = {'a', 'b', 'c', 'd'};
     for (size_t i = 0; i < options.size(); ++i)
     {
-        cout << optionLabels[i] << ". " << options[i] << endl;
+        cout << optionLabels[i] << ". " << options[optionOrder ? optionOrder[i] : i] << endl;
     }
 }
 
@@ -1006,17 +1949,26 @@ bool Question::operator==(const Question &other) const
 
 // ExamResult class implementation
 ExamResult::ExamResult() : id(0), userId(0), score(0), totalQuestions(0),
-                           percentage(0.0), duration(0), examTemplateId(0)
+                           percentage(0.0), examDateMs(Utils::nowEpochMs()), startTimeMs(0), endTimeMs(0),
+                           duration(0), subject(Subject::NONE), difficulty(Difficulty::NONE),
+                           examType(ExamType::NONE), examTemplateId(0)
+{
+}
+
+ExamResult::ExamResult(RowDecode) : id(0), userId(0), score(0), totalQuestions(0), percentage(0.0),
+                                    examDateMs(0), startTimeMs(0), endTimeMs(0), duration(0), subject(Subject::NONE),
+                                    difficulty(Difficulty::NONE), examType(ExamType::NONE), examTemplateId(0),
+                                    timeLimit(0), negativeMarking(false), negativeMarks(0.0)
 {
-    examDate = Utils::getCurrentDateTime();
 }
 
 ExamResult::ExamResult(int userId, const string &username, int score, int totalQuestions,
                        const string &subject, const string &difficulty)
     : id(0), userId(userId), username(username), score(score), totalQuestions(totalQuestions),
-      duration(0), subject(subject), difficulty(difficulty), examTemplateId(0)
+      examDateMs(Utils::nowEpochMs()), startTimeMs(0), endTimeMs(0), duration(0),
+      subject(SUBJECT_CODES.code(subject)), difficulty(DIFFICULTY_CODES.code(difficulty)),
+      examType(ExamType::NONE), examTemplateId(0)
 {
-    examDate = Utils::getCurrentDateTime();
     calculatePercentage();
 }
 
@@ -1063,7 +2015,7 @@ void ExamResult::display() const
     cout << "Score: " << score << "/" << totalQuestions << endl;
     cout << "Percentage: " << fixed << setprecision(2) << percentage << "%" << endl;
     cout << "Grade: " << getGrade() << endl;
-    cout << "Date: " << examDate << endl;
+    cout << "Date: " << getExamDate() << endl;
     cout << "Status: " << (isPassed() ? "PASSED" : "FAILED") << endl;
 }
 
@@ -1082,7 +2034,7 @@ int DatabaseManager::getTotalUsers()
     const char *sql = "SELECT COUNT(*) FROM users;";
     sqlite3_stmt *stmt = prepareStatement(sql);
 
-    if (stmt && sqlite3_step(stmt) == SQLITE_ROW)
+    if (stmt && stepWithRetry(stmt, "getTotalUsers") == SQLITE_ROW)
     {
         int count = sqlite3_column_int(stmt, 0);
         finalizeStatement(stmt);
@@ -1099,7 +2051,7 @@ int DatabaseManager::getTotalQuestions()
     const char *sql = "SELECT COUNT(*) FROM questions WHERE is_active = 1;";
     sqlite3_stmt *stmt = prepareStatement(sql);
 
-    if (stmt && sqlite3_step(stmt) == SQLITE_ROW)
+    if (stmt && stepWithRetry(stmt, "getTotalQuestions") == SQLITE_ROW)
     {
         int count = sqlite3_column_int(stmt, 0);
         finalizeStatement(stmt);
@@ -1116,7 +2068,7 @@ int DatabaseManager::getTotalExamResults()
     const char *sql = "SELECT COUNT(*) FROM exam_results;";
     sqlite3_stmt *stmt = prepareStatement(sql);
 
-    if (stmt && sqlite3_step(stmt) == SQLITE_ROW)
+    if (stmt && stepWithRetry(stmt, "getTotalExamResults") == SQLITE_ROW)
     {
         int count = sqlite3_column_int(stmt, 0);
         finalizeStatement(stmt);
@@ -1131,11 +2083,7 @@ int DatabaseManager::getTotalExamResults()
 // Question operations
 Question DatabaseManager::getQuestionById(int questionId)
 {
-    const char *sql = R"(
-        SELECT id, subject, question_text, option1, option2, option3, option4, 
-               correct_answer, difficulty, explanation, is_active 
-        FROM questions WHERE id = ?;
-    )";
+    static const string sql = "SELECT " + EntityColumns::question.selectList() + " FROM questions WHERE id = ?;";
 
     sqlite3_stmt *stmt = prepareStatement(sql);
     Question question;
@@ -1143,31 +2091,7 @@ Question DatabaseManager::getQuestionById(int questionId)
     if (stmt)
     {
         sqlite3_bind_int(stmt, 1, questionId);
-
-        if (sqlite3_step(stmt) == SQLITE_ROW)
-        {
-            question.setId(sqlite3_column_int(stmt, 0));
-            question.setSubject(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1)));
-            question.setQuestionText(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2)));
-
-            vector<string> options = {
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 5)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 6))};
-            question.setOptions(options);
-            question.setCorrectAnswer(sqlite3_column_int(stmt, 7));
-            question.setDifficulty(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 8)));
-
-            const char *explanation = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 9));
-            if (explanation)
-            {
-                question.setExplanation(explanation);
-            }
-
-            question.setIsActive(sqlite3_column_int(stmt, 10) == 1);
-        }
-
+        readRow(stmt, EntityColumns::question, question, "getQuestionById");
         finalizeStatement(stmt);
     }
 
@@ -1176,32 +2100,17 @@ Question DatabaseManager::getQuestionById(int questionId)
 
 bool DatabaseManager::updateQuestion(const Question &question)
 {
-    const char *sql = R"(
-        UPDATE questions 
-        SET subject = ?, question_text = ?, option1 = ?, option2 = ?, 
-            option3 = ?, option4 = ?, correct_answer = ?, difficulty = ?, 
-            explanation = ?, is_active = ?, updated_at = CURRENT_TIMESTAMP
-        WHERE id = ?;
-    )";
+    static const string sql = "UPDATE questions SET " + EntityColumns::questionUpdate.assignmentList() +
+                              ", updated_at = CURRENT_TIMESTAMP WHERE id = ?;";
 
     sqlite3_stmt *stmt = prepareStatement(sql);
 
     if (stmt)
     {
-        auto options = question.getOptions();
-        sqlite3_bind_text(stmt, 1, question.getSubject().c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 2, question.getQuestionText().c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 3, options[0].c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 4, options[1].c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 5, options[2].c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 6, options[3].c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_int(stmt, 7, question.getCorrectAnswer());
-        sqlite3_bind_text(stmt, 8, question.getDifficulty().c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 9, question.getExplanation().c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_int(stmt, 10, question.getIsActive() ? 1 : 0);
-        sqlite3_bind_int(stmt, 11, question.getId());
-
-        int result = sqlite3_step(stmt);
+        EntityColumns::questionUpdate.bind(stmt, question);
+        sqlite3_bind_int(stmt, EntityColumns::questionUpdate.columnCount() + 1, question.getId());
+
+        int result = stepWithRetry(stmt, "updateQuestion");
         finalizeStatement(stmt);
 
         return result == SQLITE_DONE;
@@ -1220,7 +2129,7 @@ bool DatabaseManager::deleteQuestion(int questionId)
     {
         sqlite3_bind_int(stmt, 1, questionId);
 
-        int result = sqlite3_step(stmt);
+        int result = stepWithRetry(stmt, "deleteQuestion");
         finalizeStatement(stmt);
 
         return result == SQLITE_DONE;
@@ -1231,45 +2140,16 @@ bool DatabaseManager::deleteQuestion(int questionId)
 
 vector<Question> DatabaseManager::getQuestionsBySubject(const string &subject)
 {
-    const char *sql = R"(
-        SELECT id, subject, question_text, option1, option2, option3, option4, 
-               correct_answer, difficulty, explanation, is_active 
-        FROM questions WHERE subject = ? AND is_active = 1;
-    )";
+    static const string sql = "SELECT " + EntityColumns::question.selectList() +
+                              " FROM questions WHERE subject = ? AND is_active = 1;";
 
     sqlite3_stmt *stmt = prepareStatement(sql);
     vector<Question> questions;
 
     if (stmt)
     {
-        sqlite3_bind_text(stmt, 1, subject.c_str(), -1, SQLITE_TRANSIENT);
-
-        while (sqlite3_step(stmt) == SQLITE_ROW)
-        {
-            Question question;
-            question.setId(sqlite3_column_int(stmt, 0));
-            question.setSubject(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1)));
-            question.setQuestionText(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2)));
-
-            vector<string> options = {
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 5)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 6))};
-            question.setOptions(options);
-            question.setCorrectAnswer(sqlite3_column_int(stmt, 7));
-            question.setDifficulty(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 8)));
-
-            const char *explanation = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 9));
-            if (explanation)
-            {
-                question.setExplanation(explanation);
-            }
-
-            question.setIsActive(sqlite3_column_int(stmt, 10) == 1);
-            questions.push_back(question);
-        }
-
+        bindValue(stmt, 1, SUBJECT_CODES.code(subject));
+        questions = readRows<Question>(stmt, EntityColumns::question, "getQuestionsBySubject");
         finalizeStatement(stmt);
     }
 
@@ -1278,58 +2158,27 @@ vector<Question> DatabaseManager::getQuestionsBySubject(const string &subject)
 
 vector<Question> DatabaseManager::getQuestionsByDifficulty(const string &difficulty)
 {
-    const char *sql = R"(
-        SELECT id, subject, question_text, option1, option2, option3, option4, 
-               correct_answer, difficulty, explanation, is_active 
-        FROM questions WHERE difficulty = ? AND is_active = 1;
-    )";
+    static const string sql = "SELECT " + EntityColumns::question.selectList() +
+                              " FROM questions WHERE difficulty = ? AND is_active = 1;";
 
     sqlite3_stmt *stmt = prepareStatement(sql);
     vector<Question> questions;
 
     if (stmt)
     {
-        sqlite3_bind_text(stmt, 1, difficulty.c_str(), -1, SQLITE_TRANSIENT);
-
-        while (sqlite3_step(stmt) == SQLITE_ROW)
-        {
-            Question question;
-            question.setId(sqlite3_column_int(stmt, 0));
-            question.setSubject(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1)));
-            question.setQuestionText(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2)));
-
-            vector<string> options = {
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 5)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 6))};
-            question.setOptions(options);
-            question.setCorrectAnswer(sqlite3_column_int(stmt, 7));
-            question.setDifficulty(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 8)));
-
-            const char *explanation = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 9));
-            if (explanation)
-            {
-                question.setExplanation(explanation);
-            }
-
-            question.setIsActive(sqlite3_column_int(stmt, 10) == 1);
-            questions.push_back(question);
-        }
-
-        finalizeStatement(stmt);
-    }
+        bindValue(stmt, 1, DIFFICULTY_CODES.code(difficulty));
+        questions = readRows<Question>(stmt, EntityColumns::question, "getQuestionsByDifficulty");
+        finalizeStatement(stmt);
+    }
 
     return questions;
 }
 
 vector<Question> DatabaseManager::searchQuestions(const string &keyword)
 {
-    const char *sql = R"(
-        SELECT id, subject, question_text, option1, option2, option3, option4, 
-               correct_answer, difficulty, explanation, is_active 
-        FROM questions 
-        WHERE (question_text LIKE ? OR subject LIKE ? OR explanation LIKE ?) 
+    static const string sql = "SELECT " + EntityColumns::question.selectList() + R"(
+        FROM questions
+        WHERE (question_text LIKE ? OR ((1 << subject) & ?) != 0 OR explanation LIKE ?)
         AND is_active = 1;
     )";
 
@@ -1338,145 +2187,426 @@ vector<Question> DatabaseManager::searchQuestions(const string &keyword)
 
     if (stmt)
     {
+        // Subjects are stored as codes: match the keyword against the subject
+        // names here (case-insensitive, like LIKE) and pass the hits as a bit mask
+        string lowerKeyword = keyword;
+        transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), ::tolower);
+        int subjectMask = 0;
+        for (const auto &entry : SUBJECT_CODES)
+        {
+            string name = entry.name;
+            transform(name.begin(), name.end(), name.begin(), ::tolower);
+            if (entry.code != Subject::NONE && name.find(lowerKeyword) != string::npos)
+            {
+                subjectMask |= 1 << static_cast<int>(entry.code);
+            }
+        }
+
         string searchPattern = "%" + keyword + "%";
         sqlite3_bind_text(stmt, 1, searchPattern.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 2, searchPattern.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 2, subjectMask);
         sqlite3_bind_text(stmt, 3, searchPattern.c_str(), -1, SQLITE_TRANSIENT);
 
-        while (sqlite3_step(stmt) == SQLITE_ROW)
+        questions = readRows<Question>(stmt, EntityColumns::question, "searchQuestions");
+        finalizeStatement(stmt);
+    }
+
+    return questions;
+}
+
+// Distinct trigrams of a lower-cased search term, in order of appearance
+static vector<string> trigramsOf(const string &term)
+{
+    vector<string> trigrams;
+    for (size_t i = 0; i + 3 <= term.size(); ++i)
+    {
+        string trigram = term.substr(i, 3);
+        if (find(trigrams.begin(), trigrams.end(), trigram) == trigrams.end())
         {
-            Question question;
-            question.setId(sqlite3_column_int(stmt, 0));
-            question.setSubject(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1)));
-            question.setQuestionText(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2)));
-
-            vector<string> options = {
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 4)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 5)),
-                reinterpret_cast<const char *>(sqlite3_column_text(stmt, 6))};
-            question.setOptions(options);
-            question.setCorrectAnswer(sqlite3_column_int(stmt, 7));
-            question.setDifficulty(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 8)));
-
-            const char *explanation = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 9));
-            if (explanation)
+            trigrams.push_back(trigram);
+        }
+    }
+    return trigrams;
+}
+
+// FTS5 string literal: the term is matched as text, never as query syntax
+static string ftsPhrase(const string &text)
+{
+    string phrase = "\"";
+    for (char c : text)
+    {
+        phrase += c;
+        if (c == '"')
+            phrase += '"';
+    }
+    return phrase + "\"";
+}
+
+// LIKE pattern for the text anywhere in a field; its own % and _ (and the
+// escape character) are matched literally, with ESCAPE '\'
+static string likeSubstring(const string &text)
+{
+    string pattern = "%";
+    for (char c : text)
+    {
+        if (c == '%' || c == '_' || c == '\\')
+            pattern += '\\';
+        pattern += c;
+    }
+    return pattern + "%";
+}
+
+// Relevance of one field to the term: whole-field, prefix and substring
+// matches outrank near misses, which score the share of the term's
+// trigrams the field contains (0..1)
+static double userFieldScore(const string &field, const string &term, const vector<string> &trigrams)
+{
+    string lower = Utils::toLower(field);
+    size_t pos = lower.find(term);
+    if (pos != string::npos)
+    {
+        return lower.size() == term.size() ? 4.0 : (pos == 0 ? 3.0 : 2.0);
+    }
+    if (trigrams.empty())
+    {
+        return 0.0;
+    }
+
+    size_t shared = 0;
+    for (const auto &trigram : trigrams)
+    {
+        if (lower.find(trigram) != string::npos)
+            shared++;
+    }
+    return static_cast<double>(shared) / trigrams.size();
+}
+
+vector<User> DatabaseManager::searchUsers(const string &keyword, size_t limit)
+{
+    // Rows fetched per phase before ranking
+    const int SEARCH_CANDIDATES = 200;
+    // Near misses must share at least this share of the term's trigrams
+    const double MIN_NEAR_MISS_SCORE = 0.5;
+
+    vector<User> candidates;
+    string term = Utils::toLower(Utils::trim(keyword));
+    if (term.empty() || limit == 0)
+    {
+        return candidates;
+    }
+    vector<string> trigrams = trigramsOf(term);
+
+    // ?1 is the pattern, ?2 the row cap and ?3 the term as typed
+    string typed = Utils::trim(keyword);
+    auto fetch = [&](const string &sql, const string &pattern)
+    {
+        sqlite3_stmt *stmt = prepareStatement(sql);
+        if (!stmt)
+            return;
+        sqlite3_bind_text(stmt, 1, pattern.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 2, SEARCH_CANDIDATES);
+        sqlite3_bind_text(stmt, 3, typed.c_str(), -1, SQLITE_TRANSIENT);
+        vector<User> rows = readRows<User>(stmt, EntityColumns::user, "searchUsers");
+        finalizeStatement(stmt);
+        candidates.insert(candidates.end(), make_move_iterator(rows.begin()), make_move_iterator(rows.end()));
+    };
+
+    // Exact username/email first, through their own indexes, so a full match
+    // is never crowded out of the candidate cap
+    static const string exactSql = "SELECT " + EntityColumns::user.selectList() +
+                                   " FROM users WHERE username IN (?1, ?3) OR email IN (?1, ?3) LIMIT ?2;";
+    fetch(exactSql, term);
+
+    if (trigrams.empty())
+    {
+        // Shorter than a trigram: the index cannot help, so only username
+        // and email prefixes match, as ranges over their NOCASE indexes
+        // (case-insensitive, like the trigram match)
+        static const string prefixSql =
+            "SELECT " + EntityColumns::user.selectList() +
+            " FROM users WHERE (username COLLATE NOCASE >= ?1 AND username COLLATE NOCASE < ?2)"
+            " OR (email COLLATE NOCASE >= ?1 AND email COLLATE NOCASE < ?2) LIMIT ?3;";
+        string upper = term;
+        upper.back() = static_cast<char>(upper.back() + 1);
+
+        sqlite3_stmt *stmt = prepareStatement(prefixSql);
+        if (stmt)
+        {
+            sqlite3_bind_text(stmt, 1, term.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 2, upper.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(stmt, 3, SEARCH_CANDIDATES);
+            vector<User> rows = readRows<User>(stmt, EntityColumns::user, "searchUsers");
+            finalizeStatement(stmt);
+            candidates.insert(candidates.end(), make_move_iterator(rows.begin()), make_move_iterator(rows.end()));
+        }
+    }
+    else
+    {
+        // A phrase of consecutive trigrams matches the term as a substring.
+        // Without the index a LIKE scan does (case-insensitive too, for ASCII).
+        static const string matchSql = "SELECT " + EntityColumns::user.selectList() +
+                                       " FROM users WHERE id IN (SELECT rowid FROM users_search"
+                                       " WHERE users_search MATCH ?1 LIMIT ?2);";
+        static const string likeSql = "SELECT " + EntityColumns::user.selectList() +
+                                      " FROM users WHERE username LIKE ?1 ESCAPE '\\' OR full_name LIKE ?1 ESCAPE '\\'"
+                                      " OR email LIKE ?1 ESCAPE '\\' LIMIT ?2;";
+        const string &substringSql = userSearchIndexed ? matchSql : likeSql;
+        auto substring = [this](const string &text)
+        { return userSearchIndexed ? ftsPhrase(text) : likeSubstring(text); };
+        size_t before = candidates.size();
+        fetch(substringSql, substring(term));
+
+        // Too few: allow typos. The term is cut into overlapping segments
+        // (three for long terms); an edit breaks at most the segments it
+        // falls in, so one typo (two for long terms) leaves a segment intact.
+        // Each segment is itself a selective substring match.
+        if (term.size() >= 4 && candidates.size() - before < limit)
+        {
+            size_t segments = term.size() >= 12 ? 3 : 2;
+            size_t step = term.size() / segments;
+            for (size_t k = 0; k < segments; ++k)
             {
-                question.setExplanation(explanation);
+                size_t start = k == 0 ? 0 : k * step - 1;
+                size_t end = k + 1 == segments ? term.size() : (k + 1) * step + 1;
+                if (end - start >= 3)
+                {
+                    fetch(substringSql, substring(term.substr(start, end - start)));
+                }
             }
-
-            question.setIsActive(sqlite3_column_int(stmt, 10) == 1);
-            questions.push_back(question);
         }
+    }
 
-        finalizeStatement(stmt);
+    // Rank: best field per user, then username
+    vector<pair<double, User>> ranked;
+    ranked.reserve(candidates.size());
+    sort(candidates.begin(), candidates.end(), [](const User &a, const User &b)
+         { return a.getId() < b.getId(); });
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        if (i > 0 && candidates[i].getId() == candidates[i - 1].getId())
+            continue;
+        const User &user = candidates[i];
+        double score = max({userFieldScore(user.getUsername(), term, trigrams),
+                            userFieldScore(user.getFullName(), term, trigrams),
+                            userFieldScore(user.getEmail(), term, trigrams)});
+        if (score >= MIN_NEAR_MISS_SCORE)
+        {
+            ranked.push_back({score, user});
+        }
     }
+    sort(ranked.begin(), ranked.end(), [](const pair<double, User> &a, const pair<double, User> &b)
+         { return a.first != b.first ? a.first > b.first : a.second.getUsername() < b.second.getUsername(); });
 
-    return questions;
+    vector<User> users;
+    for (size_t i = 0; i < ranked.size() && i < limit; ++i)
+    {
+        users.push_back(move(ranked[i].second));
+    }
+    return users;
 }
 
 vector<ExamResult> DatabaseManager::getAllExamResults()
 {
-    const char *sql = R"(
-        SELECT id, user_id, username, exam_template_id, score, total_questions, percentage, 
-               exam_date, start_time, end_time, duration, subject, exam_type, exam_name 
-        FROM exam_results ORDER BY exam_date DESC;
-    )";
+    static const string sql = "SELECT " + EntityColumns::examResult.selectList() +
+                              " FROM exam_results ORDER BY exam_date DESC;";
 
     sqlite3_stmt *stmt = prepareStatement(sql);
     vector<ExamResult> results;
 
     if (stmt)
     {
-        while (sqlite3_step(stmt) == SQLITE_ROW)
-        {
-            ExamResult result;
-            result.setId(sqlite3_column_int(stmt, 0));
-            result.setUserId(sqlite3_column_int(stmt, 1));
-            result.setUsername(reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2)));
-            result.setExamTemplateId(sqlite3_column_int(stmt, 3));
-            result.setScore(sqlite3_column_int(stmt, 4));
-            result.setTotalQuestions(sqlite3_column_int(stmt, 5));
-            // percentage is calculated automatically in setScore/setTotalQuestions
-
-            const char *examDate = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 7));
-            if (examDate)
-                result.setExamDate(examDate);
-
-            const char *startTime = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 8));
-            if (startTime)
-                result.setStartTime(startTime);
-
-            const char *endTime = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 9));
-            if (endTime)
-                result.setEndTime(endTime);
-
-            result.setDuration(sqlite3_column_int(stmt, 10));
-
-            const char *subject = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 11));
-            if (subject)
-                result.setSubject(subject);
-
-            const char *examType = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 12));
-            if (examType)
-                result.setExamType(examType);
-
-            const char *examName = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 13));
-            if (examName)
-                result.setTemplateName(examName);
-
-            results.push_back(result);
-        }
+        results = readRows<ExamResult>(stmt, EntityColumns::examResult, "getAllExamResults");
+        finalizeStatement(stmt);
+    }
+
+    return results;
+}
+
+vector<ExamResult> DatabaseManager::getExamResultsByDateRange(long long fromMs, long long toMs)
+{
+    // Half-open [fromMs, toMs) so consecutive weeks/terms never share a row
+    static const string sql = "SELECT " + EntityColumns::examResult.selectList() +
+                              " FROM exam_results WHERE exam_date >= ? AND exam_date < ? ORDER BY exam_date;";
+
+    sqlite3_stmt *stmt = prepareStatement(sql);
+    vector<ExamResult> results;
 
+    if (stmt)
+    {
+        sqlite3_bind_int64(stmt, 1, fromMs);
+        sqlite3_bind_int64(stmt, 2, toMs);
+        results = readRows<ExamResult>(stmt, EntityColumns::examResult, "getExamResultsByDateRange");
         finalizeStatement(stmt);
     }
 
     return results;
 }
 
+vector<ExamResult> DatabaseManager::getExamResultsByDateRange(const string &startDate, const string &endDate)
+{
+    long long fromMs = Utils::parseDateTime(startDate);
+    long long toMs = Utils::parseDateTime(endDate);
+    if (fromMs < 0 || toMs < 0)
+    {
+        logError("getExamResultsByDateRange", "invalid date range '" + startDate + "' - '" + endDate + "'");
+        return {};
+    }
+
+    // A date-only end includes that whole day
+    if (endDate.size() <= 10)
+    {
+        toMs = Utils::parseDateTime(endDate + " 23:59:59") + 1000;
+    }
+
+    return getExamResultsByDateRange(fromMs, toMs);
+}
+
 // Exam Template Management Methods
 
+// Snapshot of exam_templates; never modified after it is published
+struct TemplateCatalog {
+    vector<ExamTemplate> templates;  // ORDER BY created_at DESC
+    vector<size_t> active;           // Active ones by exam_type, subject, created_at DESC
+    HashTable<int, size_t> byId;     // Template id -> index in templates
+};
+
+// The catalog and the papers are dropped by this process's own writes; this
+// catches writes from other processes (another terminal on the same
+// database), up to VERSION_CHECK_INTERVAL_MS late. Between checks a hit is
+// one relaxed atomic load; a check steps the kept data_version statement,
+// and the version counter is only read after another connection committed.
+// A reader that finds a check already running serves the snapshot it has.
+void DatabaseManager::dropCachesIfChangedElsewhere() {
+    if (!isConnected) return;
+
+    long long now = chrono::duration_cast<chrono::milliseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+    if (now < nextVersionCheckMs.load(memory_order_relaxed)) return;
+
+    long long catalogVersion;
+    {
+        unique_lock<mutex> lock(versionMutex, try_to_lock);
+        if (!lock.owns_lock() || now < nextVersionCheckMs.load(memory_order_relaxed)) return;
+        nextVersionCheckMs.store(now + VERSION_CHECK_INTERVAL_MS, memory_order_relaxed);
+
+        if (!dataVersionStmt) dataVersionStmt = prepareStatement("PRAGMA data_version;");
+        if (!dataVersionStmt) return;
+        long long dataVersion = seenDataVersion;
+        if (stepWithRetry(dataVersionStmt, "dataVersion") == SQLITE_ROW) {
+            dataVersion = sqlite3_column_int64(dataVersionStmt, 0);
+        }
+        sqlite3_reset(dataVersionStmt);
+        if (dataVersion == seenDataVersion) return;
+        seenDataVersion = dataVersion;
+
+        sqlite3_stmt* stmt = prepareStatement("SELECT version FROM exam_catalog_version WHERE id = 1;");
+        if (!stmt) return;
+        catalogVersion = seenCatalogVersion;
+        if (stepWithRetry(stmt, "catalogVersion") == SQLITE_ROW) {
+            catalogVersion = sqlite3_column_int64(stmt, 0);
+        }
+        finalizeStatement(stmt);
+        if (catalogVersion == seenCatalogVersion) return;
+        bool first = seenCatalogVersion < 0;
+        seenCatalogVersion = catalogVersion;
+        if (first) return;
+    }
+
+    invalidateTemplateCatalog();
+    lock_guard<mutex> lock(paperLoadMutex);
+    if (paperCache.getSize() > 0) {
+        paperCache.clear();
+        paperInvalidations++;
+    }
+}
+
+shared_ptr<const TemplateCatalog> DatabaseManager::getTemplateCatalog() {
+    dropCachesIfChangedElsewhere();
+    shared_ptr<const TemplateCatalog> catalog = atomic_load(&templateCatalog);
+    if (catalog) {
+        catalogHits++;
+        return catalog;
+    }
+
+    lock_guard<mutex> lock(catalogMutex);
+    catalog = atomic_load(&templateCatalog);
+    if (catalog) {
+        catalogHits++;
+        return catalog;
+    }
+
+    auto loaded = make_shared<TemplateCatalog>();
+    if (!isConnected) return loaded;
+
+    static const string sql = "SELECT " + EntityColumns::examTemplate.selectList() +
+                              " FROM exam_templates ORDER BY created_at DESC";
+
+    sqlite3_stmt* stmt = prepareStatement(sql);
+    if (!stmt) return loaded;
+
+    bool complete = false;
+    loaded->templates = readRows<ExamTemplate>(stmt, EntityColumns::examTemplate, "getTemplateCatalog", &complete);
+    finalizeStatement(stmt);
+
+    for (size_t i = 0; i < loaded->templates.size(); ++i) {
+        loaded->byId.insert(loaded->templates[i].getId(), i);
+        if (loaded->templates[i].getIsActive()) loaded->active.push_back(i);
+    }
+    // Stable, so created_at DESC is kept within each (exam_type, subject)
+    stable_sort(loaded->active.begin(), loaded->active.end(), [&loaded](size_t a, size_t b) {
+        const ExamTemplate& x = loaded->templates[a];
+        const ExamTemplate& y = loaded->templates[b];
+        if (x.getExamType() != y.getExamType()) return x.getExamType() < y.getExamType();
+        return x.getSubjectCode() < y.getSubjectCode();
+    });
+
+    catalogLoads++;
+    // A scan cut short (e.g. busy) is served once but not cached
+    if (complete) {
+        atomic_store(&templateCatalog, shared_ptr<const TemplateCatalog>(loaded));
+    }
+    return loaded;
+}
+
+void DatabaseManager::invalidateTemplateCatalog() {
+    // Waits for an in-flight load, so a snapshot read before the write
+    // can never be published after it
+    lock_guard<mutex> lock(catalogMutex);
+    atomic_store(&templateCatalog, shared_ptr<const TemplateCatalog>());
+    catalogInvalidations++;
+}
+
+CatalogStats DatabaseManager::getCatalogStats() const {
+    CatalogStats stats;
+    stats.loads = catalogLoads;
+    stats.hits = catalogHits;
+    stats.invalidations = catalogInvalidations;
+    shared_ptr<const TemplateCatalog> catalog = atomic_load(&templateCatalog);
+    stats.templates = catalog ? static_cast<int>(catalog->templates.size()) : 0;
+    return stats;
+}
+
 bool DatabaseManager::insertExamTemplate(const ExamTemplate& examTemplate) {
     if (!isConnected) return false;
-    
-    const char* sql = R"(
-        INSERT INTO exam_templates (
-            template_name, exam_type, subject, question_count, time_limit, 
-            difficulty, passing_percentage, negative_marking, negative_mark_value,
-            shuffle_questions, shuffle_options, allow_review, auto_submit,
-            instructions, created_by, is_active
-        ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-    )";
-    
+
+    static const string sql = "INSERT INTO exam_templates (" + EntityColumns::examTemplateInsert.selectList() +
+                              ") VALUES (" + EntityColumns::examTemplateInsert.placeholderList() + ")";
+
     sqlite3_stmt* stmt = prepareStatement(sql);
     if (!stmt) {
         logError("insertExamTemplate", "Failed to prepare statement");
         return false;
     }
-    
-    sqlite3_bind_text(stmt, 1, examTemplate.getTemplateName().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, examTemplate.getExamTypeString().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, examTemplate.getSubject().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt, 4, examTemplate.getQuestionCount());
-    sqlite3_bind_int(stmt, 5, examTemplate.getTimeLimit());
-    sqlite3_bind_text(stmt, 6, examTemplate.getDifficulty().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_double(stmt, 7, examTemplate.getPassingPercentage());
-    sqlite3_bind_int(stmt, 8, examTemplate.hasNegativeMarking() ? 1 : 0);
-    sqlite3_bind_double(stmt, 9, examTemplate.getNegativeMarkValue());
-    sqlite3_bind_int(stmt, 10, examTemplate.shouldShuffleQuestions() ? 1 : 0);
-    sqlite3_bind_int(stmt, 11, examTemplate.shouldShuffleOptions() ? 1 : 0);
-    sqlite3_bind_int(stmt, 12, examTemplate.isReviewAllowed() ? 1 : 0);
-    sqlite3_bind_int(stmt, 13, examTemplate.isAutoSubmit() ? 1 : 0);
-    sqlite3_bind_text(stmt, 14, examTemplate.getInstructions().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt, 15, examTemplate.getCreatedBy());
-    sqlite3_bind_int(stmt, 16, examTemplate.getIsActive() ? 1 : 0);
-    
-    int result = sqlite3_step(stmt);
+
+    EntityColumns::examTemplateInsert.bind(stmt, examTemplate);
+
+    int result = stepWithRetry(stmt, "insertExamTemplate");
     finalizeStatement(stmt);
-    
+
     if (result == SQLITE_DONE) {
         // Store the last inserted row ID for retrieval
         lastInsertedExamTemplateId = sqlite3_last_insert_rowid(db);
+        invalidateTemplateCatalog();
         return true;
     } else {
         logError("insertExamTemplate", sqlite3_errmsg(db));
@@ -1486,37 +2616,23 @@ bool DatabaseManager::insertExamTemplate(const ExamTemplate& examTemplate) {
 
 bool DatabaseManager::updateExamTemplate(const ExamTemplate& examTemplate) {
     if (!isConnected) return false;
-    
-    const char* sql = R"(
-        UPDATE exam_templates SET 
-            template_name = ?, exam_type = ?, subject = ?,
-            time_limit = ?, passing_percentage = ?,
-            negative_marking = ?, negative_mark_value = ?, shuffle_questions = ?,
-            shuffle_options = ?, allow_review = ?, auto_submit = ?,
-            instructions = ?, updated_at = CURRENT_TIMESTAMP
-        WHERE id = ?
-    )";
-    
+
+    static const string sql = "UPDATE exam_templates SET " + EntityColumns::examTemplateUpdate.assignmentList() +
+                              ", updated_at = CURRENT_TIMESTAMP WHERE id = ?";
+
     sqlite3_stmt* stmt = prepareStatement(sql);
     if (!stmt) return false;
-    
-    sqlite3_bind_text(stmt, 1, examTemplate.getTemplateName().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, examTemplate.getExamTypeString().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, examTemplate.getSubject().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt, 4, examTemplate.getTimeLimit());
-    sqlite3_bind_double(stmt, 5, examTemplate.getPassingPercentage());
-    sqlite3_bind_int(stmt, 6, examTemplate.hasNegativeMarking() ? 1 : 0);
-    sqlite3_bind_double(stmt, 7, examTemplate.getNegativeMarkValue());
-    sqlite3_bind_int(stmt, 8, examTemplate.shouldShuffleQuestions() ? 1 : 0);
-    sqlite3_bind_int(stmt, 9, examTemplate.shouldShuffleOptions() ? 1 : 0);
-    sqlite3_bind_int(stmt, 10, examTemplate.isReviewAllowed() ? 1 : 0);
-    sqlite3_bind_int(stmt, 11, examTemplate.isAutoSubmit() ? 1 : 0);
-    sqlite3_bind_text(stmt, 12, examTemplate.getInstructions().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt, 13, examTemplate.getId());
-    
-    int result = sqlite3_step(stmt);
+
+    EntityColumns::examTemplateUpdate.bind(stmt, examTemplate);
+    sqlite3_bind_int(stmt, EntityColumns::examTemplateUpdate.columnCount() + 1, examTemplate.getId());
+
+    int result = stepWithRetry(stmt, "updateExamTemplate");
     finalizeStatement(stmt);
-    return result == SQLITE_DONE;
+    if (result != SQLITE_DONE) return false;
+
+    invalidateTemplateCatalog();
+    invalidateExamPaper(examTemplate.getId());  // Papers carry the subject and difficulty
+    return true;
 }
 
 bool DatabaseManager::deleteExamTemplate(int templateId) {
@@ -1527,281 +2643,55 @@ bool DatabaseManager::deleteExamTemplate(int templateId) {
     if (!stmt) return false;
     
     sqlite3_bind_int(stmt, 1, templateId);
-    int result = sqlite3_step(stmt);
+    int result = stepWithRetry(stmt, "deleteExamTemplate");
     finalizeStatement(stmt);
-    return result == SQLITE_DONE;
+    if (result != SQLITE_DONE) return false;
+
+    invalidateTemplateCatalog();
+    invalidateExamPaper(templateId);
+    return true;
 }
 
 ExamTemplate DatabaseManager::getExamTemplateById(int templateId) {
-    ExamTemplate examTemplate;
-    if (!isConnected) return examTemplate;
-    
-    const char* sql = R"(
-        SELECT id, template_name, exam_type, subject, time_limit,
-               passing_percentage, negative_marking, negative_mark_value,
-               shuffle_questions, shuffle_options, allow_review, auto_submit,
-               instructions, created_by, created_at, updated_at, is_active
-        FROM exam_templates WHERE id = ?
-    )";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return examTemplate;
-    
-    sqlite3_bind_int(stmt, 1, templateId);
-    
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        examTemplate.setId(sqlite3_column_int(stmt, 0));
-        
-        const char* templateName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        if (templateName) examTemplate.setTemplateName(templateName);
-        
-        const char* examType = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        if (examType) examTemplate.setExamTypeFromString(examType);
-        
-        const char* subject = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        if (subject) examTemplate.setSubject(subject);
-        
-        examTemplate.setTimeLimit(sqlite3_column_int(stmt, 4));
-        examTemplate.setPassingPercentage(sqlite3_column_double(stmt, 5));
-        examTemplate.setNegativeMarking(sqlite3_column_int(stmt, 6) == 1);
-        examTemplate.setNegativeMarkValue(sqlite3_column_double(stmt, 7));
-        examTemplate.setShuffleQuestions(sqlite3_column_int(stmt, 8) == 1);
-        examTemplate.setShuffleOptions(sqlite3_column_int(stmt, 9) == 1);
-        examTemplate.setAllowReview(sqlite3_column_int(stmt, 10) == 1);
-        examTemplate.setAutoSubmit(sqlite3_column_int(stmt, 11) == 1);
-        
-        const char* instructions = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 12));
-        if (instructions) examTemplate.setInstructions(instructions);
-        
-        examTemplate.setCreatedBy(sqlite3_column_int(stmt, 13));
-        
-        const char* createdAt = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 14));
-        if (createdAt) examTemplate.setCreatedAt(createdAt);
-        
-        const char* updatedAt = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 15));
-        if (updatedAt) examTemplate.setUpdatedAt(updatedAt);
-        
-        examTemplate.setIsActive(sqlite3_column_int(stmt, 16) == 1);
-    }
-    
-    finalizeStatement(stmt);
-    return examTemplate;
+    shared_ptr<const TemplateCatalog> catalog = getTemplateCatalog();
+    const size_t* index = catalog->byId.find(templateId);
+    return index ? catalog->templates[*index] : ExamTemplate();
 }
 
 vector<ExamTemplate> DatabaseManager::getAllExamTemplates() {
-    vector<ExamTemplate> templates;
-    if (!isConnected) return templates;
-    
-    const char* sql = R"(
-        SELECT id, template_name, exam_type, subject, time_limit,
-               passing_percentage, negative_marking, negative_mark_value,
-               shuffle_questions, shuffle_options, allow_review, auto_submit,
-               instructions, created_by, created_at, updated_at, is_active
-        FROM exam_templates ORDER BY created_at DESC
-    )";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return templates;
-    
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        ExamTemplate examTemplate;
-        examTemplate.setId(sqlite3_column_int(stmt, 0));
-        
-        const char* templateName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        if (templateName) examTemplate.setTemplateName(templateName);
-        
-        const char* examType = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        if (examType) examTemplate.setExamTypeFromString(examType);
-        
-        const char* subject = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        if (subject) examTemplate.setSubject(subject);
-        
-        examTemplate.setTimeLimit(sqlite3_column_int(stmt, 4));
-        examTemplate.setPassingPercentage(sqlite3_column_double(stmt, 5));
-        examTemplate.setNegativeMarking(sqlite3_column_int(stmt, 6) == 1);
-        examTemplate.setNegativeMarkValue(sqlite3_column_double(stmt, 7));
-        examTemplate.setShuffleQuestions(sqlite3_column_int(stmt, 8) == 1);
-        examTemplate.setShuffleOptions(sqlite3_column_int(stmt, 9) == 1);
-        examTemplate.setAllowReview(sqlite3_column_int(stmt, 10) == 1);
-        examTemplate.setAutoSubmit(sqlite3_column_int(stmt, 11) == 1);
-        
-        const char* instructions = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 12));
-        if (instructions) examTemplate.setInstructions(instructions);
-        
-        examTemplate.setCreatedBy(sqlite3_column_int(stmt, 13));
-        
-        const char* createdAt = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 14));
-        if (createdAt) examTemplate.setCreatedAt(createdAt);
-        
-        const char* updatedAt = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 15));
-        if (updatedAt) examTemplate.setUpdatedAt(updatedAt);
-        
-        examTemplate.setIsActive(sqlite3_column_int(stmt, 16) == 1);
-        
-        templates.push_back(examTemplate);
-    }
-    
-    finalizeStatement(stmt);
-    return templates;
+    return getTemplateCatalog()->templates;
 }
 
 vector<ExamTemplate> DatabaseManager::getExamTemplatesByType(const string& examType) {
+    shared_ptr<const TemplateCatalog> catalog = getTemplateCatalog();
+    ExamType type = EXAM_TYPE_CODES.code(examType);
+
     vector<ExamTemplate> templates;
-    if (!isConnected) return templates;
-    
-    const char* sql = R"(
-        SELECT id, template_name, exam_type, subject, question_count, time_limit,
-               difficulty, passing_percentage, negative_marking, negative_mark_value,
-               shuffle_questions, shuffle_options, allow_review, auto_submit,
-               instructions, created_by, created_at, updated_at, is_active
-        FROM exam_templates WHERE exam_type = ? ORDER BY created_at DESC
-    )";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return templates;
-    
-    sqlite3_bind_text(stmt, 1, examType.c_str(), -1, SQLITE_TRANSIENT);
-    
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        ExamTemplate examTemplate;
-        examTemplate.setId(sqlite3_column_int(stmt, 0));
-        
-        const char* templateName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        if (templateName) examTemplate.setTemplateName(templateName);
-        
-        const char* type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        if (type) examTemplate.setExamTypeFromString(type);
-        
-        const char* subject = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        if (subject) examTemplate.setSubject(subject);
-        
-        examTemplate.setQuestionCount(sqlite3_column_int(stmt, 4));
-        examTemplate.setTimeLimit(sqlite3_column_int(stmt, 5));
-        
-        const char* difficulty = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6));
-        if (difficulty) examTemplate.setDifficulty(difficulty);
-        
-        examTemplate.setPassingPercentage(sqlite3_column_double(stmt, 7));
-        examTemplate.setNegativeMarking(sqlite3_column_int(stmt, 8) == 1);
-        examTemplate.setNegativeMarkValue(sqlite3_column_double(stmt, 9));
-        examTemplate.setShuffleQuestions(sqlite3_column_int(stmt, 10) == 1);
-        examTemplate.setShuffleOptions(sqlite3_column_int(stmt, 11) == 1);
-        examTemplate.setAllowReview(sqlite3_column_int(stmt, 12) == 1);
-        examTemplate.setAutoSubmit(sqlite3_column_int(stmt, 13) == 1);
-        
-        const char* instructions = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 14));
-        if (instructions) examTemplate.setInstructions(instructions);
-        
-        examTemplate.setCreatedBy(sqlite3_column_int(stmt, 15));
-        examTemplate.setIsActive(sqlite3_column_int(stmt, 18) == 1);
-        
-        templates.push_back(examTemplate);
+    for (const auto& examTemplate : catalog->templates) {
+        if (examTemplate.getExamType() == type) templates.push_back(examTemplate);
     }
-    
-    finalizeStatement(stmt);
     return templates;
 }
 
 vector<ExamTemplate> DatabaseManager::getExamTemplatesBySubject(const string& subject) {
+    shared_ptr<const TemplateCatalog> catalog = getTemplateCatalog();
+    Subject code = SUBJECT_CODES.code(subject);
+
     vector<ExamTemplate> templates;
-    if (!isConnected) return templates;
-    
-    const char* sql = R"(
-        SELECT id, template_name, exam_type, subject, question_count, time_limit,
-               difficulty, passing_percentage, instructions, is_active
-        FROM exam_templates WHERE subject = ? AND is_active = 1 ORDER BY exam_type, created_at DESC
-    )";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return templates;
-    
-    sqlite3_bind_text(stmt, 1, subject.c_str(), -1, SQLITE_TRANSIENT);
-    
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        ExamTemplate examTemplate;
-        examTemplate.setId(sqlite3_column_int(stmt, 0));
-        
-        const char* templateName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        if (templateName) examTemplate.setTemplateName(templateName);
-        
-        const char* type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        if (type) examTemplate.setExamTypeFromString(type);
-        
-        const char* subj = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        if (subj) examTemplate.setSubject(subj);
-        
-        examTemplate.setQuestionCount(sqlite3_column_int(stmt, 4));
-        examTemplate.setTimeLimit(sqlite3_column_int(stmt, 5));
-        
-        const char* difficulty = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6));
-        if (difficulty) examTemplate.setDifficulty(difficulty);
-        
-        examTemplate.setPassingPercentage(sqlite3_column_double(stmt, 7));
-        
-        const char* instructions = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 8));
-        if (instructions) examTemplate.setInstructions(instructions);
-        
-        examTemplate.setIsActive(sqlite3_column_int(stmt, 9) == 1);
-        
-        templates.push_back(examTemplate);
+    for (size_t index : catalog->active) {
+        if (catalog->templates[index].getSubjectCode() == code) templates.push_back(catalog->templates[index]);
     }
-    
-    finalizeStatement(stmt);
     return templates;
 }
 
 vector<ExamTemplate> DatabaseManager::getActiveExamTemplates() {
+    shared_ptr<const TemplateCatalog> catalog = getTemplateCatalog();
+
     vector<ExamTemplate> templates;
-    if (!isConnected) return templates;
-    
-    const char* sql = R"(
-        SELECT id, template_name, exam_type, subject, question_count, time_limit,
-               difficulty, passing_percentage, negative_marking, negative_mark_value,
-               shuffle_questions, shuffle_options, allow_review, auto_submit,
-               instructions, created_by, is_active
-        FROM exam_templates WHERE is_active = 1 ORDER BY exam_type, subject, created_at DESC
-    )";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return templates;
-    
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        ExamTemplate examTemplate;
-        examTemplate.setId(sqlite3_column_int(stmt, 0));
-        
-        const char* templateName = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        if (templateName) examTemplate.setTemplateName(templateName);
-        
-        const char* type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        if (type) examTemplate.setExamTypeFromString(type);
-        
-        const char* subject = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        if (subject) examTemplate.setSubject(subject);
-        
-        examTemplate.setQuestionCount(sqlite3_column_int(stmt, 4));
-        examTemplate.setTimeLimit(sqlite3_column_int(stmt, 5));
-        
-        const char* difficulty = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6));
-        if (difficulty) examTemplate.setDifficulty(difficulty);
-        
-        examTemplate.setPassingPercentage(sqlite3_column_double(stmt, 7));
-        examTemplate.setNegativeMarking(sqlite3_column_int(stmt, 8) == 1);
-        examTemplate.setNegativeMarkValue(sqlite3_column_double(stmt, 9));
-        examTemplate.setShuffleQuestions(sqlite3_column_int(stmt, 10) == 1);
-        examTemplate.setShuffleOptions(sqlite3_column_int(stmt, 11) == 1);
-        examTemplate.setAllowReview(sqlite3_column_int(stmt, 12) == 1);
-        examTemplate.setAutoSubmit(sqlite3_column_int(stmt, 13) == 1);
-        
-        const char* instructions = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 14));
-        if (instructions) examTemplate.setInstructions(instructions);
-        
-        examTemplate.setCreatedBy(sqlite3_column_int(stmt, 15));
-        examTemplate.setIsActive(sqlite3_column_int(stmt, 16) == 1);
-        
-        templates.push_back(examTemplate);
+    templates.reserve(catalog->active.size());
+    for (size_t index : catalog->active) {
+        templates.push_back(catalog->templates[index]);
     }
-    
-    finalizeStatement(stmt);
     return templates;
 }
 
@@ -1813,9 +2703,12 @@ bool DatabaseManager::activateExamTemplate(int templateId) {
     if (!stmt) return false;
     
     sqlite3_bind_int(stmt, 1, templateId);
-    int result = sqlite3_step(stmt);
+    int result = stepWithRetry(stmt, "activateExamTemplate");
     finalizeStatement(stmt);
-    return result == SQLITE_DONE;
+    if (result != SQLITE_DONE) return false;
+
+    invalidateTemplateCatalog();
+    return true;
 }
 
 bool DatabaseManager::deactivateExamTemplate(int templateId) {
@@ -1826,135 +2719,101 @@ bool DatabaseManager::deactivateExamTemplate(int templateId) {
     if (!stmt) return false;
     
     sqlite3_bind_int(stmt, 1, templateId);
-    int result = sqlite3_step(stmt);
+    int result = stepWithRetry(stmt, "deactivateExamTemplate");
     finalizeStatement(stmt);
-    return result == SQLITE_DONE;
+    if (result != SQLITE_DONE) return false;
+
+    invalidateTemplateCatalog();
+    return true;
 }
 // Exam Question Management Methods (for direct exam creation)
 
 bool DatabaseManager::insertExamQuestion(const ExamQuestion& question) {
     if (!isConnected) return false;
-    
-    const char* sql = R"(
-        INSERT INTO exam_questions (
-            exam_template_id, question_number, question_text, 
-            option1, option2, option3, option4, correct_answer, explanation
-        ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)
-    )";
-    
+
+    static const string sql = "INSERT INTO exam_questions (" + EntityColumns::examQuestionInsert.selectList() +
+                              ") VALUES (" + EntityColumns::examQuestionInsert.placeholderList() + ")";
+
     sqlite3_stmt* stmt = prepareStatement(sql);
     if (!stmt) {
         logError("insertExamQuestion", "Failed to prepare statement");
         return false;
     }
-    
-    sqlite3_bind_int(stmt, 1, question.getExamTemplateId());
-    sqlite3_bind_int(stmt, 2, question.getQuestionNumber());
-    sqlite3_bind_text(stmt, 3, question.getQuestionText().c_str(), -1, SQLITE_TRANSIENT);
-    
-    auto options = question.getOptions();
-    sqlite3_bind_text(stmt, 4, options[0].c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 5, options[1].c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 6, options[2].c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 7, options[3].c_str(), -1, SQLITE_TRANSIENT);
-    
-    sqlite3_bind_int(stmt, 8, question.getCorrectAnswer());
-    sqlite3_bind_text(stmt, 9, question.getExplanation().c_str(), -1, SQLITE_TRANSIENT);
-    
-    int result = sqlite3_step(stmt);
+
+    EntityColumns::examQuestionInsert.bind(stmt, question);
+
+    int result = stepWithRetry(stmt, "insertExamQuestion");
     if (result != SQLITE_DONE) {
         logError("insertExamQuestion", sqlite3_errmsg(db));
     }
-    
+
     finalizeStatement(stmt);
-    return result == SQLITE_DONE;
+    if (result != SQLITE_DONE) return false;
+
+    invalidateExamPaper(question.getExamTemplateId());
+    return true;
 }
 
 bool DatabaseManager::updateExamQuestion(const ExamQuestion& question) {
     if (!isConnected) return false;
-    
-    const char* sql = R"(
-        UPDATE exam_questions SET 
-            question_number = ?, question_text = ?, option1 = ?, option2 = ?,
-            option3 = ?, option4 = ?, correct_answer = ?, explanation = ?
-        WHERE id = ?
-    )";
-    
+
+    // RETURNING names the paper to drop even if the caller's copy lacks it
+    static const string sql = "UPDATE exam_questions SET " + EntityColumns::examQuestionUpdate.assignmentList() +
+                              " WHERE id = ? RETURNING exam_template_id";
+
     sqlite3_stmt* stmt = prepareStatement(sql);
     if (!stmt) return false;
-    
-    sqlite3_bind_int(stmt, 1, question.getQuestionNumber());
-    sqlite3_bind_text(stmt, 2, question.getQuestionText().c_str(), -1, SQLITE_TRANSIENT);
-    
-    auto options = question.getOptions();
-    sqlite3_bind_text(stmt, 3, options[0].c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 4, options[1].c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 5, options[2].c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 6, options[3].c_str(), -1, SQLITE_TRANSIENT);
-    
-    sqlite3_bind_int(stmt, 7, question.getCorrectAnswer());
-    sqlite3_bind_text(stmt, 8, question.getExplanation().c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_int(stmt, 9, question.getId());
-    
-    int result = sqlite3_step(stmt);
+
+    EntityColumns::examQuestionUpdate.bind(stmt, question);
+    sqlite3_bind_int(stmt, EntityColumns::examQuestionUpdate.columnCount() + 1, question.getId());
+
+    int result = stepWithRetry(stmt, "updateExamQuestion");
+    int examTemplateId = 0;
+    if (result == SQLITE_ROW) {
+        examTemplateId = sqlite3_column_int(stmt, 0);
+        result = sqlite3_step(stmt);
+    }
     finalizeStatement(stmt);
-    return result == SQLITE_DONE;
+    if (result != SQLITE_DONE) return false;
+
+    if (examTemplateId != 0) invalidateExamPaper(examTemplateId);
+    return true;
 }
 
 bool DatabaseManager::deleteExamQuestion(int questionId) {
     if (!isConnected) return false;
     
-    const char* sql = "DELETE FROM exam_questions WHERE id = ?";
+    const char* sql = "DELETE FROM exam_questions WHERE id = ? RETURNING exam_template_id";
     sqlite3_stmt* stmt = prepareStatement(sql);
     if (!stmt) return false;
     
     sqlite3_bind_int(stmt, 1, questionId);
-    int result = sqlite3_step(stmt);
+    int result = stepWithRetry(stmt, "deleteExamQuestion");
+    int examTemplateId = 0;
+    if (result == SQLITE_ROW) {
+        examTemplateId = sqlite3_column_int(stmt, 0);
+        result = sqlite3_step(stmt);
+    }
     finalizeStatement(stmt);
-    return result == SQLITE_DONE;
+    if (result != SQLITE_DONE) return false;
+
+    if (examTemplateId != 0) invalidateExamPaper(examTemplateId);
+    return true;
 }
 
 vector<ExamQuestion> DatabaseManager::getExamQuestions(int examTemplateId) {
     vector<ExamQuestion> questions;
     if (!isConnected) return questions;
-    
-    const char* sql = R"(
-        SELECT id, exam_template_id, question_number, question_text,
-               option1, option2, option3, option4, correct_answer, explanation
-        FROM exam_questions 
-        WHERE exam_template_id = ? 
-        ORDER BY question_number
-    )";
-    
+
+    static const string sql = "SELECT " + EntityColumns::examQuestion.selectList() +
+                              " FROM exam_questions WHERE exam_template_id = ? ORDER BY question_number";
+
     sqlite3_stmt* stmt = prepareStatement(sql);
     if (!stmt) return questions;
-    
+
     sqlite3_bind_int(stmt, 1, examTemplateId);
-    
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        ExamQuestion question;
-        question.setId(sqlite3_column_int(stmt, 0));
-        question.setExamTemplateId(sqlite3_column_int(stmt, 1));
-        question.setQuestionNumber(sqlite3_column_int(stmt, 2));
-        
-        const char* questionText = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        if (questionText) question.setQuestionText(questionText);
-        
-        vector<string> options(4);
-        for (int i = 0; i < 4; ++i) {
-            const char* option = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4 + i));
-            if (option) options[i] = option;
-        }
-        question.setOptions(options);
-        
-        question.setCorrectAnswer(sqlite3_column_int(stmt, 8));
-        
-        const char* explanation = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 9));
-        if (explanation) question.setExplanation(explanation);
-        
-        questions.push_back(question);
-    }
-    
+    questions = readRows<ExamQuestion>(stmt, EntityColumns::examQuestion, "getExamQuestions");
+
     finalizeStatement(stmt);
     return questions;
 }
@@ -1962,39 +2821,16 @@ vector<ExamQuestion> DatabaseManager::getExamQuestions(int examTemplateId) {
 ExamQuestion DatabaseManager::getExamQuestionById(int questionId) {
     ExamQuestion question;
     if (!isConnected) return question;
-    
-    const char* sql = R"(
-        SELECT id, exam_template_id, question_number, question_text,
-               option1, option2, option3, option4, correct_answer, explanation
-        FROM exam_questions WHERE id = ?
-    )";
-    
+
+    static const string sql = "SELECT " + EntityColumns::examQuestion.selectList() +
+                              " FROM exam_questions WHERE id = ?";
+
     sqlite3_stmt* stmt = prepareStatement(sql);
     if (!stmt) return question;
-    
+
     sqlite3_bind_int(stmt, 1, questionId);
-    
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        question.setId(sqlite3_column_int(stmt, 0));
-        question.setExamTemplateId(sqlite3_column_int(stmt, 1));
-        question.setQuestionNumber(sqlite3_column_int(stmt, 2));
-        
-        const char* questionText = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        if (questionText) question.setQuestionText(questionText);
-        
-        vector<string> options(4);
-        for (int i = 0; i < 4; ++i) {
-            const char* option = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4 + i));
-            if (option) options[i] = option;
-        }
-        question.setOptions(options);
-        
-        question.setCorrectAnswer(sqlite3_column_int(stmt, 8));
-        
-        const char* explanation = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 9));
-        if (explanation) question.setExplanation(explanation);
-    }
-    
+    readRow(stmt, EntityColumns::examQuestion, question, "getExamQuestionById");
+
     finalizeStatement(stmt);
     return question;
 }
@@ -2009,10 +2845,117 @@ int DatabaseManager::getExamQuestionCount(int examTemplateId) {
     sqlite3_bind_int(stmt, 1, examTemplateId);
     
     int count = 0;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
+    if (stepWithRetry(stmt, "getExamQuestionCount") == SQLITE_ROW) {
         count = sqlite3_column_int(stmt, 0);
     }
     
     finalizeStatement(stmt);
     return count;
-}
\ No newline at end of file
+}
+
+shared_ptr<const ExamPaper> DatabaseManager::getSharedExamPaper(int examTemplateId) {
+    dropCachesIfChangedElsewhere();
+    shared_ptr<const ExamPaper> cached;
+    if (paperCache.find(examTemplateId, cached)) {
+        paperHits++;
+        return cached;
+    }
+
+    // Subject and difficulty come from the template (catalog snapshot, no
+    // query). Looked up before paperLoadMutex, which a catalog check takes.
+    ExamTemplate examTemplate = getExamTemplateById(examTemplateId);
+
+    // Held across the load: concurrent starts of the same exam wait for one
+    // query instead of each issuing their own
+    lock_guard<mutex> lock(paperLoadMutex);
+    if (paperCache.find(examTemplateId, cached)) {
+        paperHits++;
+        return cached;
+    }
+
+    auto paper = make_shared<ExamPaper>();
+    paper->examTemplateId = examTemplateId;
+    if (!isConnected) return paper;
+
+    static const string sql = "SELECT " + EntityColumns::paperQuestion.selectList() +
+                              " FROM exam_questions WHERE exam_template_id = ? ORDER BY question_number";
+
+    sqlite3_stmt* stmt = prepareStatement(sql);
+    if (!stmt) return paper;
+
+    sqlite3_bind_int(stmt, 1, examTemplateId);
+    bool complete = false;
+    paper->questions = readRows<Question>(stmt, EntityColumns::paperQuestion, "getSharedExamPaper", &complete);
+    finalizeStatement(stmt);
+
+    for (auto& question : paper->questions) {
+        question.setSubject(examTemplate.getSubjectCode());
+        question.setDifficulty(examTemplate.getDifficultyCode());
+    }
+
+    paperLoads++;
+    if (complete) {
+        paperCache.insert(examTemplateId, paper);
+    }
+    return paper;
+}
+
+void DatabaseManager::invalidateExamPaper(int examTemplateId) {
+    // Waits out a load in progress, which may have read the old rows
+    lock_guard<mutex> lock(paperLoadMutex);
+    if (paperCache.remove(examTemplateId)) {
+        paperInvalidations++;
+    }
+}
+
+PaperCacheStats DatabaseManager::getPaperCacheStats() const {
+    PaperCacheStats stats;
+    stats.loads = paperLoads;
+    stats.hits = paperHits;
+    stats.invalidations = paperInvalidations;
+    stats.papers = static_cast<int>(paperCache.getSize());
+    return stats;
+}
+
+vector<QuestionHeader> DatabaseManager::getExamQuestionHeaders(int examTemplateId) {
+    vector<QuestionHeader> headers;
+    if (!isConnected) return headers;
+
+    static const string sql = "SELECT " + EntityColumns::questionHeader.selectList() +
+                              " FROM exam_questions WHERE exam_template_id = ? ORDER BY question_number";
+
+    sqlite3_stmt* stmt = prepareStatement(sql);
+    if (!stmt) return headers;
+
+    sqlite3_bind_int(stmt, 1, examTemplateId);
+    headers = readRows<QuestionHeader>(stmt, EntityColumns::questionHeader, "getExamQuestionHeaders");
+
+    finalizeStatement(stmt);
+    return headers;
+}
+
+HashTable<int, string> DatabaseManager::getExamQuestionExplanations(int examTemplateId) {
+    HashTable<int, string> explanations;
+    if (!isConnected) return explanations;
+
+    const char* sql = R"(
+        SELECT id, explanation FROM exam_questions
+        WHERE exam_template_id = ? AND explanation IS NOT NULL AND explanation != ''
+    )";
+
+    sqlite3_stmt* stmt = prepareStatement(sql);
+    if (!stmt) return explanations;
+
+    sqlite3_bind_int(stmt, 1, examTemplateId);
+
+    int rc = stepWithRetry(stmt, "getExamQuestionExplanations");
+    while (rc == SQLITE_ROW) {
+        string explanation;
+        decodeValue(stmt, 1, explanation);
+        explanations.insert(sqlite3_column_int(stmt, 0), explanation);
+        rc = sqlite3_step(stmt);
+    }
+
+    finalizeStatement(stmt);
+    return explanations;
+}
@@ -1,16 +1,126 @@
 #ifndef DATABASE_H
 #define DATABASE_H
 #include <string>
+#include <string_view>
 #include <vector>
+#include <memory>
+#include <random>
+#include <mutex>
+#include <atomic>
+#include <functional>
 #include <sqlite3.h>
 #include "../authentication/user.h"
 #include "../components/hash_table.h"
+#include "../components/concurrent_hash_table.h"
+#include "../structure/codes.h"
+#include "wal_checkpointer.h"
+#include "answer_journal.h"
+#include "row_mapper.h"
 
 // Forward declarations
 class Question;
 class ExamResult;
 class ExamTemplate;
 class ExamQuestion;
+struct TemplateCatalog;
+struct ExamPaper;
+
+// Per-statement SQLITE_BUSY/SQLITE_LOCKED counters from the retry layer
+struct StatementContention {
+    string operation;
+    long long executions;
+    long long busyHits;     // Steps that came back busy or locked
+    long long retries;      // Re-executions after a backoff
+    long long failures;     // Gave up after MAX_BUSY_RETRIES
+    double backoffMs;       // Total time spent sleeping between retries
+
+    StatementContention() : executions(0), busyHits(0), retries(0), failures(0), backoffMs(0.0) {}
+};
+
+// Row decoding throughput per entity, measured from the first row to the last
+// (includes the sqlite3_step calls between rows)
+struct DecodeStats {
+    string entity;
+    long long queries;
+    long long rows;
+    double totalMs;
+
+    DecodeStats() : queries(0), rows(0), totalMs(0.0) {}
+};
+
+// Template catalog cache counters: loads are database reads, hits are not
+struct CatalogStats {
+    long long loads;
+    long long hits;
+    long long invalidations;
+    int templates;      // In the current snapshot, 0 if none is loaded
+
+    CatalogStats() : loads(0), hits(0), invalidations(0), templates(0) {}
+};
+
+// Shared exam paper cache counters
+struct PaperCacheStats {
+    long long loads;
+    long long hits;
+    long long invalidations;
+    int papers;         // Templates with a cached paper
+
+    PaperCacheStats() : loads(0), hits(0), invalidations(0), papers(0) {}
+};
+
+// Narrow projections for list screens: only the columns they print
+struct ResultSummary {
+    int id;
+    long long examDateMs;
+    Subject subject;
+    int score;
+    int totalQuestions;
+    double percentage;
+
+    ResultSummary() : id(0), examDateMs(0), subject(Subject::NONE), score(0), totalQuestions(0), percentage(0.0) {}
+};
+
+struct QuestionHeader {
+    int id;
+    int questionNumber;
+    string questionText;
+
+    QuestionHeader() : id(0), questionNumber(0) {}
+};
+
+// A stored result whose score a regrade changed (or would change)
+struct RegradeChange {
+    int resultId;
+    int userId;
+    string username;
+    int oldScore;
+    int newScore;
+    double oldPercentage;
+    double newPercentage;
+    double oldNegativeMarks;
+    double newNegativeMarks;
+
+    RegradeChange() : resultId(0), userId(0), oldScore(0), newScore(0), oldPercentage(0.0), newPercentage(0.0),
+                      oldNegativeMarks(0.0), newNegativeMarks(0.0) {}
+};
+
+struct RegradeReport {
+    int examTemplateId;
+    bool dryRun;            // Nothing was written
+    size_t results;         // Results of the template that were read
+    size_t regraded;        // Of those, with recorded answers
+    size_t skipped;         // Saved before answers were recorded, so left as they are
+    vector<RegradeChange> changes;
+    int batches;            // Write transactions committed
+    bool complete;          // False if a read or a write failed part way
+    double elapsedMs;
+
+    RegradeReport() : examTemplateId(0), dryRun(false), results(0), regraded(0), skipped(0), batches(0),
+                      complete(false), elapsedMs(0.0) {}
+};
+
+// Called after every batch with the results done and the total
+typedef function<void(size_t done, size_t total)> RegradeProgress;
 
 // Database connection and management
 class DatabaseManager {
@@ -30,6 +140,61 @@ private:
     // Last inserted IDs for retrieval
     int lastInsertedExamTemplateId;
     
+    // users_search could be used: FTS5 with the trigram tokenizer (SQLite
+    // 3.34+). Without it searchUsers scans with LIKE instead.
+    bool userSearchIndexed;
+    
+    // Background WAL checkpointing (replaces SQLite auto-checkpoint on db)
+    unique_ptr<WalCheckpointer> walCheckpointer;
+    
+    // Exam session autosave of the student using this process, next to the
+    // database file (null until opened, or if it cannot be)
+    unique_ptr<AnswerJournal> answerJournal;
+    int answerJournalUserId;
+    
+    // Busy handling: SQLite waits up to BUSY_TIMEOUT_MS itself, then
+    // stepWithRetry backs off exponentially (with jitter) up to MAX_BUSY_RETRIES
+    static const int BUSY_TIMEOUT_MS = 50;
+    static const int MAX_BUSY_RETRIES = 8;
+    static const int BASE_BACKOFF_MS = 2;
+    static const int MAX_BACKOFF_MS = 128;
+    HashTable<string, StatementContention> contentionStats;
+    mt19937 backoffRng;
+    
+    // Keyed by RowMapper entity name
+    HashTable<string, DecodeStats> decodeStats;
+    
+    // Exam templates are served from an immutable snapshot. Readers take it
+    // with atomic_load; a template write drops it and the next reader loads a
+    // replacement (catalogMutex serialises load vs. drop). At most once per
+    // VERSION_CHECK_INTERVAL_MS a reader also checks for writes made by other
+    // processes (see dropCachesIfChangedElsewhere).
+    shared_ptr<const TemplateCatalog> templateCatalog;
+    mutex catalogMutex;
+    atomic<long long> catalogLoads;
+    atomic<long long> catalogHits;
+    atomic<long long> catalogInvalidations;
+    
+    // One immutable paper per exam template, shared by every session taking
+    // it. Sessions hold the shared_ptr, so a dropped paper lives on until
+    // the last of them finishes. Hits only take a shard's read lock;
+    // paperLoadMutex serialises loads against each other and against drops.
+    ConcurrentHashTable<int, shared_ptr<const ExamPaper>> paperCache;
+    mutex paperLoadMutex;
+    atomic<long long> paperLoads;
+    atomic<long long> paperHits;
+    atomic<long long> paperInvalidations;
+
+    // Last PRAGMA data_version and exam_catalog_version seen (-1 = not yet).
+    // Readers skip the check until nextVersionCheckMs (steady clock), and
+    // skip it as well while another reader holds versionMutex.
+    static constexpr long long VERSION_CHECK_INTERVAL_MS = 250;
+    mutex versionMutex;
+    sqlite3_stmt* dataVersionStmt;
+    atomic<long long> nextVersionCheckMs;
+    long long seenDataVersion;
+    long long seenCatalogVersion;
+    
 public:
     DatabaseManager(const string& databasePath = "database/exam.db");
     ~DatabaseManager();
@@ -38,6 +203,13 @@ public:
     bool connect();
     void disconnect();
     bool isConnectionActive() const { return isConnected; }
+    CheckpointStats getCheckpointStats() const;
+    vector<StatementContention> getContentionStats() const;
+    vector<DecodeStats> getDecodeStats() const;
+    CatalogStats getCatalogStats() const;
+    PaperCacheStats getPaperCacheStats() const;
+    AnswerJournal* getAnswerJournal(int userId);    // Opened on first use; null if unavailable
+    JournalStats getJournalStats() const;           // Of the journal open in this process
     
     // Database initialization
     bool initializeDatabase();
@@ -75,8 +247,18 @@ public:
     bool deleteExamResult(int resultId);
     ExamResult getExamResultById(int resultId);
     vector<ExamResult> getExamResultsByUser(int userId);
+    vector<ResultSummary> getResultSummariesByUser(int userId);
     vector<ExamResult> getAllExamResults();
-    vector<ExamResult> getExamResultsByDateRange(const string& startDate, const string& endDate);
+    vector<ExamResult> getExamResultsByDateRange(const string& startDate, const string& endDate); // Local "YYYY-MM-DD[ HH:MM[:SS]]", end date inclusive
+    vector<ExamResult> getExamResultsByDateRange(long long fromMs, long long toMs);                 // Epoch ms, [fromMs, toMs)
+    
+    // Re-score every result of a template against its current answer key
+    // and negative-marking rules, e.g. after a correct answer was fixed.
+    // Results are read in id ranges by parallel readers on their own
+    // connections and written back in short batched transactions, so live
+    // exams can save results between batches. A dry run only reports.
+    RegradeReport regradeExamResults(int examTemplateId, bool dryRun = false,
+                                     const RegradeProgress& progress = RegradeProgress());
     
     // Exam template operations
     bool insertExamTemplate(const ExamTemplate& examTemplate);
@@ -96,6 +278,9 @@ public:
     bool updateExamQuestion(const ExamQuestion& question);
     bool deleteExamQuestion(int questionId);
     vector<ExamQuestion> getExamQuestions(int examTemplateId);
+    shared_ptr<const ExamPaper> getSharedExamPaper(int examTemplateId); // Cached, never null
+    vector<QuestionHeader> getExamQuestionHeaders(int examTemplateId);
+    HashTable<int, string> getExamQuestionExplanations(int examTemplateId); // Keyed by question id
     ExamQuestion getExamQuestionById(int questionId);
     int getExamQuestionCount(int examTemplateId);
     
@@ -121,7 +306,7 @@ public:
     
     // Advanced queries
     vector<Question> searchQuestions(const string& keyword);
-    vector<User> searchUsers(const string& keyword);
+    vector<User> searchUsers(const string& keyword, size_t limit = 20); // Ranked, typo-tolerant
     vector<ExamResult> getTopPerformers(int limit = 10);
     vector<ExamResult> getRecentResults(int limit = 20);
     
@@ -133,6 +318,21 @@ private:
     // Helper methods
     bool executeSQL(const string& sql);
     sqlite3_stmt* prepareStatement(const string& sql);
+    int stepWithRetry(sqlite3_stmt* stmt, string_view operation);
+    
+    // Step through a result set and decode it with a RowMapper (see EntityColumns)
+    template <typename Entity, typename Mapper>
+    vector<Entity> readRows(sqlite3_stmt* stmt, const Mapper& mapper, string_view operation,
+                            bool* complete = nullptr); // Set false if the scan stopped on an error
+    template <typename Entity, typename Mapper>
+    bool readRow(sqlite3_stmt* stmt, const Mapper& mapper, Entity& target, string_view operation);
+    void recordDecode(const char* entity, size_t rows, double elapsedMs);
+    
+    // Template catalog snapshot (see templateCatalog)
+    shared_ptr<const TemplateCatalog> getTemplateCatalog();
+    void invalidateTemplateCatalog();
+    void invalidateExamPaper(int examTemplateId);
+    void dropCachesIfChangedElsewhere();
     void finalizeStatement(sqlite3_stmt* stmt);
     string escapeString(const string& str);
     
@@ -143,6 +343,13 @@ private:
     // Schema validation
     bool validateSchema();
     bool updateSchema();
+    bool runMigration(const string& name, const vector<string>& steps);
+    
+    // Regrade: results per read chunk and write transaction, and readers
+    static constexpr int REGRADE_BATCH = 1024;
+    static constexpr int MAX_REGRADE_READERS = 4;
+    bool insertExamAnswers(int resultId, const ExamResult& result);
+    bool writeRegradeBatch(const vector<RegradeChange>& changes);
     
     // Logging
     void logError(const string& operation, const string& error);
@@ -153,30 +360,35 @@ private:
 class Question {
 private:
     int id;
-    string subject;
+    Subject subject;
     string questionText;
     vector<string> options;
     int correctAnswer;
-    string difficulty;
+    Difficulty difficulty;
     string explanation;
     string createdAt;
     string updatedAt;
     int createdBy;
     bool isActive;
     
+    friend struct EntityColumns;
+    
 public:
     Question();
+    explicit Question(RowDecode);
     Question(int id, const string& subject, const string& questionText,
              const vector<string>& options, int correctAnswer,
              const string& difficulty = "Medium", const string& explanation = "");
     
     // Getters
     int getId() const { return id; }
-    string getSubject() const { return subject; }
+    string getSubject() const { return SUBJECT_CODES.name(subject); }
+    Subject getSubjectCode() const { return subject; }
     string getQuestionText() const { return questionText; }
     vector<string> getOptions() const { return options; }
     int getCorrectAnswer() const { return correctAnswer; }
-    string getDifficulty() const { return difficulty; }
+    string getDifficulty() const { return DIFFICULTY_CODES.name(difficulty); }
+    Difficulty getDifficultyCode() const { return difficulty; }
     string getExplanation() const { return explanation; }
     string getCreatedAt() const { return createdAt; }
     string getUpdatedAt() const { return updatedAt; }
@@ -185,11 +397,13 @@ public:
     
     // Setters
     void setId(int id) { this->id = id; }
-    void setSubject(const string& subject) { this->subject = subject; }
+    void setSubject(Subject subject) { this->subject = subject; }
+    void setSubject(const string& subject) { this->subject = SUBJECT_CODES.code(subject); }
     void setQuestionText(const string& questionText) { this->questionText = questionText; }
     void setOptions(const vector<string>& options) { this->options = options; }
     void setCorrectAnswer(int correctAnswer) { this->correctAnswer = correctAnswer; }
-    void setDifficulty(const string& difficulty) { this->difficulty = difficulty; }
+    void setDifficulty(Difficulty difficulty) { this->difficulty = difficulty; }
+    void setDifficulty(const string& difficulty) { this->difficulty = DIFFICULTY_CODES.code(difficulty); }
     void setExplanation(const string& explanation) { this->explanation = explanation; }
     void setCreatedBy(int createdBy) { this->createdBy = createdBy; }
     void setIsActive(bool isActive) { this->isActive = isActive; }
@@ -199,13 +413,23 @@ public:
     bool isValid() const;
     
     // Display
-    void display() const;
+    void display(const uint8_t* optionOrder = nullptr) const; // optionOrder[slot]: option shown in that slot
     void displayWithAnswer() const;
     
     // Operators
     bool operator==(const Question& other) const;
 };
 
+// Question paper of one exam template, by question_number. Immutable once
+// published; a session keeps only its question order and its answers.
+// Explanations are not loaded (see getExamQuestionExplanations).
+struct ExamPaper {
+    int examTemplateId;
+    vector<Question> questions;
+
+    ExamPaper() : examTemplateId(0) {}
+};
+
 // Exam result entity
 class ExamResult {
 private:
@@ -215,13 +439,13 @@ private:
     int score;
     int totalQuestions;
     double percentage;
-    string examDate;
-    string startTime;
-    string endTime;
+    long long examDateMs;  // Epoch milliseconds
+    long long startTimeMs; // 0 if not recorded
+    long long endTimeMs;
     int duration; // in minutes
-    string subject;
-    string difficulty;
-    string examType; // Quiz, Worksheet, Final
+    Subject subject;
+    Difficulty difficulty;
+    ExamType examType; // Quiz, Worksheet, Final
     string templateName; // Name of the template used
     int examTemplateId; // ID of the exam template
     int timeLimit; // Original time limit
@@ -231,8 +455,11 @@ private:
     vector<int> userAnswers;
     vector<bool> correctAnswers;
     
+    friend struct EntityColumns;
+    
 public:
     ExamResult();
+    explicit ExamResult(RowDecode);
     ExamResult(int userId, const string& username, int score, int totalQuestions,
                const string& subject = "", const string& difficulty = "Mixed");
     
@@ -243,13 +470,18 @@ public:
     int getScore() const { return score; }
     int getTotalQuestions() const { return totalQuestions; }
     double getPercentage() const { return percentage; }
-    string getExamDate() const { return examDate; }
-    string getStartTime() const { return startTime; }
-    string getEndTime() const { return endTime; }
+    string getExamDate() const { return Utils::formatEpochMs(examDateMs); }
+    string getStartTime() const { return Utils::formatEpochMs(startTimeMs); }
+    string getEndTime() const { return Utils::formatEpochMs(endTimeMs); }
+    long long getExamDateMs() const { return examDateMs; }
+    long long getStartTimeMs() const { return startTimeMs; }
+    long long getEndTimeMs() const { return endTimeMs; }
     int getDuration() const { return duration; }
-    string getSubject() const { return subject; }
-    string getDifficulty() const { return difficulty; }
-    string getExamType() const { return examType; }
+    string getSubject() const { return SUBJECT_CODES.name(subject); }
+    string getDifficulty() const { return DIFFICULTY_CODES.name(difficulty); }
+    string getExamType() const { return EXAM_TYPE_CODES.name(examType); }
+    Subject getSubjectCode() const { return subject; }
+    ExamType getExamTypeCode() const { return examType; }
     string getTemplateName() const { return templateName; }
     int getExamTemplateId() const { return examTemplateId; }
     int getTimeLimit() const { return timeLimit; }
@@ -265,13 +497,14 @@ public:
     void setUsername(const string& username) { this->username = username; }
     void setScore(int score) { this->score = score; calculatePercentage(); }
     void setTotalQuestions(int totalQuestions) { this->totalQuestions = totalQuestions; calculatePercentage(); }
-    void setExamDate(const string& examDate) { this->examDate = examDate; }
-    void setStartTime(const string& startTime) { this->startTime = startTime; }
-    void setEndTime(const string& endTime) { this->endTime = endTime; }
+    void setExamDateMs(long long examDateMs) { this->examDateMs = examDateMs; }
+    void setStartTimeMs(long long startTimeMs) { this->startTimeMs = startTimeMs; }
+    void setEndTimeMs(long long endTimeMs) { this->endTimeMs = endTimeMs; }
     void setDuration(int duration) { this->duration = duration; }
-    void setSubject(const string& subject) { this->subject = subject; }
-    void setDifficulty(const string& difficulty) { this->difficulty = difficulty; }
-    void setExamType(const string& examType) { this->examType = examType; }
+    void setSubject(Subject subject) { this->subject = subject; }
+    void setSubject(const string& subject) { this->subject = SUBJECT_CODES.code(subject); }
+    void setDifficulty(const string& difficulty) { this->difficulty = DIFFICULTY_CODES.code(difficulty); }
+    void setExamType(ExamType examType) { this->examType = examType; }
     void setTemplateName(const string& templateName) { this->templateName = templateName; }
     void setExamTemplateId(int examTemplateId) { this->examTemplateId = examTemplateId; }
     void setTimeLimit(int timeLimit) { this->timeLimit = timeLimit; }
@@ -0,0 +1,189 @@
+#ifndef ROW_MAPPER_H
+#define ROW_MAPPER_H
+
+#include <string>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <sqlite3.h>
+
+using namespace std;
+
+// Tag for entity constructors that skip default initialisation (such as
+// stamping the current time) because every field is about to be decoded
+struct RowDecode {};
+
+// Column descriptors. Each one names a SQL column and the entity member it
+// maps to; RowMapper walks them at compile time.
+template <typename Entity, typename Field>
+struct FieldColumn {
+    const char* name;
+    Field Entity::*member;
+};
+
+// One element of a fixed-size vector member (e.g. option1..option4)
+template <typename Entity, typename Element>
+struct ElementColumn {
+    const char* name;
+    vector<Element> Entity::*member;
+    size_t index;
+};
+
+template <typename Entity, typename Field>
+constexpr FieldColumn<Entity, Field> column(const char* name, Field Entity::*member) {
+    return {name, member};
+}
+
+template <typename Entity, typename Element>
+constexpr ElementColumn<Entity, Element> column(const char* name, vector<Element> Entity::*member, size_t index) {
+    return {name, member, index};
+}
+
+// Value decoders: NULL leaves the member at its default value
+inline void decodeValue(sqlite3_stmt* stmt, int col, int& value) {
+    value = sqlite3_column_int(stmt, col);
+}
+
+inline void decodeValue(sqlite3_stmt* stmt, int col, long long& value) {
+    value = sqlite3_column_int64(stmt, col);
+}
+
+inline void decodeValue(sqlite3_stmt* stmt, int col, double& value) {
+    value = sqlite3_column_double(stmt, col);
+}
+
+inline void decodeValue(sqlite3_stmt* stmt, int col, bool& value) {
+    value = sqlite3_column_int(stmt, col) != 0;
+}
+
+inline void decodeValue(sqlite3_stmt* stmt, int col, string& value) {
+    const unsigned char* text = sqlite3_column_text(stmt, col);
+    if (text) {
+        // Assign in place: no temporary string, reuses existing capacity
+        value.assign(reinterpret_cast<const char*>(text), sqlite3_column_bytes(stmt, col));
+    } else {
+        value.clear();
+    }
+}
+
+template <typename Enum>
+typename enable_if<is_enum<Enum>::value>::type decodeValue(sqlite3_stmt* stmt, int col, Enum& value) {
+    value = static_cast<Enum>(sqlite3_column_int(stmt, col));
+}
+
+// Value binders (1-based parameter index)
+inline void bindValue(sqlite3_stmt* stmt, int param, int value) {
+    sqlite3_bind_int(stmt, param, value);
+}
+
+inline void bindValue(sqlite3_stmt* stmt, int param, long long value) {
+    sqlite3_bind_int64(stmt, param, value);
+}
+
+inline void bindValue(sqlite3_stmt* stmt, int param, double value) {
+    sqlite3_bind_double(stmt, param, value);
+}
+
+inline void bindValue(sqlite3_stmt* stmt, int param, bool value) {
+    sqlite3_bind_int(stmt, param, value ? 1 : 0);
+}
+
+inline void bindValue(sqlite3_stmt* stmt, int param, const string& value) {
+    // The entity outlives sqlite3_step, so SQLite does not need its own copy
+    sqlite3_bind_text(stmt, param, value.c_str(), static_cast<int>(value.size()), SQLITE_STATIC);
+}
+
+template <typename Enum>
+typename enable_if<is_enum<Enum>::value>::type bindValue(sqlite3_stmt* stmt, int param, Enum value) {
+    sqlite3_bind_int(stmt, param, static_cast<int>(value));
+}
+
+// Compile-time list of column descriptors for one entity
+template <typename Entity, typename... Columns>
+class RowMapper {
+private:
+    const char* entity;
+    tuple<Columns...> columns;
+
+    template <typename Field>
+    static void decodeColumn(sqlite3_stmt* stmt, int col, Entity& target, const FieldColumn<Entity, Field>& c) {
+        if (sqlite3_column_type(stmt, col) != SQLITE_NULL) {
+            decodeValue(stmt, col, target.*(c.member));
+        }
+    }
+
+    template <typename Element>
+    static void decodeColumn(sqlite3_stmt* stmt, int col, Entity& target, const ElementColumn<Entity, Element>& c) {
+        decodeValue(stmt, col, (target.*(c.member))[c.index]);
+    }
+
+    template <typename Field>
+    static void bindColumn(sqlite3_stmt* stmt, int param, const Entity& source, const FieldColumn<Entity, Field>& c) {
+        bindValue(stmt, param, source.*(c.member));
+    }
+
+    template <typename Element>
+    static void bindColumn(sqlite3_stmt* stmt, int param, const Entity& source, const ElementColumn<Entity, Element>& c) {
+        bindValue(stmt, param, (source.*(c.member))[c.index]);
+    }
+
+    template <size_t... I>
+    void decodeAll(sqlite3_stmt* stmt, Entity& target, int first, index_sequence<I...>) const {
+        (decodeColumn(stmt, first + static_cast<int>(I), target, get<I>(columns)), ...);
+    }
+
+    template <size_t... I>
+    void bindAll(sqlite3_stmt* stmt, const Entity& source, int first, index_sequence<I...>) const {
+        (bindColumn(stmt, first + static_cast<int>(I), source, get<I>(columns)), ...);
+    }
+
+    template <size_t... I>
+    string joinNames(const char* suffix, index_sequence<I...>) const {
+        string list;
+        ((list += (I == 0 ? "" : ", "), list += get<I>(columns).name, list += suffix), ...);
+        return list;
+    }
+
+public:
+    constexpr RowMapper(const char* entityName, Columns... cols) : entity(entityName), columns(cols...) {}
+
+    static constexpr size_t columnCount() { return sizeof...(Columns); }
+    const char* entityName() const { return entity; }
+
+    // Decode the current row, starting at result column `first`
+    void decode(sqlite3_stmt* stmt, Entity& target, int first = 0) const {
+        decodeAll(stmt, target, first, index_sequence_for<Columns...>{});
+    }
+
+    // Bind every column as consecutive parameters, starting at `first`.
+    // Text is bound SQLITE_STATIC, so `source` must outlive the step.
+    void bind(sqlite3_stmt* stmt, const Entity& source, int first = 1) const {
+        bindAll(stmt, source, first, index_sequence_for<Columns...>{});
+    }
+
+    // SQL fragments in descriptor order, so statements cannot drift from the
+    // column indexes decode() and bind() use
+    string selectList() const {                       // "a, b, c"
+        return joinNames("", index_sequence_for<Columns...>{});
+    }
+
+    string assignmentList() const {                   // "a = ?, b = ?, c = ?"
+        return joinNames(" = ?", index_sequence_for<Columns...>{});
+    }
+
+    string placeholderList() const {                  // "?, ?, ?"
+        string list;
+        for (size_t i = 0; i < columnCount(); ++i) {
+            list += (i == 0 ? "?" : ", ?");
+        }
+        return list;
+    }
+};
+
+template <typename Entity, typename... Columns>
+constexpr RowMapper<Entity, Columns...> makeRowMapper(const char* entityName, Columns... cols) {
+    return RowMapper<Entity, Columns...>(entityName, cols...);
+}
+
+#endif // ROW_MAPPER_H
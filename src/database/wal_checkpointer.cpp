@@ -0,0 +1,221 @@
+#include "wal_checkpointer.h"
+#include <iostream>
+using namespace std;
+
+WalCheckpointer::WalCheckpointer(const string &databasePath, int passiveThresholdFrames,
+                                 int maxIntervalSeconds, int idleSeconds)
+    : dbPath(databasePath), writer(nullptr), conn(nullptr), running(false), stopRequested(false),
+      passiveThresholdFrames(passiveThresholdFrames), maxInterval(maxIntervalSeconds),
+      idleDelay(idleSeconds), pollInterval(500), walFrames(0), backfilledFrames(0), attemptedFrames(-1),
+      restartedSinceCommit(true), pageSize(4096)
+{
+    lastCommit = chrono::steady_clock::now();
+    lastCheckpoint = lastCommit;
+}
+
+WalCheckpointer::~WalCheckpointer()
+{
+    stop();
+}
+
+bool WalCheckpointer::start(sqlite3 *writerConnection)
+{
+    if (running)
+        return true;
+
+    int rc = sqlite3_open_v2(dbPath.c_str(), &conn, SQLITE_OPEN_READWRITE, nullptr);
+    if (rc != SQLITE_OK)
+    {
+        cerr << "WAL checkpointer: cannot open " << dbPath << ": " << sqlite3_errmsg(conn) << endl;
+        sqlite3_close(conn);
+        conn = nullptr;
+        return false;
+    }
+
+    // RESTART waits on readers through the busy handler while holding the
+    // writer lock, so keep that wait short
+    sqlite3_busy_timeout(conn, 100);
+
+    // Reading the journal mode also opens the WAL on this connection; without
+    // that, checkpoints silently do nothing
+    string journalMode;
+    sqlite3_stmt *stmt = nullptr;
+    if (sqlite3_prepare_v2(conn, "PRAGMA journal_mode;", -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        const char *mode = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+        if (mode)
+            journalMode = mode;
+    }
+    sqlite3_finalize(stmt);
+
+    if (journalMode != "wal")
+    {
+        // Not in WAL mode: leave SQLite's own checkpointing in place
+        sqlite3_close(conn);
+        conn = nullptr;
+        return false;
+    }
+
+    stmt = nullptr;
+    if (sqlite3_prepare_v2(conn, "PRAGMA page_size;", -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        pageSize = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    // Registering a WAL hook disables the built-in auto-checkpoint, so commits
+    // on the writer never pay for a synchronous checkpoint
+    writer = writerConnection;
+    sqlite3_wal_hook(writer, &WalCheckpointer::walHook, this);
+
+    stopRequested = false;
+    running = true;
+    worker = thread(&WalCheckpointer::run, this);
+    return true;
+}
+
+void WalCheckpointer::stop()
+{
+    if (!running)
+        return;
+
+    {
+        lock_guard<mutex> lock(stateMutex);
+        stopRequested = true;
+    }
+    wakeup.notify_one();
+    worker.join();
+
+    if (writer)
+    {
+        sqlite3_wal_hook(writer, nullptr, nullptr);
+        writer = nullptr;
+    }
+    if (conn)
+    {
+        sqlite3_close(conn);
+        conn = nullptr;
+    }
+    running = false;
+}
+
+CheckpointStats WalCheckpointer::getStats() const
+{
+    lock_guard<mutex> lock(stateMutex);
+    CheckpointStats snapshot = stats;
+    snapshot.walFrames = walFrames;
+    snapshot.walBytes = static_cast<long long>(walFrames) * pageSize;
+    return snapshot;
+}
+
+int WalCheckpointer::walHook(void *context, sqlite3 *, const char *, int frames)
+{
+    static_cast<WalCheckpointer *>(context)->onCommit(frames);
+    return SQLITE_OK;
+}
+
+void WalCheckpointer::onCommit(int frames)
+{
+    bool wake = false;
+    {
+        lock_guard<mutex> lock(stateMutex);
+        // A shrinking frame count means the writer restarted the WAL
+        if (frames < walFrames)
+        {
+            backfilledFrames = 0;
+        }
+        walFrames = frames;
+        lastCommit = chrono::steady_clock::now();
+        restartedSinceCommit = false;
+        wake = walFrames - backfilledFrames >= passiveThresholdFrames && walFrames != attemptedFrames;
+    }
+    if (wake)
+    {
+        wakeup.notify_one();
+    }
+}
+
+void WalCheckpointer::run()
+{
+    unique_lock<mutex> lock(stateMutex);
+    while (!stopRequested)
+    {
+        wakeup.wait_for(lock, pollInterval, [this]()
+                        { return stopRequested ||
+                                 (walFrames - backfilledFrames >= passiveThresholdFrames && walFrames != attemptedFrames); });
+        if (stopRequested)
+            break;
+
+        auto now = chrono::steady_clock::now();
+        int pending = walFrames - backfilledFrames;
+        bool idle = now - lastCommit >= idleDelay;
+        bool restartDue = idle && walFrames > 0 && !restartedSinceCommit;
+        // Never retry a checkpoint on the same WAL contents; wait for new frames
+        bool passiveDue = walFrames != attemptedFrames &&
+                          (pending >= passiveThresholdFrames ||
+                           (pending > 0 && now - lastCheckpoint >= maxInterval));
+
+        if (!restartDue && !passiveDue)
+            continue;
+
+        attemptedFrames = walFrames;
+        lock.unlock();
+        checkpoint(restartDue ? SQLITE_CHECKPOINT_RESTART : SQLITE_CHECKPOINT_PASSIVE);
+        lock.lock();
+    }
+}
+
+void WalCheckpointer::checkpoint(int mode)
+{
+    int logFrames = -1;
+    int checkpointedFrames = -1;
+
+    auto begin = chrono::steady_clock::now();
+    int rc = sqlite3_wal_checkpoint_v2(conn, nullptr, mode, &logFrames, &checkpointedFrames);
+    auto end = chrono::steady_clock::now();
+    double elapsedMs = chrono::duration<double, milli>(end - begin).count();
+
+    lock_guard<mutex> lock(stateMutex);
+    lastCheckpoint = end;
+    stats.lastDurationMs = elapsedMs;
+    stats.totalDurationMs += elapsedMs;
+    if (elapsedMs > stats.maxDurationMs)
+    {
+        stats.maxDurationMs = elapsedMs;
+    }
+
+    if (mode == SQLITE_CHECKPOINT_RESTART)
+    {
+        stats.restartCheckpoints++;
+    }
+    else
+    {
+        stats.passiveCheckpoints++;
+    }
+
+    if (rc != SQLITE_OK || logFrames < 0 || checkpointedFrames < logFrames)
+    {
+        stats.incompleteCheckpoints++;
+    }
+
+    if (rc == SQLITE_OK && logFrames >= 0)
+    {
+        walFrames = logFrames;
+        backfilledFrames = checkpointedFrames;
+    }
+
+    if (mode == SQLITE_CHECKPOINT_RESTART)
+    {
+        // Either the next commit starts writing from the beginning of the WAL,
+        // or readers are still active; in both cases wait for the next idle
+        // period instead of spinning on the busy handler
+        restartedSinceCommit = true;
+        if (rc == SQLITE_OK && checkpointedFrames == logFrames)
+        {
+            walFrames = 0;
+            backfilledFrames = 0;
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef WAL_CHECKPOINTER_H
+#define WAL_CHECKPOINTER_H
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <sqlite3.h>
+
+using namespace std;
+
+// Checkpoint statistics for monitoring write-ahead log growth
+struct CheckpointStats {
+    long long passiveCheckpoints;
+    long long restartCheckpoints;
+    long long incompleteCheckpoints; // Checkpoints that could not backfill every frame
+    int walFrames;                   // Frames in the WAL after the last commit
+    long long walBytes;
+    double lastDurationMs;
+    double maxDurationMs;
+    double totalDurationMs;
+
+    CheckpointStats() : passiveCheckpoints(0), restartCheckpoints(0), incompleteCheckpoints(0),
+                        walFrames(0), walBytes(0), lastDurationMs(0.0), maxDurationMs(0.0),
+                        totalDurationMs(0.0) {}
+};
+
+// Background WAL checkpointer. The writer connection only records WAL growth
+// through sqlite3_wal_hook (which also replaces SQLite's synchronous
+// auto-checkpoint), while checkpoints run on a dedicated connection and thread:
+//  - PASSIVE once enough frames are pending or the last checkpoint is too old
+//  - RESTART only after the writer has been idle, so the WAL file is reused
+class WalCheckpointer {
+private:
+    string dbPath;
+    sqlite3* writer;
+    sqlite3* conn;
+    thread worker;
+    bool running;
+    bool stopRequested;
+
+    // Policy
+    int passiveThresholdFrames;
+    chrono::seconds maxInterval;
+    chrono::seconds idleDelay;
+    chrono::milliseconds pollInterval;
+
+    // WAL state, guarded by stateMutex
+    mutable mutex stateMutex;
+    condition_variable wakeup;
+    int walFrames;
+    int backfilledFrames;
+    int attemptedFrames;
+    bool restartedSinceCommit;
+    int pageSize;
+    chrono::steady_clock::time_point lastCommit;
+    chrono::steady_clock::time_point lastCheckpoint;
+    CheckpointStats stats;
+
+public:
+    WalCheckpointer(const string& databasePath, int passiveThresholdFrames = 1000,
+                    int maxIntervalSeconds = 30, int idleSeconds = 5);
+    ~WalCheckpointer();
+
+    // Attach to the writer connection and start the background thread
+    bool start(sqlite3* writerConnection);
+    void stop();
+    bool isRunning() const { return running; }
+
+    CheckpointStats getStats() const;
+
+private:
+    static int walHook(void* context, sqlite3* db, const char* dbName, int frames);
+    void onCommit(int frames);
+    void run();
+    void checkpoint(int mode);
+};
+
+#endif // WAL_CHECKPOINTER_H
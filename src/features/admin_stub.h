@@ -487,6 +487,7 @@ private:
     {
         Utils::clearScreen();
         Utils::printHeader("EDIT EXAM QUESTION");
+        int oldCorrectAnswer = question.getCorrectAnswer();
 
         cout << "\nCurrent Question:" << endl;
         cout << string(50, '-') << endl;
@@ -539,6 +540,10 @@ private:
         if (dbManager->updateExamQuestion(question))
         {
             cout << "\n✓ Question updated successfully!" << endl;
+            if (question.getCorrectAnswer() != oldCorrectAnswer && question.getExamTemplateId() != 0)
+            {
+                offerRegrade(question.getExamTemplateId());
+            }
         }
         else
         {
@@ -548,6 +553,67 @@ private:
         Utils::pauseSystem();
     }
 
+    // After an answer key change: rescore the results already saved. Exams
+    // still in progress pick up the new key when they are submitted.
+    void offerRegrade(int examTemplateId)
+    {
+        cout << "\nThe correct answer changed. Exams in progress will be graded with the new answer." << endl;
+        cout << "Regrade existing results? (p=preview/y/N): ";
+        string input;
+        getline(cin, input);
+        char c = input.empty() ? 'n' : tolower(input[0]);
+        if (c != 'p' && c != 'y')
+            return;
+
+        RegradeReport report = runRegrade(examTemplateId, c == 'p');
+        if (!report.dryRun || !report.complete || report.changes.empty())
+            return;
+
+        cout << "\nApply these changes? (y/N): ";
+        getline(cin, input);
+        if (!input.empty() && tolower(input[0]) == 'y')
+            runRegrade(examTemplateId, false);
+    }
+
+    // Regrades (or with dryRun only previews) and prints what changed
+    RegradeReport runRegrade(int examTemplateId, bool dryRun)
+    {
+        RegradeReport report = dbManager->regradeExamResults(examTemplateId, dryRun,
+            [](size_t done, size_t total)
+            {
+                cout << "\r Regrading... " << done << "/" << total << flush;
+            });
+        cout << endl;
+
+        // The table and timing below set left/fixed; later screens expect the defaults
+        ios::fmtflags coutFlags = cout.flags();
+        streamsize coutPrecision = cout.precision();
+        const size_t shown = 20;
+        if (!report.changes.empty())
+        {
+            cout << "\n" << left << setw(20) << "Student" << setw(12) << "Old Score" << "New Score" << endl;
+            cout << string(44, '-') << endl;
+            for (size_t i = 0; i < report.changes.size() && i < shown; ++i)
+            {
+                const RegradeChange &change = report.changes[i];
+                cout << left << setw(20) << change.username << setw(12) << change.oldScore << change.newScore << endl;
+            }
+            if (report.changes.size() > shown)
+                cout << " ... and " << (report.changes.size() - shown) << " more" << endl;
+        }
+
+        cout << "\n" << report.results << " result(s) read, " << report.changes.size() << " score(s) "
+             << (report.dryRun ? "would change" : "changed");
+        if (report.skipped > 0)
+            cout << ", " << report.skipped << " skipped (no recorded answers)";
+        cout << " in " << fixed << setprecision(0) << report.elapsedMs << " ms." << endl;
+        if (!report.complete)
+            cout << "✗ Regrade stopped part way; rerun it to finish." << endl;
+        cout.flags(coutFlags);
+        cout.precision(coutPrecision);
+        return report;
+    }
+
     void editSingleQuestion(Question &question)
     {
         Utils::clearScreen();
@@ -642,7 +708,7 @@ private:
         Utils::clearScreen();
         Utils::printHeader("REMOVE QUESTIONS FROM EXAM");
 
-        auto questions = dbManager->getExamQuestions(examId);
+        auto questions = dbManager->getExamQuestionHeaders(examId);
         if (questions.empty())
         {
             cout << " No questions found for this exam!" << endl;
@@ -656,8 +722,8 @@ private:
         for (size_t i = 0; i < questions.size(); ++i)
         {
             cout << "\n[" << (i + 1) << "] ";
-            cout << questions[i].getQuestionText().substr(0, 50);
-            if (questions[i].getQuestionText().length() > 50)
+            cout << questions[i].questionText.substr(0, 50);
+            if (questions[i].questionText.length() > 50)
                 cout << "...";
             cout << endl;
         }
@@ -677,7 +743,7 @@ private:
 
         if (confirm == 'y' || confirm == 'Y')
         {
-            if (dbManager->deleteExamQuestion(questions[choice - 1].getId()))
+            if (dbManager->deleteExamQuestion(questions[choice - 1].id))
             {
                 cout << "\n✓ Question removed successfully!" << endl;
             }
@@ -974,6 +1040,13 @@ private:
             newTemplate.setNegativeMarkValue(negValue);
         }
 
+        cout << "Penalise Unanswered Questions? (y/N): ";
+        cin >> choice;
+        if (choice == 'y' || choice == 'Y')
+        {
+            newTemplate.setSkipPenalty(Utils::getSafeDouble("Skip Penalty (0.0-1.0, e.g., 0.25): ", 0.0, 1.0));
+        }
+
         cout << "Shuffle Questions? (Y/n): ";
         cin >> choice;
         newTemplate.setShuffleQuestions(choice != 'n' && choice != 'N');
@@ -1632,23 +1705,44 @@ private:
         Utils::clearScreen();
         Utils::printHeader("SEARCH USER");
 
-        cout << "Enter username to search: ";
-        string username;
-        cin >> username;
+        // Username, name or email; substrings and small typos match too
+        cin.ignore();
+        string keyword = Utils::getSafeString("Search (username, name or email): ", 100, true);
 
-        User user = dbManager->getUserByUsername(username);
+        auto matches = dbManager->searchUsers(keyword, 20);
 
-        if (user.getId() == 0)
+        User user;
+        if (matches.empty())
         {
-            cout << "\nUser '" << username << "' not found!" << endl;
-            cout << "\nAvailable users:" << endl;
-            auto allUsers = dbManager->getAllUsers();
-            for (const auto &u : allUsers)
+            cout << "\nNo users match '" << keyword << "'." << endl;
+        }
+        else if (matches.size() == 1 || Utils::toLower(matches[0].getUsername()) == Utils::toLower(keyword))
+        {
+            user = matches[0];
+        }
+        else
+        {
+            cout << "\n Best matches:" << endl;
+            cout << " " << left << setw(6) << "ID" << setw(16) << "Username" << setw(24) << "Full Name"
+                 << setw(28) << "Email" << "Role" << endl;
+            cout << " " << string(80, '-') << endl;
+            for (const auto &match : matches)
             {
-                cout << "  - " << u.getUsername() << " (" << u.roleToString() << ")" << endl;
+                cout << " " << left << setw(6) << match.getId() << setw(16) << match.getUsername().substr(0, 15)
+                     << setw(24) << match.getFullName().substr(0, 23) << setw(28) << match.getEmail().substr(0, 27)
+                     << match.roleToString() << endl;
+            }
+            cout << right;
+
+            int id = Utils::getSafeInt("\nEnter ID to view details (0 to return): ", 0, INT_MAX);
+            for (const auto &match : matches)
+            {
+                if (match.getId() == id)
+                    user = match;
             }
         }
-        else
+
+        if (user.getId() != 0)
         {
             cout << "\nUser Found:" << endl;
             cout << string(50, '-') << endl;
@@ -1664,7 +1758,7 @@ private:
             // Show exam statistics for students
             if (user.getRole() == UserRole::STUDENT)
             {
-                auto results = dbManager->getExamResultsByUser(user.getId());
+                auto results = dbManager->getResultSummariesByUser(user.getId());
                 cout << "\nExam Statistics:" << endl;
                 cout << "Total Exams: " << results.size() << endl;
 
@@ -1673,7 +1767,7 @@ private:
                     double totalScore = 0;
                     for (const auto &result : results)
                     {
-                        totalScore += result.getPercentage();
+                        totalScore += result.percentage;
                     }
                     cout << "Average Score: " << (totalScore / results.size()) << "%" << endl;
                 }
@@ -1798,19 +1892,104 @@ private:
         cout << "Total Questions: " << dbManager->getTotalQuestions() << endl;
         cout << "Total Exam Results: " << dbManager->getTotalExamResults() << endl;
 
+        // Indexed range scan over exam_date (epoch ms) from Monday 00:00
+        long long nowMs = Utils::nowEpochMs();
+        cout << "Exams This Week: "
+             << dbManager->getExamResultsByDateRange(Utils::startOfWeekMs(nowMs), nowMs + 1).size() << endl;
+
         // Show question distribution by subject
         auto questions = dbManager->getAllQuestions();
-        map<string, int> subjectCount;
+        int subjectCount[SUBJECT_CODES.size()] = {};
         for (const auto &q : questions)
         {
-            subjectCount[q.getSubject()]++;
+            subjectCount[static_cast<int>(q.getSubjectCode())]++;
         }
 
         cout << "\nQuestions by Subject:" << endl;
-        for (const auto &pair : subjectCount)
+        for (const auto &entry : SUBJECT_CODES)
+        {
+            if (subjectCount[static_cast<int>(entry.code)] > 0)
+            {
+                cout << "  " << entry.name << ": " << subjectCount[static_cast<int>(entry.code)] << endl;
+            }
+        }
+
+        // The health blocks below set fixed/left and their own precision;
+        // later screens expect the defaults back
+        ios::fmtflags coutFlags = cout.flags();
+        streamsize coutPrecision = cout.precision();
+
+        // Background WAL checkpointer health
+        CheckpointStats walStats = dbManager->getCheckpointStats();
+        long long checkpoints = walStats.passiveCheckpoints + walStats.restartCheckpoints;
+        cout << "\nWrite-Ahead Log:" << endl;
+        cout << "  WAL Size: " << walStats.walFrames << " pages ("
+             << fixed << setprecision(1) << (walStats.walBytes / 1024.0) << " KB)" << endl;
+        cout << "  Checkpoints: " << walStats.passiveCheckpoints << " passive, "
+             << walStats.restartCheckpoints << " restart, "
+             << walStats.incompleteCheckpoints << " incomplete" << endl;
+        if (checkpoints > 0)
+        {
+            cout << "  Checkpoint Time: last " << setprecision(2) << walStats.lastDurationMs
+                 << " ms | max " << walStats.maxDurationMs
+                 << " ms | avg " << (walStats.totalDurationMs / checkpoints) << " ms" << endl;
+        }
+
+        // Busy/locked contention per statement (scale out when these climb)
+        auto contention = dbManager->getContentionStats();
+        long long busyHits = 0, retries = 0, failures = 0;
+        for (const auto &entry : contention)
+        {
+            busyHits += entry.busyHits;
+            retries += entry.retries;
+            failures += entry.failures;
+        }
+        cout << "\nDatabase Contention:" << endl;
+        cout << "  Busy: " << busyHits << " | Retries: " << retries << " | Failed: " << failures << endl;
+        for (const auto &entry : contention)
+        {
+            if (entry.busyHits == 0)
+                break;
+            cout << "  " << left << setw(24) << entry.operation << right
+                 << " busy " << entry.busyHits << "/" << entry.executions
+                 << ", retries " << entry.retries
+                 << ", failed " << entry.failures
+                 << ", backoff " << setprecision(0) << entry.backoffMs << " ms" << endl;
+        }
+
+        // Row decoding throughput per entity (rows fetched and mapped per ms)
+        cout << "\nRow Decoding:" << endl;
+        for (const auto &entry : dbManager->getDecodeStats())
         {
-            cout << "  " << pair.first << ": " << pair.second << endl;
+            cout << "  " << left << setw(14) << entry.entity << right
+                 << " " << entry.rows << " rows / " << entry.queries << " queries, "
+                 << setprecision(2) << entry.totalMs << " ms";
+            if (entry.totalMs > 0)
+            {
+                cout << " (" << setprecision(0) << (entry.rows / entry.totalMs) << " rows/ms)";
+            }
+            cout << endl;
         }
+        cout.flags(coutFlags);
+        cout.precision(coutPrecision);
+
+        // Template catalog snapshot: hits skip the database, apart from a
+        // data_version check at most every quarter second
+        CatalogStats catalog = dbManager->getCatalogStats();
+        cout << "\nTemplate Catalog:" << endl;
+        cout << "  Cached: " << catalog.templates << " templates | Hits: " << catalog.hits
+             << " | Loads: " << catalog.loads << " | Invalidations: " << catalog.invalidations << endl;
+
+        // Shared exam papers: one load per template, however many students start it
+        PaperCacheStats papers = dbManager->getPaperCacheStats();
+        cout << "\nExam Papers:" << endl;
+        cout << "  Cached: " << papers.papers << " papers | Hits: " << papers.hits
+             << " | Loads: " << papers.loads << " | Invalidations: " << papers.invalidations << endl;
+
+        JournalStats journal = dbManager->getJournalStats();
+        cout << "\nAnswer Journal:" << endl;
+        cout << "  Records: " << journal.records << "/" << journal.capacity << " | Appends: " << journal.appends
+             << " | Syncs: " << journal.syncs << " | Compactions: " << journal.compactions << endl;
 
         Utils::pauseSystem();
     }
@@ -1820,7 +1999,31 @@ private:
         Utils::clearScreen();
         Utils::printHeader("ALL EXAM RESULTS");
 
-        auto results = dbManager->getAllExamResults();
+        cout << "Filter by date range? (y/N): ";
+        char filter;
+        cin >> filter;
+
+        vector<ExamResult> results;
+        if (filter == 'y' || filter == 'Y')
+        {
+            string fromDate, toDate;
+            cout << "From (YYYY-MM-DD): ";
+            cin >> fromDate;
+            cout << "To (YYYY-MM-DD, inclusive): ";
+            cin >> toDate;
+
+            if (Utils::parseDateTime(fromDate) < 0 || Utils::parseDateTime(toDate) < 0)
+            {
+                cout << "Invalid date!" << endl;
+                Utils::pauseSystem();
+                return;
+            }
+            results = dbManager->getExamResultsByDateRange(fromDate, toDate);
+        }
+        else
+        {
+            results = dbManager->getAllExamResults();
+        }
         if (results.empty())
         {
             cout << "No exam results found!" << endl;
@@ -0,0 +1,172 @@
+#ifndef DEADLINE_SERVICE_H
+#define DEADLINE_SERVICE_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <utility>
+#include "../components/timer_wheel.h"
+#include "../structure/utils.h"
+
+using namespace std;
+
+enum class DeadlineEvent {
+    EXPIRED,        // The deadline itself
+    GRACE_OVER      // The deadline plus its grace period
+};
+
+typedef function<void(DeadlineEvent event, long long dueAtMs)> DeadlineHandler;
+
+struct DeadlineWatcher {
+    DeadlineHandler handler;
+    bool cancelled;
+
+    explicit DeadlineWatcher(DeadlineHandler handler) : handler(move(handler)), cancelled(false) {}
+};
+
+// A registered deadline; both timers are cancelled together
+struct DeadlineWatch {
+    uint64_t expiredTimer;
+    uint64_t graceTimer;
+    shared_ptr<DeadlineWatcher> watcher;
+
+    DeadlineWatch() : expiredTimer(0), graceTimer(0) {}
+    bool isSet() const { return watcher != nullptr; }
+};
+
+// Deadlines of every running exam on one hierarchical timer wheel, driven by
+// a single thread that sleeps until the next timer is due (not polling, and
+// not at all while nothing is registered). Handlers run on that thread, at
+// most one at a time and never after cancel() has returned, so they must be
+// quick and must not call back into the service.
+class DeadlineService {
+public:
+    static constexpr long long TICK_MS = 10;
+
+private:
+    struct Timer {
+        shared_ptr<DeadlineWatcher> watcher;
+        DeadlineEvent event;
+        long long dueAtMs;
+
+        Timer() : event(DeadlineEvent::EXPIRED), dueAtMs(0) {}
+        Timer(shared_ptr<DeadlineWatcher> watcher, DeadlineEvent event, long long dueAtMs)
+            : watcher(move(watcher)), event(event), dueAtMs(dueAtMs) {}
+    };
+
+    TimerWheel<Timer> wheel;
+    mutex wheelMutex;           // Guards wheel and stopRequested
+    mutex dispatchMutex;        // Held while handlers run; guards DeadlineWatcher::cancelled
+    condition_variable wakeup;
+    thread worker;
+    bool stopRequested;
+
+    // A tick fires once the clock has reached its start, so rounding the
+    // due time up never fires early
+    static uint64_t tickAt(long long epochMs) {
+        return static_cast<uint64_t>((epochMs + TICK_MS - 1) / TICK_MS);
+    }
+
+    void run() {
+        vector<Timer> due;
+        unique_lock<mutex> lock(wheelMutex);
+        while (!stopRequested) {
+            wheel.advance(static_cast<uint64_t>(Utils::nowEpochMs() / TICK_MS),
+                          [&due](uint64_t, Timer& timer) { due.push_back(move(timer)); });
+
+            if (!due.empty()) {
+                lock.unlock();
+                {
+                    lock_guard<mutex> dispatch(dispatchMutex);
+                    for (Timer& timer : due) {
+                        if (!timer.watcher->cancelled) {
+                            timer.watcher->handler(timer.event, timer.dueAtMs);
+                        }
+                    }
+                }
+                due.clear();
+                lock.lock();
+                continue;
+            }
+
+            if (wheel.empty()) {
+                wakeup.wait(lock);
+            } else {
+                long long wakeAtMs =
+                    static_cast<long long>(wheel.getCurrentTick() + wheel.ticksUntilNext()) * TICK_MS;
+                wakeup.wait_until(lock, chrono::system_clock::time_point(chrono::milliseconds(wakeAtMs)));
+            }
+        }
+    }
+
+public:
+    DeadlineService() : wheel(static_cast<uint64_t>(Utils::nowEpochMs() / TICK_MS)), stopRequested(false) {
+        worker = thread(&DeadlineService::run, this);
+    }
+
+    ~DeadlineService() {
+        {
+            lock_guard<mutex> lock(wheelMutex);
+            stopRequested = true;
+        }
+        wakeup.notify_one();
+        worker.join();
+    }
+
+    DeadlineService(const DeadlineService&) = delete;
+    DeadlineService& operator=(const DeadlineService&) = delete;
+
+    // The process-wide service every exam session registers with
+    static DeadlineService& shared() {
+        static DeadlineService service;
+        return service;
+    }
+
+    // Call handler(EXPIRED) at deadlineMs and, when graceMs > 0, handler(GRACE_OVER)
+    // at deadlineMs + graceMs. A deadline already past fires straight away.
+    DeadlineWatch watch(long long deadlineMs, long long graceMs, DeadlineHandler handler) {
+        shared_ptr<DeadlineWatcher> watcher = make_shared<DeadlineWatcher>(move(handler));
+        DeadlineWatch result;
+        result.watcher = watcher;
+        {
+            lock_guard<mutex> lock(wheelMutex);
+            result.expiredTimer =
+                wheel.schedule(tickAt(deadlineMs), Timer(watcher, DeadlineEvent::EXPIRED, deadlineMs));
+            if (graceMs > 0) {
+                result.graceTimer = wheel.schedule(tickAt(deadlineMs + graceMs),
+                                                   Timer(watcher, DeadlineEvent::GRACE_OVER, deadlineMs + graceMs));
+            }
+        }
+        wakeup.notify_one();
+        return result;
+    }
+
+    // No handler of this watch runs once cancel returns
+    void cancel(DeadlineWatch& deadline) {
+        if (!deadline.isSet()) return;
+
+        {
+            lock_guard<mutex> lock(wheelMutex);
+            wheel.cancel(deadline.expiredTimer);
+            wheel.cancel(deadline.graceTimer);
+        }
+        // A timer already taken off the wheel for dispatch is skipped, and
+        // one being dispatched right now is waited out
+        {
+            lock_guard<mutex> dispatch(dispatchMutex);
+            deadline.watcher->cancelled = true;
+        }
+        deadline = DeadlineWatch();
+    }
+
+    size_t getPendingCount() {
+        lock_guard<mutex> lock(wheelMutex);
+        return wheel.size();
+    }
+};
+
+#endif // DEADLINE_SERVICE_H
@@ -22,6 +22,9 @@ private:
     int correctAnswer;
     string explanation;
 
+    // Column descriptors bind straight to the fields (database/database.cpp)
+    friend struct EntityColumns;
+
 public:
     ExamQuestion() : id(0), examTemplateId(0), questionNumber(0), correctAnswer(0) {
         options.resize(4);
@@ -191,6 +194,12 @@ private:
             examTemplate.setNegativeMarkValue(negValue);
         }
 
+        cout << "Penalise Unanswered Questions? (y/N): ";
+        cin >> choice;
+        if (choice == 'y' || choice == 'Y') {
+            examTemplate.setSkipPenalty(Utils::getSafeDouble("Skip Penalty (0.0-1.0, e.g., 0.25): ", 0.0, 1.0));
+        }
+
         cout << "Shuffle Questions? (Y/n): ";
         cin >> choice;
         examTemplate.setShuffleQuestions(choice != 'n' && choice != 'N');
@@ -0,0 +1,277 @@
+#ifndef EXAM_SESSION_H
+#define EXAM_SESSION_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "../database/database.h"
+#include "../features/exam_template.h"
+#include "../components/permutation.h"
+#include "../components/grading_kernel.h"
+
+using namespace std;
+
+// The template settings a session runs under, copied so a session does not
+// keep the template (and its strings) alive
+struct ExamRules {
+    // Answers entered this long after the time limit still count; an
+    // auto-submit session is submitted when it runs out
+    static constexpr long long DEFAULT_GRACE_MS = 5000;
+
+    int examTemplateId;
+    int timeLimit;              // Minutes, 0 = untimed
+    double passingPercentage;
+    MarkingScheme marking;
+    bool allowReview;
+    bool autoSubmit;            // Submit when the time runs out
+    long long graceMs;
+
+    ExamRules() : examTemplateId(0), timeLimit(0), passingPercentage(60.0), allowReview(false), autoSubmit(true),
+                  graceMs(DEFAULT_GRACE_MS) {}
+
+    explicit ExamRules(const ExamTemplate& examTemplate)
+        : examTemplateId(examTemplate.getId()), timeLimit(examTemplate.getTimeLimit()),
+          passingPercentage(examTemplate.getPassingPercentage()),
+          marking(examTemplate.hasNegativeMarking(), examTemplate.getNegativeMarkValue(),
+                  examTemplate.getSkipPenalty()),
+          allowReview(examTemplate.isReviewAllowed()), autoSubmit(examTemplate.isAutoSubmit()),
+          graceMs(DEFAULT_GRACE_MS) {}
+};
+
+// Marks of a graded session
+struct ExamScore {
+    double score;           // Correct answers less penalties, never below 0
+    int correct;
+    int answered;
+    double percentage;
+    bool passed;
+    double negativeMarks;   // Taken off for wrong answers
+    double skipPenalties;   // Taken off for unanswered questions
+
+    ExamScore() : score(0.0), correct(0), answered(0), percentage(0.0), passed(false), negativeMarks(0.0),
+                  skipPenalties(0.0) {}
+};
+
+enum class SessionState {
+    IN_PROGRESS,
+    SUBMITTED
+};
+
+// One student's attempt at an exam, with no I/O: the caller feeds it
+// navigation and answers and renders whatever it likes. The questions live
+// in a shared paper; the session itself keeps 6 bytes per question (paper
+// index, option order code, flags, answer and answer key) plus a fixed
+// header, so one process can hold thousands of them. Answers and the key
+// are kept as display slots in byte arrays of their own, so grading is one
+// GradingKernel pass with no lookups into the paper. Operations return false when they do
+// not apply (after submission, review not allowed, bad slot).
+//
+// Positions run 0..size()-1 in the order the student sees the questions;
+// position size() means "past the last question", which the console treats
+// as a request to submit.
+class ExamSession {
+public:
+    static const size_t MAX_QUESTIONS = 65535;
+
+private:
+    struct QuestionSlot {
+        uint16_t paperIndex;
+        uint8_t optionCode;     // OPTION_ORDERS row
+        uint8_t flags;          // MARKED
+    };
+
+    static const uint8_t MARKED = 0x01;
+
+    shared_ptr<const ExamPaper> paper;
+    ExamRules rules;
+    vector<QuestionSlot> slots;
+    vector<uint8_t> answers;    // Display slot picked per position, UNANSWERED if none
+    vector<uint8_t> answerKey;  // Display slot of the correct option per position
+    long long startedAtMs;
+    long long endedAtMs;        // 0 until submitted
+    uint32_t position;
+    uint32_t answeredCount;
+    uint32_t markedCount;
+    SessionState state;
+
+public:
+    // order[i] is the paper index shown at position i and optionCodes[i] its
+    // option order; papers longer than MAX_QUESTIONS are cut short
+    ExamSession(shared_ptr<const ExamPaper> paper, const ExamRules& rules, const vector<size_t>& order,
+                const vector<uint8_t>& optionCodes, long long startedAtMs)
+        : paper(move(paper)), rules(rules), startedAtMs(startedAtMs), endedAtMs(0),
+          position(0), answeredCount(0), markedCount(0), state(SessionState::IN_PROGRESS) {
+        size_t count = order.size() < MAX_QUESTIONS ? order.size() : MAX_QUESTIONS;
+        slots.reserve(count);
+        answers.assign(count, UNANSWERED);
+        answerKey.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            QuestionSlot slot;
+            slot.paperIndex = static_cast<uint16_t>(order[i]);
+            slot.optionCode = i < optionCodes.size() ? optionCodes[i] : 0;
+            slot.flags = 0;
+            slots.push_back(slot);
+            answerKey.push_back(static_cast<uint8_t>(
+                optionSlot(slot.optionCode, this->paper->questions[slot.paperIndex].getCorrectAnswer())));
+        }
+    }
+
+    // State
+    size_t size() const { return slots.size(); }
+    size_t getPosition() const { return position; }
+    bool atEnd() const { return position >= slots.size(); }
+    SessionState getState() const { return state; }
+    bool isSubmitted() const { return state == SessionState::SUBMITTED; }
+    const ExamRules& getRules() const { return rules; }
+    long long getStartedAtMs() const { return startedAtMs; }
+    long long getEndedAtMs() const { return endedAtMs; }
+    int getAnsweredCount() const { return static_cast<int>(answeredCount); }
+    int getMarkedCount() const { return static_cast<int>(markedCount); }
+
+    // Per position
+    const Question& question(size_t at) const { return paper->questions[slots[at].paperIndex]; }
+    uint8_t optionCode(size_t at) const { return slots[at].optionCode; }
+    const uint8_t* optionOrder(size_t at) const { return OPTION_ORDERS[slots[at].optionCode]; }
+    bool isAnswered(size_t at) const { return answers[at] != UNANSWERED; }
+    bool isMarked(size_t at) const { return slots[at].flags & MARKED; }
+
+    // Display slot picked at `at`, -1 if unanswered
+    int answerSlot(size_t at) const {
+        return isAnswered(at) ? answers[at] : -1;
+    }
+
+    // Original option behind the picked slot, -1 if unanswered
+    int answerOption(size_t at) const {
+        return isAnswered(at) ? originalOption(slots[at].optionCode, answers[at]) : -1;
+    }
+
+    // Display slot holding the correct option
+    int correctSlot(size_t at) const {
+        return answerKey[at];
+    }
+
+    bool isCorrect(size_t at) const {
+        return answers[at] == answerKey[at];
+    }
+
+    // Navigation
+    bool goTo(size_t at) {
+        if (isSubmitted() || at > slots.size()) return false;
+        position = static_cast<uint32_t>(at);
+        return true;
+    }
+
+    bool next() {
+        return goTo(position + 1);
+    }
+
+    bool previous() {
+        return position > 0 && goTo(position - 1);
+    }
+
+    // Record `slot` (0-3, as displayed) for the current question and move on
+    bool answer(int slot) {
+        if (isSubmitted() || atEnd() || slot < 0 || slot >= OPTION_COUNT) return false;
+        if (!isAnswered(position)) answeredCount++;
+        answers[position] = static_cast<uint8_t>(slot);
+        position++;
+        return true;
+    }
+
+    bool toggleReview() {
+        if (isSubmitted() || atEnd() || !rules.allowReview) return false;
+        QuestionSlot& current = slots[position];
+        current.flags ^= MARKED;
+        if (current.flags & MARKED) markedCount++;
+        else markedCount--;
+        return true;
+    }
+
+    bool submit(long long nowMs) {
+        if (isSubmitted()) return false;
+        state = SessionState::SUBMITTED;
+        endedAtMs = nowMs;
+        return true;
+    }
+
+    // Timing, in epoch milliseconds. The deadline is exact; minutes are
+    // only for display.
+    bool isTimed() const { return rules.timeLimit > 0; }
+
+    // When the time limit runs out, 0 if untimed
+    long long deadlineMs() const {
+        return isTimed() ? startedAtMs + rules.timeLimit * 60000LL : 0;
+    }
+
+    // When an auto-submit session is submitted: the deadline plus grace
+    long long cutoffMs() const {
+        return isTimed() ? deadlineMs() + rules.graceMs : 0;
+    }
+
+    long long elapsedMs(long long nowMs) const {
+        return (isSubmitted() ? endedAtMs : nowMs) - startedAtMs;
+    }
+
+    int elapsedMinutes(long long nowMs) const {
+        return static_cast<int>(elapsedMs(nowMs) / 60000);
+    }
+
+    long long remainingMs(long long nowMs) const {
+        long long remaining = deadlineMs() - nowMs;
+        return remaining > 0 ? remaining : 0;
+    }
+
+    int remainingMinutes(long long nowMs) const {
+        return static_cast<int>(remainingMs(nowMs) / 60000);
+    }
+
+    bool isTimeUp(long long nowMs) const {
+        return isTimed() && nowMs >= deadlineMs();
+    }
+
+    // Submits an auto-submit session past its cutoff, as of the cutoff, so
+    // nothing entered later counts; true if the session is now over
+    bool checkTime(long long nowMs) {
+        if (!isSubmitted() && rules.autoSubmit && isTimed() && nowMs >= cutoffMs()) {
+            submit(cutoffMs());
+        }
+        return isSubmitted();
+    }
+
+    bool usesPaper(const shared_ptr<const ExamPaper>& other) const { return paper == other; }
+
+    // Takes the answer key from `current`, a later load of the same paper, so
+    // an attempt still running when an admin corrects the key is graded and
+    // saved with the correction. The questions shown stay the ones it started
+    // with; any no longer on `current` keep the key they had.
+    void updateKey(const ExamPaper& current) {
+        HashTable<int, uint32_t> byId;
+        byId.reserve(current.questions.size());
+        for (size_t i = 0; i < current.questions.size(); ++i) {
+            byId.insert(current.questions[i].getId(), static_cast<uint32_t>(i));
+        }
+        for (size_t i = 0; i < slots.size(); ++i) {
+            const uint32_t* index = byId.find(question(i).getId());
+            if (index) {
+                answerKey[i] = static_cast<uint8_t>(
+                    optionSlot(slots[i].optionCode, current.questions[*index].getCorrectAnswer()));
+            }
+        }
+    }
+
+    // Grading
+    ExamScore grade() const {
+        GradeMarks marks = GradingPolicies::grade(answers.data(), answerKey.data(), answers.size(), rules.marking);
+        ExamScore result;
+        result.correct = static_cast<int>(marks.counts.correct);
+        result.answered = static_cast<int>(answeredCount);
+        result.score = marks.score;
+        result.negativeMarks = marks.negativeMarks;
+        result.skipPenalties = marks.skipPenalties;
+        result.percentage = slots.empty() ? 0.0 : (result.score * 100.0) / slots.size();
+        result.passed = result.percentage >= rules.passingPercentage;
+        return result;
+    }
+};
+
+#endif // EXAM_SESSION_H
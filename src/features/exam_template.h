@@ -3,29 +3,24 @@
 
 #include <string>
 #include <vector>
+#include "../structure/codes.h"
 
 using namespace std;
 
-// Exam type enumeration
-enum class ExamType {
-    QUIZ = 1,       // Short
-    WORKSHEET = 2,  // Practice/homework 
-    FINAL = 3       // Comprehensive exam 
-};
-
 // Exam template class for admin-defined exam configurations
 class ExamTemplate {
 private:
     int id;
     string templateName;
     ExamType examType;
-    string subject;
+    Subject subject;
     int questionCount;
     int timeLimit;           // in minutes
-    string difficulty;       // Easy, Medium, Hard, Mixed
+    Difficulty difficulty;   // Easy, Medium, Hard, Mixed
     double passingPercentage;
     bool negativeMarking;
     double negativeMarkValue;
+    double skipPenalty;      // Taken off per unanswered question, 0 = none
     bool shuffleQuestions;
     bool shuffleOptions;
     bool allowReview;
@@ -36,19 +31,22 @@ private:
     string updatedAt;
     bool isActive;
 
+    // Column descriptors bind straight to the fields (database/database.cpp)
+    friend struct EntityColumns;
+
 public:
     // Constructors
-    ExamTemplate() : id(0), examType(ExamType::QUIZ), questionCount(10), 
-                     timeLimit(15), difficulty("Medium"), passingPercentage(60.0),
-                     negativeMarking(false), negativeMarkValue(0.25),
+    ExamTemplate() : id(0), examType(ExamType::QUIZ), subject(Subject::NONE), questionCount(10), 
+                     timeLimit(15), difficulty(Difficulty::MEDIUM), passingPercentage(60.0),
+                     negativeMarking(false), negativeMarkValue(0.25), skipPenalty(0.0),
                      shuffleQuestions(true), shuffleOptions(false),
                      allowReview(true), autoSubmit(true), createdBy(0), isActive(true) {}
     
     ExamTemplate(int id, const string& name, ExamType type, const string& subj,
                  int qCount, int timeLimit, const string& diff = "Medium")
-        : id(id), templateName(name), examType(type), subject(subj),
-          questionCount(qCount), timeLimit(timeLimit), difficulty(diff),
-          passingPercentage(60.0), negativeMarking(false), negativeMarkValue(0.25),
+        : id(id), templateName(name), examType(type), subject(SUBJECT_CODES.code(subj)),
+          questionCount(qCount), timeLimit(timeLimit), difficulty(DIFFICULTY_CODES.code(diff)),
+          passingPercentage(60.0), negativeMarking(false), negativeMarkValue(0.25), skipPenalty(0.0),
           shuffleQuestions(true), shuffleOptions(false), allowReview(true),
           autoSubmit(true), createdBy(0), isActive(true) {}
 
@@ -56,21 +54,18 @@ public:
     int getId() const { return id; }
     string getTemplateName() const { return templateName; }
     ExamType getExamType() const { return examType; }
-    string getExamTypeString() const {
-        switch (examType) {
-            case ExamType::QUIZ: return "QUIZ";
-            case ExamType::WORKSHEET: return "WORKSHEET";
-            case ExamType::FINAL: return "FINAL";
-            default: return "UNKNOWN";
-        }
-    }
-    string getSubject() const { return subject; }
+    string getExamTypeString() const { return EXAM_TYPE_CODES.name(examType); }
+    string getSubject() const { return SUBJECT_CODES.name(subject); }
+    Subject getSubjectCode() const { return subject; }
     int getQuestionCount() const { return questionCount; }
     int getTimeLimit() const { return timeLimit; }
-    string getDifficulty() const { return difficulty; }
+    string getDifficulty() const { return DIFFICULTY_CODES.name(difficulty); }
+    Difficulty getDifficultyCode() const { return difficulty; }
     double getPassingPercentage() const { return passingPercentage; }
     bool hasNegativeMarking() const { return negativeMarking; }
     double getNegativeMarkValue() const { return negativeMarkValue; }
+    double getSkipPenalty() const { return skipPenalty; }
+    bool hasSkipPenalty() const { return skipPenalty > 0; }
     bool shouldShuffleQuestions() const { return shuffleQuestions; }
     bool shouldShuffleOptions() const { return shuffleOptions; }
     bool isReviewAllowed() const { return allowReview; }
@@ -86,17 +81,19 @@ public:
     void setTemplateName(const string& name) { templateName = name; }
     void setExamType(ExamType type) { examType = type; }
     void setExamTypeFromString(const string& typeStr) {
-        if (typeStr == "QUIZ") examType = ExamType::QUIZ;
-        else if (typeStr == "WORKSHEET") examType = ExamType::WORKSHEET;
-        else if (typeStr == "FINAL") examType = ExamType::FINAL;
+        ExamType type = EXAM_TYPE_CODES.code(typeStr);
+        if (type != ExamType::NONE) examType = type;
     }
-    void setSubject(const string& subj) { subject = subj; }
+    void setSubject(Subject subj) { subject = subj; }
+    void setSubject(const string& subj) { subject = SUBJECT_CODES.code(subj); }
     void setQuestionCount(int count) { questionCount = count; }
     void setTimeLimit(int limit) { timeLimit = limit; }
-    void setDifficulty(const string& diff) { difficulty = diff; }
+    void setDifficulty(Difficulty diff) { difficulty = diff; }
+    void setDifficulty(const string& diff) { difficulty = DIFFICULTY_CODES.code(diff); }
     void setPassingPercentage(double percentage) { passingPercentage = percentage; }
     void setNegativeMarking(bool enabled) { negativeMarking = enabled; }
     void setNegativeMarkValue(double value) { negativeMarkValue = value; }
+    void setSkipPenalty(double value) { skipPenalty = value; }
     void setShuffleQuestions(bool shuffle) { shuffleQuestions = shuffle; }
     void setShuffleOptions(bool shuffle) { shuffleOptions = shuffle; }
     void setAllowReview(bool allow) { allowReview = allow; }
@@ -109,7 +106,7 @@ public:
 
     // Validation
     bool isValid() const {
-        return !templateName.empty() && !subject.empty() && 
+        return !templateName.empty() && subject != Subject::NONE && 
                questionCount > 0 && timeLimit > 0 && 
                passingPercentage >= 0 && passingPercentage <= 100;
     }
@@ -118,10 +115,10 @@ public:
     void display() const {
         cout << "Template: " << templateName << endl;
         cout << "Type: " << getExamTypeString() << endl;
-        cout << "Subject: " << subject << endl;
+        cout << "Subject: " << getSubject() << endl;
         cout << "Questions: " << questionCount << endl;
         cout << "Time Limit: " << timeLimit << " minutes" << endl;
-        cout << "Difficulty: " << difficulty << endl;
+        cout << "Difficulty: " << getDifficulty() << endl;
         cout << "Passing: " << passingPercentage << "%" << endl;
         if (!instructions.empty()) {
             cout << "Instructions: " << instructions << endl;
@@ -134,6 +131,9 @@ public:
         if (negativeMarking) {
             cout << "Negative Mark Value: " << negativeMarkValue << endl;
         }
+        if (skipPenalty > 0) {
+            cout << "Skip Penalty: " << skipPenalty << endl;
+        }
         cout << "Shuffle Questions: " << (shuffleQuestions ? "Yes" : "No") << endl;
         cout << "Shuffle Options: " << (shuffleOptions ? "Yes" : "No") << endl;
         cout << "Allow Review: " << (allowReview ? "Yes" : "No") << endl;
@@ -4,16 +4,19 @@
 #include "../authentication/user.h"
 #include "../database/database.h"
 #include "../structure/utils.h"
+#include "../structure/console_events.h"
 #include "../features/exam_template.h"
+#include "../features/exam_session.h"
+#include "../features/deadline_service.h"
 #include "../components/stack.h"
-#include "../components/sorting.h"
+#include "../components/permutation.h"
 #include <iostream>
 #include <vector>
 #include <string>
 #include <algorithm>
 #include <chrono>
 #include <map>
-#include <random>
+#include <functional>
 
 // State enum for student navigation
 enum class StudentState
@@ -27,6 +30,131 @@ enum class StudentState
     LOGOUT
 };
 
+// Input and output for a running exam. Where ConsoleEvents is available the
+// status row (with the countdown) is redrawn every second while the student
+// types, deadline notices are printed as they arrive, and a read returns
+// false the moment time closes the session, with no Enter needed. Elsewhere
+// it reads cin and the session is closed at the next input.
+class ExamConsole
+{
+private:
+    ExamSession &session;
+    ConsoleEvents events;
+    int statusRow; // Screen row (from 1) the status line is drawn on
+    function<string(long long)> statusLine;
+    string prompt;
+
+    // Next line typed; false once the session is over
+    bool nextLine(string &line)
+    {
+        for (;;)
+        {
+            ConsoleEvent event = events.next();
+            long long nowMs = Utils::nowEpochMs();
+            switch (event.type)
+            {
+            case ConsoleEventType::LINE:
+                line = event.text;
+                return true;
+            case ConsoleEventType::TICK:
+                if (session.checkTime(nowMs))
+                    return false;
+                // Save the cursor, rewrite the status row, restore: the line
+                // being typed is left alone
+                cout << "\0337\033[" << statusRow << ";1H" << statusLine(nowMs) << "\033[K\0338" << flush;
+                break;
+            case ConsoleEventType::NOTICE:
+                cout << event.text << endl;
+                if (session.checkTime(nowMs))
+                    return false;
+                cout << prompt << flush;
+                break;
+            case ConsoleEventType::CLOSED:
+                session.submit(nowMs);
+                return false;
+            }
+        }
+    }
+
+public:
+    ExamConsole(ExamSession &session, int statusRow, function<string(long long)> statusLine)
+        : session(session), statusRow(statusRow), statusLine(move(statusLine))
+    {
+        // Input cin has already buffered would never reach the event loop,
+        // so it is only used when there is none. Ticks land on whole seconds
+        // before the deadline, so the one that closes the session falls
+        // exactly on its cutoff.
+        if (cin.rdbuf()->in_avail() == 0 && events.open() && session.isTimed())
+        {
+            events.startTicker(1000, session.deadlineMs());
+        }
+    }
+
+    ~ExamConsole()
+    {
+        close();
+    }
+
+    // Back to plain cin, which gets any input typed but not yet read
+    void close()
+    {
+        events.close();
+    }
+
+    // For posting notices from other threads; null without an event loop
+    ConsoleEvents *eventLoop()
+    {
+        return events.isOpen() ? &events : nullptr;
+    }
+
+    string status(long long nowMs) const
+    {
+        return statusLine(nowMs);
+    }
+
+    // Next whitespace-delimited word
+    bool read(const string &text, string &word)
+    {
+        prompt = text;
+        cout << prompt << flush;
+        if (!events.isOpen())
+        {
+            if (cin >> word)
+                return true;
+            session.submit(Utils::nowEpochMs());
+            return false;
+        }
+
+        string line;
+        while (nextLine(line))
+        {
+            istringstream words(line);
+            if (words >> word)
+                return true; // Blank lines are skipped, as cin >> does
+        }
+        return false;
+    }
+
+    bool confirm(const string &text)
+    {
+        string answer;
+        return read(text, answer) && (answer[0] == 'y' || answer[0] == 'Y');
+    }
+
+    void pause()
+    {
+        if (!events.isOpen())
+        {
+            Utils::pauseSystem();
+            return;
+        }
+        prompt = "\nPress Enter to continue...";
+        cout << prompt << flush;
+        string line;
+        nextLine(line);
+    }
+};
+
 // Enhanced StudentPanel with comprehensive exam functionality
 class StudentPanel
 {
@@ -194,37 +322,43 @@ private:
         }
     }
 
-    // DSA: Custom randomization using Merge Sort
-    void randomizeQuestions(vector<Question> &questions)
+    // Positions 0..n-1 in paper order
+    static vector<size_t> identityOrder(size_t n)
     {
-        if (questions.empty())
-            return;
-
-        // Create pairs of (random_value, question) for sorting
-        vector<pair<int, Question>> randomPairs;
-        random_device rd;
-        mt19937 gen(rd());
-        uniform_int_distribution<> dis(1, 100000);
-
-        for (const auto &q : questions)
+        vector<size_t> order(n);
+        for (size_t i = 0; i < n; ++i)
         {
-            randomPairs.push_back({dis(gen), q});
+            order[i] = i;
         }
+        return order;
+    }
 
-        // DSA: Use Merge Sort with custom comparator to sort by random values
-        SortingAlgorithms<pair<int, Question>>::mergeSortCustom(
-            randomPairs, 0, randomPairs.size() - 1,
-            [](const pair<int, Question> &a, const pair<int, Question> &b)
-            {
-                return a.first < b.first; // Sort by random value
-            });
+    // Question order for one attempt: a Fisher-Yates permutation of paper
+    // indexes keyed by (template, student, attempt start). The start time is
+    // saved with the result, so the order can be rebuilt from it later.
+    static vector<size_t> attemptOrder(const ExamTemplate &examTemplate, int userId,
+                                       long long startedAtMs, size_t n)
+    {
+        if (!examTemplate.shouldShuffleQuestions())
+            return identityOrder(n);
+        return seededPermutation(n, permutationKey(examTemplate.getId(), userId, startedAtMs));
+    }
 
-        // Extract sorted questions (now randomized)
-        questions.clear();
-        for (const auto &pair : randomPairs)
-        {
-            questions.push_back(pair.second);
-        }
+    // Option order of each displayed question, one byte (OPTION_ORDERS code)
+    // per question, from the same attempt key
+    static vector<uint8_t> attemptOptionCodes(const ExamTemplate &examTemplate, int userId,
+                                              long long startedAtMs, size_t n)
+    {
+        if (!examTemplate.shouldShuffleOptions())
+            return vector<uint8_t>(n, 0);
+        return seededOptionCodes(n, permutationKey(examTemplate.getId(), userId, startedAtMs));
+    }
+
+    // Shuffle just the first `limit` questions into place (a uniform sample)
+    void randomizeQuestions(vector<Question> &questions, size_t limit)
+    {
+        long long seed = Utils::nowEpochMs();
+        seededShuffle(questions, permutationKey(0, currentStudent.getId(), seed), limit);
     }
 
     void takeExam()
@@ -246,10 +380,10 @@ private:
         }
 
         // Display templates by type
-        map<string, vector<ExamTemplate>> templatesByType;
+        map<ExamType, vector<ExamTemplate>> templatesByType;
         for (const auto &tmpl : templates)
         {
-            templatesByType[tmpl.getExamTypeString()].push_back(tmpl);
+            templatesByType[tmpl.getExamType()].push_back(tmpl);
         }
 
         cout << "\n Select Exam Type:" << endl;
@@ -266,13 +400,13 @@ private:
         switch (typeChoice)
         {
         case 1:
-            selectAndTakeTemplateExam("QUIZ", templatesByType["QUIZ"]);
+            selectAndTakeTemplateExam("QUIZ", templatesByType[ExamType::QUIZ]);
             break;
         case 2:
-            selectAndTakeTemplateExam("WORKSHEET", templatesByType["WORKSHEET"]);
+            selectAndTakeTemplateExam("WORKSHEET", templatesByType[ExamType::WORKSHEET]);
             break;
         case 3:
-            selectAndTakeTemplateExam("FINAL", templatesByType["FINAL"]);
+            selectAndTakeTemplateExam("FINAL", templatesByType[ExamType::FINAL]);
             break;
         case 4:
             takeCustomExam();
@@ -348,6 +482,10 @@ private:
         {
             cout << "• Negative marking: -" << selectedTemplate.getNegativeMarkValue() << " for wrong answers" << endl;
         }
+        if (selectedTemplate.hasSkipPenalty())
+        {
+            cout << "• Skip penalty: -" << selectedTemplate.getSkipPenalty() << " for unanswered questions" << endl;
+        }
 
         cout << "\n Ready to start? (y/N): ";
         char confirm;
@@ -361,23 +499,11 @@ private:
 
     void startTemplateExam(const ExamTemplate &examTemplate)
     {
-        // Get questions specific to this exam template
-        auto examQuestions = dbManager->getExamQuestions(examTemplate.getId());
-
-        // Convert ExamQuestion to Question for compatibility
-        vector<Question> questions;
-        for (const auto &eq : examQuestions)
-        {
-            Question q;
-            q.setId(eq.getId());
-            q.setQuestionText(eq.getQuestionText());
-            q.setOptions(eq.getOptions());
-            q.setCorrectAnswer(eq.getCorrectAnswer());
-            q.setExplanation(eq.getExplanation());
-            q.setSubject(examTemplate.getSubject());
-            q.setDifficulty(examTemplate.getDifficulty());
-            questions.push_back(q);
-        }
+        // Every session of this template shares one immutable paper
+        // (explanations are loaded later, only when the review is rendered).
+        // This session owns only its question order and its answers.
+        shared_ptr<const ExamPaper> paper = dbManager->getSharedExamPaper(examTemplate.getId());
+        const vector<Question> &questions = paper->questions;
 
         if (questions.empty())
         {
@@ -387,30 +513,152 @@ private:
             return;
         }
 
-        // DSA: Randomize questions using Merge Sort if enabled
-        if (examTemplate.shouldShuffleQuestions())
+        // An attempt cut short (crash, closed terminal) is resumed from the
+        // answer journal: the same start time rebuilds the same question and
+        // option order, then its events are replayed onto the session
+        long long startedAtMs = Utils::nowEpochMs();
+        AnswerJournal *answerJournal = dbManager->getAnswerJournal(currentStudent.getId());
+        vector<JournalRecord> unfinished;
+        if (answerJournal)
         {
-            randomizeQuestions(questions); // DSA: Merge Sort randomization
+            unfinished = answerJournal->unfinishedAttempt(currentStudent.getId(), examTemplate.getId());
         }
 
+        bool resume = false;
+        if (!unfinished.empty())
+        {
+            long long unfinishedStartMs = unfinished.front().startedAtMs;
+            if (unfinished.front().position != questions.size())
+            {
+                cout << "\n This exam has changed since your unfinished attempt; a new attempt will start." << endl;
+            }
+            else
+            {
+                cout << "\n You have an unfinished attempt at this exam (started "
+                     << Utils::formatEpochMs(unfinishedStartMs) << ")." << endl;
+                cout << " Resume it? (Y/n): ";
+                char confirm;
+                cin >> confirm;
+                resume = !(confirm == 'n' || confirm == 'N');
+            }
+
+            if (resume)
+            {
+                startedAtMs = unfinishedStartMs;
+            }
+            else
+            {
+                answerJournal->append(JournalRecord(JournalEvent::SUBMIT, currentStudent.getId(),
+                                                    examTemplate.getId(), unfinishedStartMs, 0));
+            }
+        }
+
+        vector<size_t> order = attemptOrder(examTemplate, currentStudent.getId(), startedAtMs, questions.size());
+        vector<uint8_t> optionCodes =
+            attemptOptionCodes(examTemplate, currentStudent.getId(), startedAtMs, questions.size());
+
         // Start the exam with template settings
-        conductTemplateExam(questions, examTemplate);
+        ExamSession session(paper, ExamRules(examTemplate), order, optionCodes, startedAtMs);
+        if (resume)
+        {
+            replayJournal(session, unfinished);
+        }
+        else
+        {
+            // A START records the paper size, so a changed paper is not resumed
+            journal(session, JournalEvent::START, questions.size());
+        }
+        conductTemplateExam(session, examTemplate);
+    }
+
+    // Autosave one session event; custom exams (no template id) cannot be
+    // rebuilt, so they are not journalled
+    void journal(const ExamSession &session, JournalEvent event, size_t position, int slot = -1)
+    {
+        AnswerJournal *answerJournal = dbManager->getAnswerJournal(currentStudent.getId());
+        if (answerJournal && session.getRules().examTemplateId != 0)
+        {
+            answerJournal->append(JournalRecord(event, currentStudent.getId(), session.getRules().examTemplateId,
+                                                session.getStartedAtMs(), position, slot));
+        }
+    }
+
+    static void replayJournal(ExamSession &session, const vector<JournalRecord> &events)
+    {
+        for (const JournalRecord &event : events)
+        {
+            size_t position = event.position;
+            switch (event.getEvent())
+            {
+            case JournalEvent::ANSWER:
+                if (session.goTo(position))
+                    session.answer(event.slot);
+                break;
+            case JournalEvent::MARK:
+                if (position < session.size() && session.goTo(position) &&
+                    session.isMarked(position) != (event.slot == 1))
+                    session.toggleReview();
+                break;
+            case JournalEvent::MOVE:
+                session.goTo(position);
+                break;
+            default:
+                break;
+            }
+        }
     }
 
-    void conductTemplateExam(const vector<Question> &questions, const ExamTemplate &examTemplate)
+    // Tell a student waiting at the prompt that time is up the moment it is.
+    // The session is only ever touched on this thread: checkTime submits it
+    // as of its cutoff, and input read later is dropped. With an event loop
+    // the notice is handed to it, so this thread prints it between reads.
+    static DeadlineWatch watchDeadline(const ExamSession &session, ConsoleEvents *events)
+    {
+        if (!session.isTimed())
+            return DeadlineWatch();
+
+        bool autoSubmit = session.getRules().autoSubmit;
+        long long graceMs = autoSubmit ? session.getRules().graceMs : 0;
+        return DeadlineService::shared().watch(
+            session.deadlineMs(), graceMs, [autoSubmit, graceMs, events](DeadlineEvent event, long long)
+            {
+                ostringstream notice;
+                if (!autoSubmit)
+                    notice << "\n\n Time's up! Please submit your exam.";
+                else if (event == DeadlineEvent::EXPIRED && graceMs > 0)
+                    notice << "\n\n Time's up! An answer entered in the next " << graceMs / 1000
+                           << " seconds still counts.";
+                else if (events)
+                    notice << "\n\n Time's up! Your exam has been submitted.";
+                else
+                    notice << "\n\n Time's up! The exam is closed. Press Enter to see your results.";
+
+                if (events)
+                    events->post(notice.str());
+                else
+                    cout << notice.str() << endl;
+            });
+    }
+
+    static string formatRemaining(long long remainingMs)
+    {
+        long long seconds = (remainingMs + 999) / 1000;
+        ostringstream text;
+        text << seconds / 60 << ":" << setw(2) << setfill('0') << seconds % 60;
+        return text.str();
+    }
+
+    // Console front end for an ExamSession: reads a command, applies it to
+    // the session and redraws. All exam state and grading live in the session.
+    void conductTemplateExam(ExamSession &session, const ExamTemplate &examTemplate)
     {
         Utils::clearScreen();
         Utils::printHeader("EXAM IN PROGRESS - " + examTemplate.getTemplateName());
 
-        vector<int> userAnswers(questions.size(), -1);
-        vector<bool> answered(questions.size(), false);
-        vector<bool> markedForReview(questions.size(), false);
-        auto startTime = chrono::steady_clock::now();
-
         cout << " Exam Started!" << endl;
         cout << " Template: " << examTemplate.getTemplateName() << endl;
         cout << " Subject: " << examTemplate.getSubject() << endl;
-        cout << " Questions: " << questions.size() << endl;
+        cout << " Questions: " << session.size() << endl;
         cout << " Time Limit: " << examTemplate.getTimeLimit() << " minutes" << endl;
         cout << " Passing Score: " << examTemplate.getPassingPercentage() << "%" << endl;
 
@@ -418,6 +666,10 @@ private:
         {
             cout << "  Negative Marking: -" << examTemplate.getNegativeMarkValue() << " per wrong answer" << endl;
         }
+        if (examTemplate.hasSkipPenalty())
+        {
+            cout << "  Skip Penalty: -" << examTemplate.getSkipPenalty() << " per unanswered question" << endl;
+        }
 
         cout << "\n Instructions:" << endl;
         cout << "• Enter a-d or 1-4 for your answer" << endl;
@@ -439,18 +691,32 @@ private:
         cin.ignore();
         cin.get();
 
-        int currentQuestion = 0;
-        bool examCompleted = false;
-
-        while (!examCompleted && currentQuestion < static_cast<int>(questions.size()))
+        // First screen row: name | position | answered | marked | time left
+        ExamConsole console(session, 1, [&session, &examTemplate](long long nowMs)
+                            {
+                                ostringstream line;
+                                line << " " << examTemplate.getTemplateName() << " | ";
+                                line << "" << (session.getPosition() + 1) << "/" << session.size() << " | ";
+                                line << " " << session.getAnsweredCount() << " | ";
+                                if (examTemplate.isReviewAllowed())
+                                {
+                                    line << "🔍 " << session.getMarkedCount() << " | ";
+                                }
+                                if (session.isTimed())
+                                {
+                                    line << " " << formatRemaining(session.remainingMs(nowMs));
+                                }
+                                return line.str();
+                            });
+        DeadlineWatch deadline = watchDeadline(session, console.eventLoop());
+        while (!session.isSubmitted() && !session.atEnd())
         {
             // Check time limit
-            auto currentTime = chrono::steady_clock::now();
-            auto elapsed = chrono::duration_cast<chrono::minutes>(currentTime - startTime);
-            if (elapsed.count() >= examTemplate.getTimeLimit())
+            long long nowMs = Utils::nowEpochMs();
+            if (session.isTimeUp(nowMs))
             {
                 cout << "\n Time's up! ";
-                if (examTemplate.isAutoSubmit())
+                if (session.checkTime(nowMs))
                 {
                     cout << "Exam will be submitted automatically." << endl;
                     break;
@@ -463,153 +729,145 @@ private:
 
             Utils::clearScreen();
 
-            // Show progress and status
-            int answeredCount = 0, reviewCount = 0;
-            for (size_t i = 0; i < answered.size(); ++i)
-            {
-                if (answered[i])
-                    answeredCount++;
-                if (markedForReview[i])
-                    reviewCount++;
-            }
-
-            cout << " " << examTemplate.getTemplateName() << " | ";
-            cout << "" << (currentQuestion + 1) << "/" << questions.size() << " | ";
-            cout << " " << answeredCount << " | ";
-            if (examTemplate.isReviewAllowed())
-            {
-                cout << "🔍 " << reviewCount << " | ";
-            }
-
-            // Show remaining time
-            int remaining = examTemplate.getTimeLimit() - elapsed.count();
-            cout << " " << remaining << "min" << endl;
+            // Show progress, status and remaining time
+            size_t currentQuestion = session.getPosition();
+            cout << console.status(nowMs) << endl;
 
             cout << string(80, '=') << endl;
 
             // Display question
-            questions[currentQuestion].display();
+            const Question &shown = session.question(currentQuestion);
+            shown.display(session.optionOrder(currentQuestion));
 
             // Show current answer and review status
-            if (answered[currentQuestion])
+            if (session.isAnswered(currentQuestion))
             {
                 char optionLabels[] = {'a', 'b', 'c', 'd'};
-                cout << "\n Current Answer: " << optionLabels[userAnswers[currentQuestion]] << ". " << questions[currentQuestion].getOptions()[userAnswers[currentQuestion]] << endl;
+                cout << "\n Current Answer: " << optionLabels[session.answerSlot(currentQuestion)] << ". "
+                     << shown.getOptions()[session.answerOption(currentQuestion)] << endl;
             }
-            if (examTemplate.isReviewAllowed() && markedForReview[currentQuestion])
+            if (examTemplate.isReviewAllowed() && session.isMarked(currentQuestion))
             {
                 cout << " Marked for Review" << endl;
             }
 
-            cout << "\nYour choice (a-d, 0=skip, -1=previous, -2=submit): ";
             string inputStr;
-            cin >> inputStr;
+            if (!console.read("\nYour choice (a-d, 0=skip, -1=previous, -2=submit): ", inputStr) ||
+                session.checkTime(Utils::nowEpochMs()))
+            {
+                break; // Closed while waiting, or entered after the cutoff
+            }
             int answer = parseAnswerInput(inputStr);
 
             if (answer == -2)
             {
                 // Submit exam
                 cout << "\n Exam Summary:" << endl;
-                cout << "Answered: " << answeredCount << "/" << questions.size() << endl;
+                cout << "Answered: " << session.getAnsweredCount() << "/" << session.size() << endl;
                 if (examTemplate.isReviewAllowed())
                 {
-                    cout << "Marked for Review: " << reviewCount << endl;
+                    cout << "Marked for Review: " << session.getMarkedCount() << endl;
                 }
-                cout << "\n Submit exam? (y/N): ";
-                char confirm;
-                cin >> confirm;
-                if (confirm == 'y' || confirm == 'Y')
+                if (console.confirm("\n Submit exam? (y/N): "))
                 {
-                    examCompleted = true;
+                    session.submit(Utils::nowEpochMs());
                 }
             }
-            else if (answer == -3 && examTemplate.isReviewAllowed())
+            else if (answer == -3 && session.toggleReview())
             {
-                // Toggle review mark
-                markedForReview[currentQuestion] = !markedForReview[currentQuestion];
-                cout << (markedForReview[currentQuestion] ? "🔍 Marked for review" : "✅ Review mark removed") << endl;
-                Utils::pauseSystem();
+                journal(session, JournalEvent::MARK, currentQuestion, session.isMarked(currentQuestion) ? 1 : 0);
+                cout << (session.isMarked(currentQuestion) ? "🔍 Marked for review" : "✅ Review mark removed") << endl;
+                console.pause();
             }
             else if (answer == -1)
             {
-                // Previous question
-                if (currentQuestion > 0)
-                {
-                    currentQuestion--;
-                }
+                if (session.previous())
+                    journal(session, JournalEvent::MOVE, session.getPosition());
             }
             else if (answer == 0)
             {
-                // Skip question
-                currentQuestion++;
+                if (session.next())
+                    journal(session, JournalEvent::MOVE, session.getPosition());
             }
-            else if (answer >= 1 && answer <= 4)
+            else if (answer >= 1 && answer <= 4 && session.answer(answer - 1))
             {
-                // Answer question
-                userAnswers[currentQuestion] = answer - 1;
-                answered[currentQuestion] = true;
-                currentQuestion++;
+                journal(session, JournalEvent::ANSWER, currentQuestion, answer - 1);
             }
             else
             {
                 cout << " Invalid input! Please try again." << endl;
-                Utils::pauseSystem();
+                console.pause();
             }
         }
 
-        // Calculate results with template settings
-        auto endTime = chrono::steady_clock::now();
-        auto duration = chrono::duration_cast<chrono::minutes>(endTime - startTime);
+        DeadlineService::shared().cancel(deadline);
+        console.close();
 
-        double score = 0;
-        int correctCount = 0;
+        // Answering the last question ends the exam as well
+        session.submit(Utils::nowEpochMs());
 
-        for (size_t i = 0; i < questions.size(); ++i)
-        {
-            if (answered[i] && userAnswers[i] == questions[i].getCorrectAnswer())
-            {
-                score += 1.0;
-                correctCount++;
-            }
-            else if (answered[i] && examTemplate.hasNegativeMarking())
-            {
-                score -= examTemplate.getNegativeMarkValue();
-            }
-        }
-
-        // Ensure score is not negative
-        if (score < 0)
-            score = 0;
-
-        double percentage = (score * 100.0) / questions.size();
-        bool passed = percentage >= examTemplate.getPassingPercentage();
+        // The key may have been corrected while the exam ran; grade with the
+        // current one so a regrade that already finished need not run again
+        shared_ptr<const ExamPaper> currentPaper = dbManager->getSharedExamPaper(examTemplate.getId());
+        if (currentPaper && !session.usesPaper(currentPaper))
+            session.updateKey(*currentPaper);
+        ExamScore marks = session.grade();
+        int duration = session.elapsedMinutes(session.getEndedAtMs());
 
         // Save result to database with template information
-        ExamResult result(currentStudent.getId(), currentStudent.getUsername(),
-                          static_cast<int>(score), questions.size(), examTemplate.getSubject());
-        result.setDuration(duration.count());
-        result.setExamType(examTemplate.getExamTypeString());
+        ExamResult result = resultOf(session, marks, examTemplate.getSubject());
+        result.setExamType(examTemplate.getExamType());
         result.setTemplateName(examTemplate.getTemplateName());
-        result.setExamTemplateId(examTemplate.getId());
-        result.setTimeLimit(examTemplate.getTimeLimit());
-        result.setNegativeMarking(examTemplate.hasNegativeMarking());
-        if (examTemplate.hasNegativeMarking())
+        if (dbManager->insertExamResult(result))
         {
-            result.setNegativeMarks((correctCount - score) * examTemplate.getNegativeMarkValue());
+            journal(session, JournalEvent::SUBMIT, session.getPosition());
+        }
+        else
+        {
+            // The journal keeps the attempt open, so its answers are not lost
+            cout << "\n Warning: your result could not be saved (database busy). Please inform your instructor." << endl;
+            Utils::pauseSystem();
         }
-        dbManager->insertExamResult(result);
 
         // Display results
-        showTemplateExamResults(questions, userAnswers, answered, examTemplate,
-                                score, percentage, duration.count(), passed);
+        showTemplateExamResults(session, examTemplate, marks, duration);
     }
 
-    void showTemplateExamResults(const vector<Question> &questions,
-                                 const vector<int> &userAnswers,
-                                 const vector<bool> &answered,
-                                 const ExamTemplate &examTemplate,
-                                 double score, double percentage,
-                                 int duration, bool passed)
+    // The result row of a submitted session, for template and custom exams
+    // alike; callers add what only a template knows (type and name)
+    ExamResult resultOf(const ExamSession &session, const ExamScore &marks, const string &subject)
+    {
+        const ExamRules &rules = session.getRules();
+        ExamResult result(currentStudent.getId(), currentStudent.getUsername(),
+                          static_cast<int>(marks.score), session.size(), subject);
+        result.setDuration(session.elapsedMinutes(session.getEndedAtMs()));
+        result.setStartTimeMs(session.getStartedAtMs());
+        result.setEndTimeMs(result.getExamDateMs());
+        result.setExamTemplateId(rules.examTemplateId);
+        result.setTimeLimit(rules.timeLimit);
+        result.setNegativeMarking(rules.marking.negativeMarking);
+        result.setNegativeMarks(marks.negativeMarks);
+
+        if (rules.examTemplateId != 0)
+        {
+            // Saved with the result so it can be regraded if the key changes
+            vector<int> questionIds, userAnswers;
+            vector<bool> correctAnswers;
+            for (size_t i = 0; i < session.size(); ++i)
+            {
+                questionIds.push_back(session.question(i).getId());
+                userAnswers.push_back(session.answerOption(i));
+                correctAnswers.push_back(session.isCorrect(i));
+            }
+            result.setQuestionIds(questionIds);
+            result.setUserAnswers(userAnswers);
+            result.setCorrectAnswers(correctAnswers);
+        }
+        return result;
+    }
+
+    void showTemplateExamResults(const ExamSession &session, const ExamTemplate &examTemplate,
+                                 const ExamScore &marks, int duration)
     {
         Utils::clearScreen();
         Utils::printHeader("EXAM RESULTS - " + examTemplate.getTemplateName());
@@ -619,64 +877,67 @@ private:
         cout << " Template: " << examTemplate.getTemplateName() << endl;
         cout << " Subject: " << examTemplate.getSubject() << endl;
         cout << " Type: " << examTemplate.getExamTypeString() << endl;
-        cout << " Score: " << score << "/" << questions.size() << endl;
-        cout << " Percentage: " << percentage << "%" << endl;
+        cout << " Score: " << marks.score << "/" << session.size() << endl;
+        cout << " Percentage: " << marks.percentage << "%" << endl;
         cout << " Duration: " << duration << " minutes" << endl;
         cout << " Required: " << examTemplate.getPassingPercentage() << "%" << endl;
-        cout << " Grade: " << getGrade(percentage) << endl;
-        cout << " Status: " << (passed ? " PASSED" : " FAILED") << endl;
+        cout << " Grade: " << getGrade(marks.percentage) << endl;
+        cout << " Status: " << (marks.passed ? " PASSED" : " FAILED") << endl;
 
         if (examTemplate.hasNegativeMarking())
         {
-            int correctCount = 0;
-            for (size_t i = 0; i < questions.size(); ++i)
-            {
-                if (answered[i] && userAnswers[i] == questions[i].getCorrectAnswer())
-                {
-                    correctCount++;
-                }
-            }
-            double negativeMarks = (correctCount - score) * examTemplate.getNegativeMarkValue();
-            cout << "  Negative Marks: " << negativeMarks << endl;
+            cout << "  Negative Marks: " << marks.negativeMarks << endl;
+        }
+        if (examTemplate.hasSkipPenalty())
+        {
+            cout << "  Skip Penalty: " << marks.skipPenalties << endl;
         }
 
         cout << string(80, '=') << endl;
 
         // ALWAYS show detailed review for ALL exam types (Quiz, Worksheet, Final)
+        HashTable<int, string> explanations = dbManager->getExamQuestionExplanations(examTemplate.getId());
         cout << "\n Detailed Answer Review:" << endl;
         cout << " All answers are displayed below for your learning:" << endl;
         cout << string(80, '-') << endl;
 
-        for (size_t i = 0; i < questions.size(); ++i)
+        for (size_t i = 0; i < session.size(); ++i)
         {
-            cout << "\nQ" << (i + 1) << ": " << questions[i].getQuestionText() << endl;
+            const Question &question = session.question(i);
+            cout << "\nQ" << (i + 1) << ": " << question.getQuestionText() << endl;
 
-            // Display all options for reference
-            auto options = questions[i].getOptions();
+            // Display all options for reference, in the order they were shown
+            auto options = question.getOptions();
             char optionLabels[] = {'a', 'b', 'c', 'd'};
+            const uint8_t *optionOrder = session.optionOrder(i);
+            int correctSlot = session.correctSlot(i);
             for (size_t j = 0; j < options.size(); ++j)
             {
                 string marker = "";
-                if (j == static_cast<size_t>(questions[i].getCorrectAnswer()))
+                if (j == static_cast<size_t>(correctSlot))
                 {
                     marker = "  (Correct Answer)";
                 }
-                else if (answered[i] && j == static_cast<size_t>(userAnswers[i]))
+                else if (j == static_cast<size_t>(session.answerSlot(i)))
                 {
                     marker = "  (Your Answer)";
                 }
-                cout << "   " << optionLabels[j] << ". " << options[j] << marker << endl;
+                cout << "   " << optionLabels[j] << ". " << options[optionOrder[j]] << marker << endl;
             }
 
-            if (!answered[i])
+            if (!session.isAnswered(i))
             {
                 cout << "\n    Your Answer:  Not answered" << endl;
                 cout << "    Status:  Incorrect (0 points)" << endl;
+                if (examTemplate.hasSkipPenalty())
+                {
+                    cout << "     Skip penalty: -" << examTemplate.getSkipPenalty() << " points" << endl;
+                }
             }
             else
             {
-                cout << "\n    Your Answer: " << optionLabels[userAnswers[i]] << ". " << options[userAnswers[i]] << endl;
-                if (userAnswers[i] == questions[i].getCorrectAnswer())
+                cout << "\n    Your Answer: " << optionLabels[session.answerSlot(i)] << ". " << options[session.answerOption(i)] << endl;
+                if (session.isCorrect(i))
                 {
                     cout << "    Status:  Correct (+1 point)" << endl;
                 }
@@ -689,11 +950,12 @@ private:
                     }
                 }
             }
-            cout << "    Correct Answer: " << optionLabels[questions[i].getCorrectAnswer()] << ". " << options[questions[i].getCorrectAnswer()] << endl;
+            cout << "    Correct Answer: " << optionLabels[correctSlot] << ". " << options[question.getCorrectAnswer()] << endl;
 
-            if (!questions[i].getExplanation().empty())
+            const string *explanation = explanations.find(question.getId());
+            if (explanation)
             {
-                cout << "    Explanation: " << questions[i].getExplanation() << endl;
+                cout << "    Explanation: " << *explanation << endl;
             }
             cout << string(80, '-') << endl;
         }
@@ -817,7 +1079,12 @@ private:
         customTemplate.setAutoSubmit(timeLimit > 0);
 
         // Start exam
-        conductTemplateExam(questions, customTemplate);
+        auto paper = make_shared<ExamPaper>();
+        paper->questions = move(questions);
+        size_t count = paper->questions.size();
+        ExamSession session(paper, ExamRules(customTemplate), identityOrder(count), vector<uint8_t>(count, 0),
+                            Utils::nowEpochMs());
+        conductTemplateExam(session, customTemplate);
     }
 
     void conductExam(const vector<Question> &questions, int timeLimit, const string &subject)
@@ -825,9 +1092,12 @@ private:
         Utils::clearScreen();
         Utils::printHeader("EXAM IN PROGRESS");
 
-        vector<int> userAnswers(questions.size(), -1);
-        vector<bool> answered(questions.size(), false);
-        auto startTime = chrono::steady_clock::now();
+        auto paper = make_shared<ExamPaper>();
+        paper->questions = questions;
+        ExamRules rules;
+        rules.timeLimit = timeLimit > 0 ? timeLimit : 0;
+        ExamSession session(paper, rules, identityOrder(questions.size()), vector<uint8_t>(questions.size(), 0),
+                            Utils::nowEpochMs());
 
         cout << "Exam Started!" << endl;
         cout << "Questions: " << questions.size() << endl;
@@ -844,138 +1114,107 @@ private:
         cin.ignore();
         cin.get();
 
-        int currentQuestion = 0;
-        bool examCompleted = false;
-
-        while (!examCompleted && currentQuestion < static_cast<int>(questions.size()))
+        // Second screen row: time left
+        ExamConsole console(session, 2, [&session](long long nowMs)
+                            { return "Time Remaining: " + formatRemaining(session.remainingMs(nowMs)); });
+        DeadlineWatch deadline = watchDeadline(session, console.eventLoop());
+        while (!session.isSubmitted() && !session.atEnd())
         {
             // Check time limit
-            if (timeLimit > 0)
+            long long nowMs = Utils::nowEpochMs();
+            if (session.checkTime(nowMs))
             {
-                auto currentTime = chrono::steady_clock::now();
-                auto elapsed = chrono::duration_cast<chrono::minutes>(currentTime - startTime);
-                if (elapsed.count() >= timeLimit)
-                {
-                    cout << "\n Time's up! Exam will be submitted automatically." << endl;
-                    break;
-                }
+                cout << "\n Time's up! Exam will be submitted automatically." << endl;
+                break;
             }
 
             Utils::clearScreen();
 
             // Show progress
-            int answeredCount = 0;
-            for (bool ans : answered)
-            {
-                if (ans)
-                    answeredCount++;
-            }
-
+            size_t currentQuestion = session.getPosition();
             cout << "Question " << (currentQuestion + 1) << " of " << questions.size()
-                 << " | Answered: " << answeredCount << "/" << questions.size() << endl;
+                 << " | Answered: " << session.getAnsweredCount() << "/" << questions.size() << endl;
 
             if (timeLimit > 0)
             {
-                auto currentTime = chrono::steady_clock::now();
-                auto elapsed = chrono::duration_cast<chrono::minutes>(currentTime - startTime);
-                int remaining = timeLimit - elapsed.count();
-                cout << "Time Remaining: " << remaining << " minutes" << endl;
+                cout << console.status(nowMs) << endl;
             }
 
             cout << string(60, '=') << endl;
 
             // Display question
-            questions[currentQuestion].display();
+            const Question &shown = session.question(currentQuestion);
+            shown.display();
 
-            if (answered[currentQuestion])
+            if (session.isAnswered(currentQuestion))
             {
                 char optionLabels[] = {'a', 'b', 'c', 'd'};
-                cout << "\nCurrent Answer: " << optionLabels[userAnswers[currentQuestion]] << ". " << questions[currentQuestion].getOptions()[userAnswers[currentQuestion]] << endl;
+                cout << "\nCurrent Answer: " << optionLabels[session.answerSlot(currentQuestion)] << ". "
+                     << shown.getOptions()[session.answerOption(currentQuestion)] << endl;
             }
 
-            cout << "\nYour answer (a-d, 0=skip, -1=previous, -2=submit): ";
             string inputStr;
-            cin >> inputStr;
+            if (!console.read("\nYour answer (a-d, 0=skip, -1=previous, -2=submit): ", inputStr) ||
+                session.checkTime(Utils::nowEpochMs()))
+            {
+                break; // Closed while waiting, or entered after the cutoff
+            }
             int answer = parseAnswerInput(inputStr);
 
             if (answer == -2)
             {
                 // Submit exam
-                cout << "\nAre you sure you want to submit? (y/N): ";
-                char confirm;
-                cin >> confirm;
-                if (confirm == 'y' || confirm == 'Y')
+                if (console.confirm("\nAre you sure you want to submit? (y/N): "))
                 {
-                    examCompleted = true;
+                    session.submit(Utils::nowEpochMs());
                 }
             }
             else if (answer == -1)
             {
-                // Previous question
-                if (currentQuestion > 0)
-                {
-                    currentQuestion--;
-                }
+                session.previous();
             }
             else if (answer == 0)
             {
-                // Skip question
-                currentQuestion++;
-            }
-            else if (answer >= 1 && answer <= 4)
-            {
-                // Answer question
-                userAnswers[currentQuestion] = answer - 1;
-                answered[currentQuestion] = true;
-                currentQuestion++;
+                session.next();
             }
-            else
+            else if (!(answer >= 1 && answer <= 4 && session.answer(answer - 1)))
             {
                 cout << "Invalid input! Please try again." << endl;
-                Utils::pauseSystem();
+                console.pause();
             }
         }
 
+        DeadlineService::shared().cancel(deadline);
+        console.close();
+
         // Calculate results
-        auto endTime = chrono::steady_clock::now();
-        auto duration = chrono::duration_cast<chrono::minutes>(endTime - startTime);
+        session.submit(Utils::nowEpochMs());
+        ExamScore marks = session.grade();
+        int duration = session.elapsedMinutes(session.getEndedAtMs());
 
-        int score = 0;
-        for (size_t i = 0; i < questions.size(); ++i)
+        // Save result to database
+        if (!dbManager->insertExamResult(resultOf(session, marks, subject)))
         {
-            if (answered[i] && userAnswers[i] == questions[i].getCorrectAnswer())
-            {
-                score++;
-            }
+            cout << "\nWarning: your result could not be saved (database busy). Please inform your instructor." << endl;
+            Utils::pauseSystem();
         }
 
-        double percentage = (score * 100.0) / questions.size();
-
-        // Save result to database
-        ExamResult result(currentStudent.getId(), currentStudent.getUsername(),
-                          score, questions.size(), subject);
-        result.setDuration(duration.count());
-        dbManager->insertExamResult(result);
-
         // Display results
-        showExamResults(questions, userAnswers, answered, score, percentage, duration.count());
+        showExamResults(session, marks, duration);
     }
 
-    void showExamResults(const vector<Question> &questions,
-                         const vector<int> &userAnswers,
-                         const vector<bool> &answered,
-                         int score, double percentage, int duration)
+    void showExamResults(const ExamSession &session, const ExamScore &marks, int duration)
     {
         Utils::clearScreen();
         Utils::printHeader("EXAM RESULTS");
 
         cout << " Exam Completed!" << endl;
         cout << string(80, '=') << endl;
-        cout << " Score: " << score << "/" << questions.size() << endl;
-        cout << " Percentage: " << percentage << "%" << endl;
+        cout << " Score: " << marks.score << "/" << session.size() << endl;
+        cout << " Percentage: " << marks.percentage << "%" << endl;
         cout << " Duration: " << duration << " minutes" << endl;
-        cout << " Grade: " << getGrade(percentage) << endl;
-        cout << " Status: " << (percentage >= 60 ? " PASSED" : " FAILED") << endl;
+        cout << " Grade: " << getGrade(marks.percentage) << endl;
+        cout << " Status: " << (marks.passed ? " PASSED" : " FAILED") << endl;
         cout << string(80, '=') << endl;
 
         // ALWAYS show detailed answer review for ALL exams
@@ -983,20 +1222,21 @@ private:
         cout << " All answers and explanations are provided below:" << endl;
         cout << string(80, '-') << endl;
 
-        for (size_t i = 0; i < questions.size(); ++i)
+        for (size_t i = 0; i < session.size(); ++i)
         {
-            cout << "\nQ" << (i + 1) << ": " << questions[i].getQuestionText() << endl;
+            const Question &question = session.question(i);
+            cout << "\nQ" << (i + 1) << ": " << question.getQuestionText() << endl;
 
             // Display all options for reference
-            auto options = questions[i].getOptions();
+            auto options = question.getOptions();
             for (size_t j = 0; j < options.size(); ++j)
             {
                 string marker = "";
-                if (j == static_cast<size_t>(questions[i].getCorrectAnswer()))
+                if (j == static_cast<size_t>(question.getCorrectAnswer()))
                 {
                     marker = "  (Correct Answer)";
                 }
-                else if (answered[i] && j == static_cast<size_t>(userAnswers[i]))
+                else if (j == static_cast<size_t>(session.answerSlot(i)))
                 {
                     marker = "  (Your Answer)";
                 }
@@ -1004,7 +1244,7 @@ private:
                 cout << "   " << optionLabels[j] << ". " << options[j] << marker << endl;
             }
 
-            if (!answered[i])
+            if (!session.isAnswered(i))
             {
                 cout << "\n    Your Answer:  Not answered" << endl;
                 cout << "    Status:  Incorrect (0 points)" << endl;
@@ -1012,8 +1252,8 @@ private:
             else
             {
                 char optionLabels[] = {'a', 'b', 'c', 'd'};
-                cout << "\n    Your Answer: " << optionLabels[userAnswers[i]] << ". " << options[userAnswers[i]] << endl;
-                if (userAnswers[i] == questions[i].getCorrectAnswer())
+                cout << "\n    Your Answer: " << optionLabels[session.answerSlot(i)] << ". " << options[session.answerOption(i)] << endl;
+                if (session.isCorrect(i))
                 {
                     cout << "    Status:  Correct (+1 point)" << endl;
                 }
@@ -1023,11 +1263,11 @@ private:
                 }
             }
             char optionLabels[] = {'a', 'b', 'c', 'd'};
-            cout << "    Correct Answer: " << optionLabels[questions[i].getCorrectAnswer()] << ". " << options[questions[i].getCorrectAnswer()] << endl;
+            cout << "    Correct Answer: " << optionLabels[question.getCorrectAnswer()] << ". " << options[question.getCorrectAnswer()] << endl;
 
-            if (!questions[i].getExplanation().empty())
+            if (!question.getExplanation().empty())
             {
-                cout << "    Explanation: " << questions[i].getExplanation() << endl;
+                cout << "    Explanation: " << question.getExplanation() << endl;
             }
             cout << string(80, '-') << endl;
         }
@@ -1204,8 +1444,8 @@ private:
             return;
         }
 
-        // DSA: Randomize using Merge Sort and limit to 10 questions
-        randomizeQuestions(questions); // DSA: Merge Sort randomization
+        // DSA: Fisher-Yates sample of up to 10 questions
+        randomizeQuestions(questions, 10);
         if (questions.size() > 10)
         {
             questions.resize(10);
@@ -1254,8 +1494,8 @@ private:
             return;
         }
 
-        // DSA: Randomize using Merge Sort and limit to 10 questions
-        randomizeQuestions(questions); // DSA: Merge Sort randomization
+        // DSA: Fisher-Yates sample of up to 10 questions
+        randomizeQuestions(questions, 10);
         if (questions.size() > 10)
         {
             questions.resize(10);
@@ -1349,7 +1589,7 @@ private:
         Utils::clearScreen();
         Utils::printHeader("MY EXAM RESULTS");
 
-        auto results = dbManager->getExamResultsByUser(currentStudent.getId());
+        auto results = dbManager->getResultSummariesByUser(currentStudent.getId());
         if (results.empty())
         {
             cout << "No exam results found!" << endl;
@@ -1365,12 +1605,12 @@ private:
             double totalPercentage = 0;
             for (const auto &result : results)
             {
-                cout << result.getExamDate() << "\t"
-                     << (result.getSubject().empty() ? "Mixed" : result.getSubject()) << "\t\t"
-                     << result.getScore() << "/" << result.getTotalQuestions() << "\t\t"
-                     << result.getPercentage() << "%\t\t"
-                     << getGrade(result.getPercentage()) << endl;
-                totalPercentage += result.getPercentage();
+                cout << Utils::formatEpochMs(result.examDateMs) << "\t"
+                     << SUBJECT_CODES.name(result.subject == Subject::NONE ? Subject::MIXED : result.subject) << "\t\t"
+                     << result.score << "/" << result.totalQuestions << "\t\t"
+                     << result.percentage << "%\t\t"
+                     << getGrade(result.percentage) << endl;
+                totalPercentage += result.percentage;
             }
 
             cout << string(80, '-') << endl;
@@ -1392,7 +1632,7 @@ private:
         cout << "Status: " << currentStudent.statusToString() << endl;
 
         // Show exam statistics
-        auto results = dbManager->getExamResultsByUser(currentStudent.getId());
+        auto results = dbManager->getResultSummariesByUser(currentStudent.getId());
         cout << "\nExam Statistics:" << endl;
         cout << "Total Exams: " << results.size() << endl;
 
@@ -1403,8 +1643,8 @@ private:
 
             for (const auto &result : results)
             {
-                totalPercentage += result.getPercentage();
-                if (result.getPercentage() >= 60)
+                totalPercentage += result.percentage;
+                if (result.percentage >= 60)
                     passedExams++;
             }
 
@@ -1421,7 +1661,7 @@ private:
         Utils::clearScreen();
         Utils::printHeader("PERFORMANCE ANALYTICS");
 
-        auto results = dbManager->getExamResultsByUser(currentStudent.getId());
+        auto results = dbManager->getResultSummariesByUser(currentStudent.getId());
         if (results.empty())
         {
             cout << "No exam data available for analysis." << endl;
@@ -1431,16 +1671,16 @@ private:
         }
 
         // Calculate statistics
-        map<string, vector<double>> subjectScores;
+        map<Subject, vector<double>> subjectScores;
         double totalScore = 0;
         int passedExams = 0;
 
         for (const auto &result : results)
         {
-            string subject = result.getSubject().empty() ? "Mixed" : result.getSubject();
-            subjectScores[subject].push_back(result.getPercentage());
-            totalScore += result.getPercentage();
-            if (result.getPercentage() >= 60)
+            Subject subject = result.subject == Subject::NONE ? Subject::MIXED : result.subject;
+            subjectScores[subject].push_back(result.percentage);
+            totalScore += result.percentage;
+            if (result.percentage >= 60)
                 passedExams++;
         }
 
@@ -1459,7 +1699,7 @@ private:
                 subjectTotal += score;
             }
             double average = subjectTotal / pair.second.size();
-            cout << pair.first << ": " << average << "% ("
+            cout << SUBJECT_CODES.name(pair.first) << ": " << average << "% ("
                  << pair.second.size() << " exams)" << endl;
         }
 
@@ -1481,12 +1721,12 @@ private:
                 if (average > highestAvg)
                 {
                     highestAvg = average;
-                    strongestSubject = pair.first;
+                    strongestSubject = SUBJECT_CODES.name(pair.first);
                 }
                 if (average < lowestAvg)
                 {
                     lowestAvg = average;
-                    weakestSubject = pair.first;
+                    weakestSubject = SUBJECT_CODES.name(pair.first);
                 }
             }
         }
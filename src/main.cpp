@@ -21,7 +21,7 @@ public:
     {
         // Initialize components
         dbManager = make_unique<DatabaseManager>("database/exam.db");
-        userManager = make_unique<UserManager>();
+        userManager = make_unique<UserManager>(dbManager.get());
         authManager = make_unique<SimpleAuthManager>(userManager.get());
 
         // Initialize database
@@ -31,7 +31,7 @@ public:
             exit(1);
         }
 
-        loadDefaultUsers();
+        ensureDefaultAdmin();
     }
 
     void run()
@@ -126,49 +126,27 @@ private:
             return;
         }
 
-        // Use database authentication directly
-        User dbUser;
-        if (dbManager->authenticateUser(username, password, dbUser))
+        // The user cache loads the account from the database and writes
+        // the login bookkeeping back through it
+        AuthResult result = authManager->login(username, password);
+        if (result == AuthResult::SUCCESS)
         {
-            // Successful authentication
-            cout << "\n✓ Login successful! Welcome " << dbUser.getFullName() << endl;
-            cout << "Role: " << dbUser.roleToString() << endl;
-
-            // Add/update user in memory for auth manager
-            User *memUser = userManager->findUserByUsername(username);
-            if (memUser)
-            {
-                userManager->updateUser(dbUser);
-            }
-            else
-            {
-                userManager->addUser(dbUser);
-            }
-
-            // Set current user in auth manager (this should work now)
-            AuthResult result = authManager->login(username, password);
-            if (result != AuthResult::SUCCESS)
-            {
-                cout << "Warning: Auth manager sync issue, but login successful." << endl;
-            }
+            const User *currentUser = authManager->getCurrentUser();
+            cout << "\n✓ Login successful! Welcome " << currentUser->getFullName() << endl;
+            cout << "Role: " << currentUser->roleToString() << endl;
+        }
+        else if (result == AuthResult::USER_NOT_FOUND)
+        {
+            cout << "\n✗ Login failed: User not found" << endl;
+        }
+        else if (result == AuthResult::ACCOUNT_LOCKED)
+        {
+            cout << "\n✗ Login failed: Account is locked due to too many failed attempts" << endl;
+            cout << "  Please contact administrator to unlock your account." << endl;
         }
         else
         {
-            // Check specific failure reason
-            User checkUser = dbManager->getUserByUsername(username);
-            if (checkUser.getId() == 0)
-            {
-                cout << "\n✗ Login failed: User not found" << endl;
-            }
-            else if (checkUser.isAccountLocked())
-            {
-                cout << "\n✗ Login failed: Account is locked due to too many failed attempts" << endl;
-                cout << "  Please contact administrator to unlock your account." << endl;
-            }
-            else
-            {
-                cout << "\n✗ Login failed: Invalid password" << endl;
-            }
+            cout << "\n✗ Login failed: Invalid password" << endl;
         }
 
         Utils::pauseSystem();
@@ -258,8 +236,6 @@ private:
             if (dbUser.getId() != 0)
             {
                 cout << " User verified in database with ID: " << dbUser.getId() << endl;
-                userManager->addUser(dbUser);
-                cout << " User added to memory for immediate use" << endl;
             }
             else
             {
@@ -429,12 +405,6 @@ private:
         {
             cout << "\nPassword changed successfully!" << endl;
 
-            // Update in database
-            const User *currentUser = authManager->getCurrentUser();
-            if (currentUser)
-            {
-                dbManager->updateUser(*currentUser);
-            }
         }
         else
         {
@@ -496,30 +466,12 @@ private:
         exit(0);
     }
 
-    void loadDefaultUsers()
+    // Users are loaded into the cache on demand at login; startup only
+    // makes sure the default admin exists
+    void ensureDefaultAdmin()
     {
         cout << "Initializing user system..." << endl;
 
-        // Load all existing users from database into memory
-        auto dbUsers = dbManager->getAllUsers();
-        cout << "Found " << dbUsers.size() << " users in database" << endl;
-
-        for (const auto &user : dbUsers)
-        {
-            // Skip users with empty usernames (corrupted data)
-            if (user.getUsername().empty())
-            {
-                cout << "  Skipping user with empty username (ID: " << user.getId() << ")" << endl;
-                continue;
-            }
-
-            if (userManager->findUserByUsername(user.getUsername()) == nullptr)
-            {
-                userManager->addUser(user);
-                cout << "  Loaded: " << user.getUsername() << " (" << user.roleToString() << ")" << endl;
-            }
-        }
-
         // Verify admin user exists
         User existingAdmin = dbManager->getUserByUsername("admin");
         if (existingAdmin.getId() == 0)
@@ -527,18 +479,9 @@ private:
             cout << "Admin user not found, creating..." << endl;
             User defaultAdmin(0, "admin", "admin123", "admin@exam.com",
                               "System Administrator", UserRole::ADMIN);
-            if (dbManager->insertUser(defaultAdmin))
+            if (userManager->addUser(defaultAdmin))
             {
-                User dbAdmin = dbManager->getUserByUsername("admin");
-                if (dbAdmin.getId() != 0)
-                {
-                    userManager->addUser(dbAdmin);
-                    cout << "✓ Default admin user created" << endl;
-                }
-                else
-                {
-                    cout << "✗ Failed to retrieve created admin user" << endl;
-                }
+                cout << "✓ Default admin user created" << endl;
             }
             else
             {
@@ -550,7 +493,8 @@ private:
             cout << "✓ Admin user verified in database (ID: " << existingAdmin.getId() << ")" << endl;
         }
 
-        cout << "✓ User system ready. Total users: " << userManager->getTotalUsers() << endl;
+        cout << "✓ User system ready. Users are cached on login (up to "
+             << userManager->getCacheStats().capacity << ")" << endl;
     }
 };
 
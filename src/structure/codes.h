@@ -0,0 +1,107 @@
+#ifndef CODES_H
+#define CODES_H
+
+#include <cstddef>
+#include <string_view>
+
+using namespace std;
+
+// Fixed vocabularies stored as integer codes. The database keeps the code;
+// the name is only produced for display and parsed back from user input.
+// Code 0 means "not set" and maps to the empty name.
+
+enum class Subject {
+    NONE = 0,
+    DSA = 1,
+    OOP = 2,
+    COA = 3,
+    SAM = 4,
+    MATHEMATICS = 5,
+    MIXED = 6          // Custom exams drawn from every subject (results only)
+};
+
+enum class Difficulty {
+    NONE = 0,
+    EASY = 1,
+    MEDIUM = 2,
+    HARD = 3,
+    MIXED = 4          // Templates only
+};
+
+// Exam type enumeration
+enum class ExamType {
+    NONE = 0,          // Practice exams taken without a template
+    QUIZ = 1,          // Short
+    WORKSHEET = 2,     // Practice/homework
+    FINAL = 3          // Comprehensive exam
+};
+
+template <typename Enum>
+struct CodeName {
+    Enum code;
+    const char* name;
+};
+
+// Bidirectional code <-> name table. Entries are listed in code order
+// starting at 0, so name() is a single array index.
+template <typename Enum, size_t N>
+struct CodeTable {
+    CodeName<Enum> entries[N];
+
+    constexpr size_t size() const { return N; }
+    constexpr const CodeName<Enum>* begin() const { return entries; }
+    constexpr const CodeName<Enum>* end() const { return entries + N; }
+
+    constexpr bool isDense() const {
+        for (size_t i = 0; i < N; ++i) {
+            if (static_cast<size_t>(entries[i].code) != i) return false;
+        }
+        return true;
+    }
+
+    // Codes outside the table get the name of code 0
+    constexpr const char* name(Enum code) const {
+        size_t index = static_cast<size_t>(code);
+        return index < N ? entries[index].name : entries[0].name;
+    }
+
+    // Exact match on the display name; unknown names map to code 0
+    constexpr Enum code(string_view name) const {
+        for (size_t i = 1; i < N; ++i) {
+            if (name == entries[i].name) return entries[i].code;
+        }
+        return entries[0].code;
+    }
+};
+
+inline constexpr CodeTable<Subject, 7> SUBJECT_CODES = {{
+    {Subject::NONE, ""},
+    {Subject::DSA, "DSA"},
+    {Subject::OOP, "OOP"},
+    {Subject::COA, "COA"},
+    {Subject::SAM, "SAM"},
+    {Subject::MATHEMATICS, "Mathematics"},
+    {Subject::MIXED, "Mixed"},
+}};
+
+inline constexpr CodeTable<Difficulty, 5> DIFFICULTY_CODES = {{
+    {Difficulty::NONE, ""},
+    {Difficulty::EASY, "Easy"},
+    {Difficulty::MEDIUM, "Medium"},
+    {Difficulty::HARD, "Hard"},
+    {Difficulty::MIXED, "Mixed"},
+}};
+
+inline constexpr CodeTable<ExamType, 4> EXAM_TYPE_CODES = {{
+    {ExamType::NONE, ""},
+    {ExamType::QUIZ, "QUIZ"},
+    {ExamType::WORKSHEET, "WORKSHEET"},
+    {ExamType::FINAL, "FINAL"},
+}};
+
+static_assert(SUBJECT_CODES.isDense() && DIFFICULTY_CODES.isDense() && EXAM_TYPE_CODES.isDense(),
+              "code tables must list every code in order");
+static_assert(SUBJECT_CODES.code("Mathematics") == Subject::MATHEMATICS, "subject lookup");
+static_assert(EXAM_TYPE_CODES.code("BOGUS") == ExamType::NONE, "unknown names map to NONE");
+
+#endif // CODES_H
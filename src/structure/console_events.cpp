@@ -0,0 +1,282 @@
+#include "console_events.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#endif
+using namespace std;
+
+ConsoleEvents::ConsoleEvents() : epollFd(-1), timerFd(-1), noticeFd(-1)
+{
+}
+
+ConsoleEvents::~ConsoleEvents()
+{
+    close();
+}
+
+#ifdef __linux__
+
+bool ConsoleEvents::open()
+{
+    if (epollFd >= 0)
+        return true;
+
+    // Piped or redirected input is read through cin: stdio may already hold
+    // lines of it that epoll would never report
+    if (!isatty(STDIN_FILENO))
+        return false;
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    timerFd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+    noticeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || timerFd < 0 || noticeFd < 0)
+    {
+        close();
+        return false;
+    }
+
+    // stdin stays blocking: it is only read after epoll reports it readable
+    int fds[] = {STDIN_FILENO, timerFd, noticeFd};
+    for (int fd : fds)
+    {
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+            // EPERM for a stdin redirected from a regular file
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void ConsoleEvents::close()
+{
+    // Input read from stdin but not taken with next() goes back to the stdin
+    // stream, in order, so whatever reads cin next still gets it
+    if (epollFd >= 0)
+    {
+        string unread;
+        for (const ConsoleEvent &event : ready)
+        {
+            if (event.type == ConsoleEventType::LINE)
+                unread += event.text + '\n';
+        }
+        unread += partialLine;
+        for (size_t i = unread.size(); i-- > 0;)
+        {
+            ungetc(static_cast<unsigned char>(unread[i]), stdin);
+        }
+    }
+
+    for (int *fd : {&epollFd, &timerFd, &noticeFd})
+    {
+        if (*fd >= 0)
+        {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+    partialLine.clear();
+    ready.clear();
+}
+
+bool ConsoleEvents::startTicker(long long intervalMs, long long alignToMs)
+{
+    if (timerFd < 0 || intervalMs <= 0)
+        return false;
+
+    // The first tick is the next instant on the alignToMs + k * intervalMs grid
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    long long nowMs = static_cast<long long>(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+    long long phase = ((alignToMs - nowMs) % intervalMs + intervalMs) % intervalMs;
+    long long firstMs = nowMs + (phase == 0 ? intervalMs : phase);
+
+    itimerspec spec = {};
+    spec.it_value.tv_sec = firstMs / 1000;
+    spec.it_value.tv_nsec = (firstMs % 1000) * 1000000;
+    spec.it_interval.tv_sec = intervalMs / 1000;
+    spec.it_interval.tv_nsec = (intervalMs % 1000) * 1000000;
+    return timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr) == 0;
+}
+
+void ConsoleEvents::stopTicker()
+{
+    if (timerFd < 0)
+        return;
+    itimerspec spec = {};
+    timerfd_settime(timerFd, 0, &spec, nullptr);
+}
+
+void ConsoleEvents::post(const string &notice)
+{
+    {
+        lock_guard<mutex> lock(noticeMutex);
+        notices.push_back(notice);
+    }
+    if (noticeFd >= 0)
+    {
+        uint64_t one = 1;
+        ssize_t written = write(noticeFd, &one, sizeof(one));
+        (void)written; // Only fails when the counter is saturated, which still wakes next()
+    }
+}
+
+void ConsoleEvents::readInput()
+{
+    char buffer[4096];
+    ssize_t bytes = read(STDIN_FILENO, buffer, sizeof(buffer));
+    if (bytes < 0)
+    {
+        if (errno != EINTR && errno != EAGAIN)
+            ready.emplace_back(ConsoleEventType::CLOSED);
+        return;
+    }
+    if (bytes == 0)
+    {
+        if (!partialLine.empty())
+        {
+            ready.emplace_back(ConsoleEventType::LINE, partialLine);
+            partialLine.clear();
+        }
+        ready.emplace_back(ConsoleEventType::CLOSED);
+        return;
+    }
+
+    partialLine.append(buffer, static_cast<size_t>(bytes));
+    size_t start = 0;
+    size_t newline;
+    while ((newline = partialLine.find('\n', start)) != string::npos)
+    {
+        size_t end = newline;
+        if (end > start && partialLine[end - 1] == '\r')
+            end--;
+        ready.emplace_back(ConsoleEventType::LINE, partialLine.substr(start, end - start));
+        start = newline + 1;
+    }
+    partialLine.erase(0, start);
+}
+
+void ConsoleEvents::readTicks()
+{
+    // Ticks missed while busy arrive as one count; a single TICK covers them
+    uint64_t expirations = 0;
+    if (read(timerFd, &expirations, sizeof(expirations)) == static_cast<ssize_t>(sizeof(expirations)) &&
+        expirations > 0)
+    {
+        ready.emplace_back(ConsoleEventType::TICK);
+    }
+}
+
+void ConsoleEvents::readNotices()
+{
+    uint64_t count = 0;
+    ssize_t bytes = read(noticeFd, &count, sizeof(count));
+    (void)bytes; // Drained either way; the notices themselves are in the list
+
+    vector<string> posted;
+    {
+        lock_guard<mutex> lock(noticeMutex);
+        posted.swap(notices);
+    }
+    for (const string &notice : posted)
+    {
+        ready.emplace_back(ConsoleEventType::NOTICE, notice);
+    }
+}
+
+ConsoleEvent ConsoleEvents::next()
+{
+    while (ready.empty())
+    {
+        if (epollFd < 0)
+            return ConsoleEvent(ConsoleEventType::CLOSED);
+
+        epoll_event events[3];
+        int count = epoll_wait(epollFd, events, 3, -1);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return ConsoleEvent(ConsoleEventType::CLOSED);
+        }
+
+        // Notices and ticks first: they may close the screen the input was for
+        for (int i = 0; i < count; ++i)
+        {
+            if (events[i].data.fd == noticeFd)
+                readNotices();
+        }
+        for (int i = 0; i < count; ++i)
+        {
+            if (events[i].data.fd == timerFd)
+                readTicks();
+        }
+        for (int i = 0; i < count; ++i)
+        {
+            if (events[i].data.fd == STDIN_FILENO)
+                readInput();
+        }
+    }
+
+    ConsoleEvent event = ready.front();
+    ready.pop_front();
+    return event;
+}
+
+#else
+
+// No epoll, timerfd or eventfd: open() fails and callers read with cin
+
+bool ConsoleEvents::open()
+{
+    return false;
+}
+
+void ConsoleEvents::close()
+{
+    partialLine.clear();
+    ready.clear();
+}
+
+bool ConsoleEvents::startTicker(long long, long long)
+{
+    return false;
+}
+
+void ConsoleEvents::stopTicker()
+{
+}
+
+void ConsoleEvents::post(const string &notice)
+{
+    lock_guard<mutex> lock(noticeMutex);
+    notices.push_back(notice);
+}
+
+void ConsoleEvents::readInput()
+{
+}
+
+void ConsoleEvents::readTicks()
+{
+}
+
+void ConsoleEvents::readNotices()
+{
+}
+
+ConsoleEvent ConsoleEvents::next()
+{
+    return ConsoleEvent(ConsoleEventType::CLOSED);
+}
+
+#endif
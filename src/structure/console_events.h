@@ -0,0 +1,77 @@
+#ifndef CONSOLE_EVENTS_H
+#define CONSOLE_EVENTS_H
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <mutex>
+
+using namespace std;
+
+enum class ConsoleEventType
+{
+    LINE,   // A line typed on stdin, without its newline
+    TICK,   // The ticker went off
+    NOTICE, // Text posted from another thread
+    CLOSED  // stdin reached end of file
+};
+
+struct ConsoleEvent
+{
+    ConsoleEventType type;
+    string text;
+
+    ConsoleEvent(ConsoleEventType type, const string &text = "") : type(type), text(text) {}
+};
+
+// Single-threaded event loop over console input (Linux): one epoll set
+// holds stdin, a timerfd ticker and an eventfd other threads use to post
+// notices, and next() blocks until any of them has something. A screen can
+// then redraw a countdown or react to a notice while the user is typing,
+// without a reader thread or polling.
+//
+// open() fails where this is not available (other platforms, or stdin is
+// not a terminal); callers then read with cin. While open, stdin is read
+// directly, so input must not be read through cin at the same time, and
+// the caller must check cin has nothing buffered before opening. close()
+// hands input that was read but not yet taken back to the stdin stream.
+class ConsoleEvents
+{
+private:
+    int epollFd;
+    int timerFd;
+    int noticeFd;
+    string partialLine;
+    deque<ConsoleEvent> ready;
+
+    mutex noticeMutex;
+    vector<string> notices;
+
+    void readInput();
+    void readTicks();
+    void readNotices();
+
+public:
+    ConsoleEvents();
+    ~ConsoleEvents();
+
+    ConsoleEvents(const ConsoleEvents &) = delete;
+    ConsoleEvents &operator=(const ConsoleEvents &) = delete;
+
+    bool open();
+    void close();
+    bool isOpen() const { return epollFd >= 0; }
+
+    // Tick every intervalMs on the wall clock, phased so that a tick falls
+    // exactly on alignToMs (epoch ms) and every intervalMs either side of it
+    bool startTicker(long long intervalMs, long long alignToMs);
+    void stopTicker();
+
+    // Safe from any thread; delivered as a NOTICE by next()
+    void post(const string &notice);
+
+    // Block until the next event
+    ConsoleEvent next();
+};
+
+#endif // CONSOLE_EVENTS_H
@@ -5,6 +5,8 @@
 #include <limits>
 #include <cctype>
 #include <stdexcept>
+#include <cstdio>
+#include <ctime>
 #ifdef _WIN32
 #include <thread>
 #include <chrono>
@@ -245,4 +247,70 @@ double Utils::safeStod(const string &str, double defaultValue)
     {
         return defaultValue;
     }
-}
\ No newline at end of file
+}
+
+static bool toLocalTime(time_t seconds, tm &local)
+{
+#ifdef _WIN32
+    return localtime_s(&local, &seconds) == 0;
+#else
+    return localtime_r(&seconds, &local) != nullptr;
+#endif
+}
+
+string Utils::formatEpochMs(long long epochMs)
+{
+    if (epochMs <= 0)
+        return "";
+
+    // localtime + strftime is the expensive part and only changes once a
+    // minute, so each thread keeps the formatted "YYYY-MM-DD HH:MM" prefix
+    thread_local long long cachedMinute = -1;
+    thread_local char cachedPrefix[32] = "";
+
+    long long seconds = epochMs / 1000;
+    long long minute = seconds / 60;
+    if (minute != cachedMinute)
+    {
+        tm local{};
+        if (!toLocalTime(static_cast<time_t>(minute * 60), local))
+            return "";
+        strftime(cachedPrefix, sizeof(cachedPrefix), "%Y-%m-%d %H:%M", &local);
+        cachedMinute = minute;
+    }
+
+    char buffer[40];
+    int length = snprintf(buffer, sizeof(buffer), "%s:%02d", cachedPrefix, static_cast<int>(seconds % 60));
+    return string(buffer, length > 0 ? length : 0);
+}
+
+long long Utils::parseDateTime(const string &text)
+{
+    tm local{};
+    int fields = sscanf(text.c_str(), "%4d-%2d-%2d %2d:%2d:%2d", &local.tm_year, &local.tm_mon, &local.tm_mday,
+                        &local.tm_hour, &local.tm_min, &local.tm_sec);
+    if (fields < 3 || local.tm_mon < 1 || local.tm_mon > 12 || local.tm_mday < 1 || local.tm_mday > 31)
+        return -1;
+
+    local.tm_year -= 1900;
+    local.tm_mon -= 1;
+    local.tm_isdst = -1;
+    time_t seconds = mktime(&local);
+    if (seconds == static_cast<time_t>(-1))
+        return -1;
+    return static_cast<long long>(seconds) * 1000;
+}
+
+long long Utils::startOfWeekMs(long long epochMs)
+{
+    tm local{};
+    if (!toLocalTime(static_cast<time_t>(epochMs / 1000), local))
+        return 0;
+
+    local.tm_mday -= (local.tm_wday + 6) % 7; // Back to Monday
+    local.tm_hour = 0;
+    local.tm_min = 0;
+    local.tm_sec = 0;
+    local.tm_isdst = -1;
+    return static_cast<long long>(mktime(&local)) * 1000;
+}
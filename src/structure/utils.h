@@ -30,13 +30,19 @@ class Utils
 public:
     static string getCurrentDateTime()
     {
-        auto now = chrono::system_clock::now();
-        time_t time = chrono::system_clock::to_time_t(now);
-        stringstream ss;
-        ss << put_time(localtime(&time), "%Y-%m-%d %H:%M:%S");
-        return ss.str();
+        return formatEpochMs(nowEpochMs());
     }
 
+    // Timestamps are stored as epoch milliseconds; 0 means "not set"
+    static long long nowEpochMs()
+    {
+        return chrono::duration_cast<chrono::milliseconds>(
+                   chrono::system_clock::now().time_since_epoch()).count();
+    }
+    static string formatEpochMs(long long epochMs);     // Local "YYYY-MM-DD HH:MM:SS", "" for 0
+    static long long parseDateTime(const string &text); // Local "YYYY-MM-DD[ HH:MM[:SS]]", -1 if invalid
+    static long long startOfWeekMs(long long epochMs);  // Local Monday 00:00 of that week
+
     static void clearScreen()
     {
 #ifdef _WIN32
@@ -78,6 +84,26 @@ public:
         return tokens;
     }
 
+    // ASCII lower-case copy; search keys are compared case-insensitively
+    static string toLower(const string &str)
+    {
+        string lower = str;
+        for (char &c : lower)
+        {
+            c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        }
+        return lower;
+    }
+
+    // Case-insensitive substring test against an already lower-cased needle,
+    // without copying the text
+    static bool containsLower(const string &text, const string &lowerNeedle)
+    {
+        return search(text.begin(), text.end(), lowerNeedle.begin(), lowerNeedle.end(),
+                      [](char a, char b)
+                      { return tolower(static_cast<unsigned char>(a)) == b; }) != text.end();
+    }
+
     static string generateRandomString(int length)
     {
         const string charset = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";